@@ -3,25 +3,39 @@
 
 #include <sstream>
 #include <fstream>
+#include <vector>
 
 #include "gw2DatTools/interface/ANDatInterface.h"
-#include "gw2DatTools/compression/inflateDatFileBuffer.h"
 
 int main(int argc, char* argv[])
 {
-    const uint32_t aBufferSize = 1024 * 1024 * 30; // We make the assumption that no file is bigger than 30 M
-
     auto pANDatInterface = gw2dt::interface::createANDatInterface("D:\\GuildWars2\\Gw2.dat");
 
-    auto aFileRecordVect = pANDatInterface->getFileRecordVect();
+    // Uncompressed sizes are only read from the archive the first time
+    if (!pANDatInterface->loadIndex("D:\\GuildWars2\\Gw2.idx"))
+    {
+        pANDatInterface->computeUncompressedSizes();
+        pANDatInterface->saveIndex("D:\\GuildWars2\\Gw2.idx");
+    }
+
+    // Inflated once for all in the sidecar, read as is from then on
+    if (!pANDatInterface->attachSidecar("D:\\GuildWars2\\Gw2.sidecar"))
+    {
+        pANDatInterface->saveSidecar("D:\\GuildWars2\\Gw2.sidecar");
+        pANDatInterface->attachSidecar("D:\\GuildWars2\\Gw2.sidecar");
+    }
+
+    const auto& aFileRecordVect = pANDatInterface->getFileRecordVect();
 
-    uint8_t* pOriBuffer = new uint8_t[aBufferSize];
-    uint8_t* pInfBuffer = new uint8_t[aBufferSize];
+    std::vector<uint8_t> anOriBuffer;
+    std::vector<uint8_t> anInfBuffer;
 
     for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
     {
-        uint32_t aOriSize = aBufferSize;
-        pANDatInterface->getBuffer(*it, aOriSize, pOriBuffer);
+        anOriBuffer.resize(it->size);
+
+        uint32_t aOriSize = it->size;
+        pANDatInterface->getBuffer(*it, aOriSize, anOriBuffer.data());
 
         std::cout << "Processing File " << it->fileId << std::endl;
 
@@ -30,19 +44,12 @@ int main(int argc, char* argv[])
         //oss << "D:\\gw2Unpack\\" << it->fileId;
         //aOFStream.open(oss.str().c_str(), std::ios::binary | std::ios::out);
 
-        if (aOriSize == aBufferSize)
-        {
-            std::cout << "File " << it->fileId << " has a size greater than (or equal to) 30Mo." << std::endl;
-        }
-
         if (it->isCompressed)
         {
-            uint32_t aInfSize = aBufferSize;
-
             try
             {
-                gw2dt::compression::inflateDatFileBuffer(aOriSize, pOriBuffer, aInfSize, pInfBuffer);
-                //aOFStream.write(reinterpret_cast<const char*>(pInfBuffer), aInfSize);
+                pANDatInterface->getInflatedBuffer(*it, anInfBuffer);
+                //aOFStream.write(reinterpret_cast<const char*>(anInfBuffer.data()), anInfBuffer.size());
             }
             catch(std::exception& iException)
             {
@@ -51,14 +58,11 @@ int main(int argc, char* argv[])
         }
         else
         {
-            //aOFStream.write(reinterpret_cast<const char*>(pOriBuffer), aOriSize);
+            //aOFStream.write(reinterpret_cast<const char*>(anOriBuffer.data()), aOriSize);
         }
 
         //aOFStream.close();
     }
 
-    delete[] pOriBuffer;
-    delete[] pInfBuffer;
-
     return 0;
 };
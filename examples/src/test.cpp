@@ -5,7 +5,6 @@
 #include <fstream>
 
 #include "gw2DatTools/interface/ANDatInterface.h"
-#include "gw2DatTools/compression/inflateDatFileBuffer.h"
 #include "gw2DatTools/compression/inflateTextureFileBuffer.h"
 
 int main(int argc, char* argv[])
@@ -19,12 +18,8 @@ int main(int argc, char* argv[])
     auto aFileRecord = pANDatInterface->getFileRecordForFileId(293296);
 
     uint8_t* pOriBuffer = new uint8_t[aBufferSize];
-    uint8_t* pInfBuffer = new uint8_t[aBufferSize];
     uint8_t* pOutBuffer = new uint8_t[aBufferSize];
 
-    uint8_t* pAtexBuffer = nullptr;
-    uint32_t aAtexBufferSize = 0;
-
     uint32_t aOriSize = aBufferSize;
     pANDatInterface->getBuffer(aFileRecord, aOriSize, pOriBuffer);
 
@@ -39,35 +34,13 @@ int main(int argc, char* argv[])
         std::cout << "File " << aFileRecord.fileId << " has a size greater than (or equal to) 30Mo." << std::endl;
     }
 
-    if (aFileRecord.isCompressed)
-    {
-        uint32_t aInfSize = aBufferSize;
-        std::cout << "Compressed." << std::endl;
-
-        try
-        {
-            gw2dt::compression::inflateDatFileBuffer(aOriSize, pOriBuffer, aInfSize, pInfBuffer);
-
-            pAtexBuffer = pInfBuffer;
-            aAtexBufferSize = aInfSize;
-        }
-        catch(std::exception& iException)
-        {
-            std::cout << "File " << aFileRecord.fileId << " failed to decompress: " << std::string(iException.what()) << std::endl;
-        }
-    }
-    else
-    {
-        std::cout << "Not compressed." << std::endl;
-        pAtexBuffer = pOriBuffer;
-        aAtexBufferSize = aOriSize;
-    }
+    std::cout << (aFileRecord.isCompressed ? "Compressed." : "Not compressed.") << std::endl;
 
     try
     {
-        std::cout << "aAtexBufferSize: " << aAtexBufferSize << std::endl;
+        // Compressed records are inflated straight into the texture decoder
         uint32_t aOutSize = aBufferSize;
-        gw2dt::compression::inflateTextureFileBuffer(aAtexBufferSize, pAtexBuffer, aOutSize, pOutBuffer);
+        gw2dt::compression::inflateTextureDatFileBuffer(aFileRecord.isCompressed, aOriSize, pOriBuffer, aOutSize, pOutBuffer);
 
         aStream.write(reinterpret_cast<char*>(pOutBuffer), aOutSize);
     }
@@ -82,7 +55,7 @@ int main(int argc, char* argv[])
     std::cin >> i;
 
     delete[] pOriBuffer;
-    delete[] pInfBuffer;
+    delete[] pOutBuffer;
 
     return 0;
 };
\ No newline at end of file
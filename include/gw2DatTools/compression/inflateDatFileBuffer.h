@@ -11,6 +11,10 @@ namespace gw2dt
 namespace compression
 {
 
+// Compressed buffers are split in blocks of sDatFileBlockSize bytes, the last four bytes
+// of each block, the last one included, are the CRC-32C of the other bytes of the block
+const uint32_t sDatFileBlockSize = 65536;
+
 /** @Inputs:
  *    - iInputSize: Size of the input buffer
  *    - iInputTab: Pointer to the buffer to inflate
@@ -18,6 +22,7 @@ namespace compression
  *                    else we decode until we reach the io_outputSize
  *    - ioOutputTab: Optional output buffer, in case you provide this buffer,
  *                   ioOutputSize shall be inferior or equal to the size of this buffer
+ *    - iIsVerified: Checks the CRC of every block of the input before decoding it
  *  @Outputs:
  *    - ioOutputSize: actual size of the outputBuffer
  *  @Return:
@@ -26,7 +31,30 @@ namespace compression
  *    - gw2dt::exception::Exception or std::exception in case of error
  */
 
-GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr,
+                                                                    bool iIsVerified = false);
+
+/** @Inputs:
+ *    - iInputSize: Size of the compressed buffer
+ *  @Return:
+ *    - Number of blocks holding a CRC, a last block shorter than a CRC holds none
+ */
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getNbOfDatFileBlocks(uint32_t iInputSize);
+
+/** @Inputs:
+ *    - iInputSize: Size of the compressed buffer
+ *    - iInputTab: Compressed buffer, as stored in the dat
+ *    - iBlockIndex: Block to check, lower than getNbOfDatFileBlocks
+ *  @Outputs:
+ *    - oExpectedCrc: CRC stored at the end of the block
+ *    - oComputedCrc: CRC of the other bytes of the block
+ *  @Return:
+ *    - true if both CRCs match
+ */
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY checkDatFileBlock(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iBlockIndex,
+                                                           uint32_t& oExpectedCrc, uint32_t& oComputedCrc);
 
 }
 }
@@ -0,0 +1,56 @@
+#ifndef GW2DATTOOLS_COMPRESSION_INFLATEDATFILESTREAM_H
+#define GW2DATTOOLS_COMPRESSION_INFLATEDATFILESTREAM_H
+
+#include <cstdint>
+#include <memory>
+
+#include "gw2DatTools/dllMacros.h"
+
+namespace gw2dt
+{
+namespace compression
+{
+
+// Default size of the slices output by a DatFileStreamInflater
+const uint32_t sDatFileStreamSliceSize = 65536;
+
+// Inflates a compressed dat buffer given piece by piece, as it is read from the disk, into slices of
+// bounded size. Besides the pieces not decoded yet, only the current slice and the history the copies
+// can reach are held, whatever the size of the buffer. An inflater can be reused for several buffers.
+class GW2DATTOOLS_API DatFileStreamInflater
+{
+public:
+    virtual ~DatFileStreamInflater() {};
+
+    // Starts a new compressed buffer, keeping the memory already allocated
+    virtual void reset() = 0;
+
+    // Appends the next piece of the compressed buffer, iIsLast for the piece holding its end.
+    // The piece is copied, it can be reused as soon as the call returns.
+    virtual void pushInput(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsLast) = 0;
+
+    // Inflates the next slice, up to the slice size, and returns its size.
+    // oSliceTab is valid until the next call, 0 is returned once the output is finished or when more input is needed.
+    virtual uint32_t pullOutput(const uint8_t*& oSliceTab) = 0;
+
+    // True once the whole output was pulled
+    virtual bool isFinished() const = 0;
+
+    // Size of the whole output, as stored in the header of the buffer, 0 until the header was pushed
+    virtual uint32_t getOutputSize() const = 0;
+};
+
+/** @Inputs:
+ *    - iSliceSize: Maximum size of the slices returned by pullOutput
+ *  @Return:
+ *    - The inflater
+ *  @Throws:
+ *    - gw2dt::exception::Exception, by pushInput and pullOutput too, if the buffer is corrupted
+ */
+
+GW2DATTOOLS_API std::unique_ptr<DatFileStreamInflater> GW2DATTOOLS_APIENTRY createDatFileStreamInflater(uint32_t iSliceSize = sDatFileStreamSliceSize);
+
+}
+}
+
+#endif // GW2DATTOOLS_COMPRESSION_INFLATEDATFILESTREAM_H
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gw2DatTools/dllMacros.h"
 
@@ -11,6 +12,52 @@ namespace gw2dt
 namespace compression
 {
 
+enum TextureOutputFormat
+{
+    TOF_BLOCKS = 0, // DXT pixel blocks, as written by inflateTextureFileBuffer
+    TOF_PIXELS = 1  // Expanded pixels, as written by inflateTextureFileBufferToPixels
+};
+
+// Destination of a texture inside a bigger surface (staging buffer, atlas...)
+struct TextureSurface
+{
+    uint8_t* data;         // Base pointer of the surface
+    uint32_t size;         // Size in bytes of the surface
+    uint32_t rowPitch;     // Bytes between two rows of pixel blocks (TOF_BLOCKS) or of pixels (TOF_PIXELS)
+    uint16_t blockOffsetX; // Position of the texture in the surface, in pixel blocks
+    uint16_t blockOffsetY;
+};
+
+// One texture of a batch, see inflateTextureFileBuffers
+struct TextureJob
+{
+    uint32_t inputSize;
+    const uint8_t* inputTab;
+    TextureOutputFormat outputFormat;
+
+    uint32_t outputSize;      // Size of outputTab if it is provided, actual size of the output once decoded
+    uint8_t* outputTab;       // Optional output buffer, otherwise the output is placed in the batch arena
+
+    bool isSuccessful;
+    std::string errorMessage; // Reason of the failure when isSuccessful is false
+};
+
+struct TextureMipLevel
+{
+    uint16_t width;
+    uint16_t height;
+    uint32_t offset; // Offset of the level in the ATEX buffer
+    uint32_t size;   // Size in bytes of the level, data size field included
+};
+
+struct TextureInfos
+{
+    uint32_t formatFourCc;
+    uint16_t width;
+    uint16_t height;
+    std::vector<TextureMipLevel> mipLevels; // Level 0 is the full resolution one
+};
+
 /** @Inputs:
  *    - iInputSize: Size of the input buffer
  *    - iInputTab: Pointer to the buffer to inflate
@@ -48,6 +95,187 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffer(uint32_t
 
 GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBuffer(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
         uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+
+/** @Inputs:
+ *    - iFormatFourCc: FourCC describing the format of the data
+ *  @Return:
+ *    - Size in bytes of a pixel once expanded by the *ToPixels functions:
+ *      4 (RGBA8) for DXT1 to DXT5, 1 (R8) for DXTA, 2 (RG8) for DXTN and 3DCX
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the format cannot be expanded to pixels (DXTL)
+ */
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getTexturePixelSize(uint32_t iFormatFourCc);
+
+/** Same as inflateTextureFileBuffer, but the pixel blocks are expanded into a
+ *  width * height image, rows being tightly packed. DXT2 and DXT4 colors are
+ *  left premultiplied by alpha.
+ *  @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - ioOutputSize: if the value is not 0, the size of ioOutputTab
+ *    - ioOutputTab: Optional output buffer, in case you provide this buffer,
+ *                   ioOutputSize shall be inferior or equal to the size of this buffer
+ *  @Outputs:
+ *    - ioOutputSize: actual size of the outputBuffer
+ *  @Return:
+ *    - Pointer to the outputBuffer, nullptr if it failed
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBufferToPixels(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+
+/** Same as inflateTextureBlockBuffer, but the pixel blocks are expanded into a
+ *  iWidth * iHeight image, rows being tightly packed.
+ *  @Inputs:
+ *    - iWidth: Width of the texture
+ *    - iHeight: Height of the texture
+ *    - iFormatFourCc: FourCC describing the format of the data
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - ioOutputSize: if the value is not 0, the size of ioOutputTab
+ *    - ioOutputTab: Optional output buffer, in case you provide this buffer,
+ *                   ioOutputSize shall be inferior or equal to the size of this buffer
+ *  @Outputs:
+ *    - ioOutputSize: actual size of the outputBuffer
+ *  @Return:
+ *    - Pointer to the outputBuffer, nullptr if it failed
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBufferToPixels(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+
+/** Same as inflateTextureFileBuffer, but each row is written in place in a
+ *  caller provided surface.
+ *  @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - iSurface: Destination surface, shall be big enough to hold the texture at the given offset
+ *    - iOutputFormat: Whether pixel blocks or expanded pixels are written
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureFileBufferToSurface(uint32_t iInputSize, const uint8_t* iInputTab, const TextureSurface& iSurface,
+        TextureOutputFormat iOutputFormat = TOF_BLOCKS);
+
+/** Same as inflateTextureBlockBuffer, but each row is written in place in a
+ *  caller provided surface.
+ *  @Inputs:
+ *    - iWidth: Width of the texture
+ *    - iHeight: Height of the texture
+ *    - iFormatFourCc: FourCC describing the format of the data
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - iSurface: Destination surface, shall be big enough to hold the texture at the given offset
+ *    - iOutputFormat: Whether pixel blocks or expanded pixels are written
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureBlockBufferToSurface(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
+        const TextureSurface& iSurface, TextureOutputFormat iOutputFormat = TOF_BLOCKS);
+
+/** Parses the ATEX header and locates every mip level, without decoding anything.
+ *  Each level is stored as a 32 bits data size followed by that many bytes.
+ *  @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the ATEX buffer
+ *  @Outputs:
+ *    - oTextureInfos: format, dimensions and mip levels of the texture
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY parseTextureFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab, TextureInfos& oTextureInfos);
+
+/** @Inputs:
+ *    - iTextureInfos: Texture as parsed by parseTextureFileBuffer
+ *    - iMinWidth: Minimal width of the level, 64 is a good value for thumbnails
+ *  @Return:
+ *    - Index of the smallest mip level whose width is at least iMinWidth, 0 if there is none
+ */
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY selectTextureMipLevel(const TextureInfos& iTextureInfos, uint16_t iMinWidth);
+
+/** Same as inflateTextureFileBuffer, but only the given mip level is decoded,
+ *  the bitstreams of the other levels are skipped.
+ *  @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - iMipLevel: Index of the mip level to decode
+ *    - ioOutputSize: if the value is not 0, the size of ioOutputTab
+ *    - ioOutputTab: Optional output buffer, in case you provide this buffer,
+ *                   ioOutputSize shall be inferior or equal to the size of this buffer
+ *  @Outputs:
+ *    - ioOutputSize: actual size of the outputBuffer
+ *  @Return:
+ *    - Pointer to the outputBuffer, nullptr if it failed
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureMipLevelBuffer(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iMipLevel,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+
+/** Same as inflateTextureFileBufferToSurface, but only the given mip level is
+ *  decoded, the bitstreams of the other levels are skipped.
+ *  @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the buffer to inflate
+ *    - iMipLevel: Index of the mip level to decode
+ *    - iSurface: Destination surface, shall be big enough to hold the level at the given offset
+ *    - iOutputFormat: Whether pixel blocks or expanded pixels are written
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureMipLevelToSurface(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iMipLevel,
+        const TextureSurface& iSurface, TextureOutputFormat iOutputFormat = TOF_BLOCKS);
+
+/** Inflates a texture straight from the raw content of a dat file record.
+ *  Compressed records are streamed from the dat decoder to the texture decoder,
+ *  without inflating the whole ATEX buffer first.
+ *  @Inputs:
+ *    - iIsCompressed: Whether the record is compressed, see FileRecord::isCompressed
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the raw content of the record
+ *    - ioOutputSize: if the value is not 0, the size of ioOutputTab
+ *    - ioOutputTab: Optional output buffer, in case you provide this buffer,
+ *                   ioOutputSize shall be inferior or equal to the size of this buffer
+ *  @Outputs:
+ *    - ioOutputSize: actual size of the outputBuffer
+ *  @Return:
+ *    - Pointer to the outputBuffer, nullptr if it failed
+ *  @Throws:
+ *    - gw2dt::exception::Exception or std::exception in case of error, or if the record is not a texture
+ */
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureDatFileBuffer(bool iIsCompressed, uint32_t iInputSize, const uint8_t* iInputTab,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab = nullptr);
+
+/** Inflates a batch of ATEX buffers over several threads. Each thread keeps its
+ *  decoder state and working buffers from one texture to the next, and the
+ *  outputs that are not provided are packed into a single arena.
+ *  A failing texture does not stop the batch, its job reports the error.
+ *  @Inputs:
+ *    - iNbOfJobs: Number of jobs in ioJobTab
+ *    - ioJobTab: Textures to inflate, see TextureJob
+ *    - iNbOfThreads: Number of threads to use, 0 to use one per hardware thread
+ *  @Outputs:
+ *    - ioJobTab: outputSize, outputTab, isSuccessful and errorMessage of each job
+ *  @Return:
+ *    - Pointer to the arena holding the outputs that were not provided, to be freed
+ *      with free() once they are not used anymore, nullptr if there is none
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the job buffer is null or the arena cannot be allocated
+ */
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffers(uint32_t iNbOfJobs, TextureJob* ioJobTab, uint32_t iNbOfThreads = 0);
+
 }
 }
 
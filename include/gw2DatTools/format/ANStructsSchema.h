@@ -0,0 +1,114 @@
+#ifndef GW2DATTOOLS_FORMAT_ANSTRUCTSSCHEMA_H
+#define GW2DATTOOLS_FORMAT_ANSTRUCTSSCHEMA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "gw2DatTools/dllMacros.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Layouts of the chunk structs of misc/templates/ANStructs.txt, loaded at runtime.
+// Sizes and offsets follow the same rules as the views generated by
+// misc/scripts/generateANStructs.py.
+
+enum SchemaValueType
+{
+    SVT_BYTE,
+    SVT_BYTE3,
+    SVT_BYTE4,
+    SVT_BYTE16,
+    SVT_WORD,
+    SVT_WORD3,
+    SVT_DWORD,
+    SVT_DWORD2,
+    SVT_DWORD4,
+    SVT_QWORD,
+    SVT_FLOAT,
+    SVT_FLOAT2,
+    SVT_FLOAT3,
+    SVT_FLOAT4,
+    SVT_FILEREF,
+    SVT_FILENAME,   // Pointer to an encoded file id
+    SVT_WCHAR_PTR,
+    SVT_CHAR_PTR,
+    SVT_STRUCT,
+    SVT_UNKNOWN     // Type missing from TypesDef.bt
+};
+
+// How the field holds its elements, see TypesDef.bt
+enum SchemaEncoding
+{
+    SE_INLINE,
+    SE_PTR,             // 0x10 -- struct*
+    SE_ARRAY_PTR,       // 0x01, 0x02 -- array<struct>*
+    SE_PTR_ARRAY_PTR    // 0x03 -- array<struct*>*
+};
+
+struct SchemaStruct;
+
+struct SchemaField
+{
+    std::string name;
+    SchemaValueType valueType;
+    const SchemaStruct* pStruct;    // Type of the elements if valueType is SVT_STRUCT
+    SchemaEncoding encoding;
+    uint32_t nbOfElements;          // Size of the fixed array, 1 if the field is not an array
+    bool isLocated;                 // false if a previous field has an unknown size
+    uint32_t offset;
+};
+
+struct SchemaStruct
+{
+    std::string name;
+    std::vector<SchemaField> fields;
+    bool isSized;                   // false if the size of a field is unknown
+    uint32_t size;
+};
+
+struct SchemaVersion
+{
+    uint32_t version;
+    std::vector<std::unique_ptr<SchemaStruct>> structs;
+    const SchemaStruct* pRoot;      // Last struct of the version
+};
+
+struct SchemaChunk
+{
+    std::string name;
+    uint32_t magic;                 // Name as a little endian fourcc, padded with zeros
+    std::vector<SchemaVersion> versions;
+};
+
+struct ANStructsSchema
+{
+    std::vector<SchemaChunk> chunks;
+};
+
+/** @Inputs:
+ *    - iValueType: Type of a value
+ *  @Return:
+ *    - Size of the value in a struct, 0 for SVT_STRUCT and SVT_UNKNOWN
+ */
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getSchemaValueSize(SchemaValueType iValueType);
+
+/** @Inputs:
+ *    - iPath: Path of ANStructs.txt
+ *  @Return:
+ *    - The schema
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the file cannot be read or a line is not understood
+ */
+
+GW2DATTOOLS_API std::unique_ptr<ANStructsSchema> GW2DATTOOLS_APIENTRY parseANStructsSchema(const char* iPath);
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMAT_ANSTRUCTSSCHEMA_H
@@ -0,0 +1,105 @@
+#ifndef GW2DATTOOLS_FORMAT_PACKFILE_H
+#define GW2DATTOOLS_FORMAT_PACKFILE_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "gw2DatTools/dllMacros.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Layout described in misc/templates/PackFile.bt
+
+#pragma pack(push, 1)
+struct PackFileHeader
+{
+    uint8_t  magic[2];          // "PF"
+    uint16_t version;
+    uint16_t zero;
+    uint16_t headerSize;
+    uint8_t  type[4];           // MODL, ANIM, ...
+};
+
+struct PackFileChunkHeader
+{
+    uint8_t  magic[4];
+    uint32_t chunkSize;         // Size of the chunk once these 8 bytes are read
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t offsetToOffsetTable;
+};
+#pragma pack(pop)
+
+// How the pointers of the chunk data are stored
+enum PointerEncoding
+{
+    PE_RELATIVE,        // As in the dat: offset from the pointer itself, 0 for null
+    PE_BASE_INDEX,      // Offset from pData, sNullBaseIndex for null
+    PE_NATIVE           // Address, 0 for null. Only available to 32 bits builds
+};
+
+const uint32_t sNullBaseIndex = 0xFFFFFFFF;
+
+// Chunk of a PackFile, pointers are borrowed from the parsed buffer
+struct PackFileChunk
+{
+    uint32_t magic;
+    uint16_t version;
+    PointerEncoding pointerEncoding;
+
+    const uint8_t* pData;       // Right after the chunk header
+    uint32_t dataSize;          // Up to the offset table, or to the end of the chunk if there is none
+
+    // Offsets of the pointers held by the data, relative to pData
+    const uint8_t* pOffsetTable;
+    uint32_t nbOfOffsets;
+};
+
+struct PackFile
+{
+    const PackFileHeader* pHeader;
+    std::vector<PackFileChunk> chunks;
+};
+
+/** @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - iInputTab: Pointer to the PackFile, it shall outlive the returned index
+ *  @Return:
+ *    - Index of the chunks, nothing is copied from the input
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the buffer is not a PackFile or a chunk exceeds it
+ */
+
+GW2DATTOOLS_API std::unique_ptr<PackFile> GW2DATTOOLS_APIENTRY parsePackFile(uint32_t iInputSize, const uint8_t* iInputTab);
+
+/** @Inputs:
+ *    - iInputSize: Size of the input buffer
+ *    - ioInputTab: Pointer to the PackFile, as read from the dat. Its pointers are rewritten
+ *                  in place, in one pass over the offset table of each chunk.
+ *    - iPointerEncoding: PE_BASE_INDEX or PE_NATIVE
+ *  @Return:
+ *    - Index of the chunks, their pointerEncoding is iPointerEncoding
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the buffer is not a PackFile, a pointer leaves its chunk,
+ *      or native pointers do not fit in 4 bytes. The buffer is then partially rewritten.
+ */
+
+GW2DATTOOLS_API std::unique_ptr<PackFile> GW2DATTOOLS_APIENTRY relocatePackFile(uint32_t iInputSize, uint8_t* ioInputTab, PointerEncoding iPointerEncoding);
+
+/** @Inputs:
+ *    - iPackFile: Parsed PackFile
+ *    - iMagic: Magic of the chunk, as a little endian fourcc
+ *  @Return:
+ *    - First chunk with this magic, nullptr if there is none
+ */
+
+GW2DATTOOLS_API const PackFileChunk* GW2DATTOOLS_APIENTRY findPackFileChunk(const PackFile& iPackFile, uint32_t iMagic);
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMAT_PACKFILE_H
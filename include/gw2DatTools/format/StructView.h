@@ -0,0 +1,377 @@
+#ifndef GW2DATTOOLS_FORMAT_STRUCTVIEW_H
+#define GW2DATTOOLS_FORMAT_STRUCTVIEW_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "gw2DatTools/exception/Exception.h"
+#include "gw2DatTools/format/PackFile.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Read-only views over the structs of a PackFile chunk, as described by
+// misc/templates/ANStructs.txt. Nothing is copied: a view holds the bounds of
+// the chunk and a position in it, fields are read when they are asked for and
+// pointers are followed the same way. Every access is checked against the
+// bounds of the chunk.
+// The views of each chunk and version are generated from ANStructs.txt by
+// misc/scripts/generateANStructs.py, in gw2DatTools/format/anstructs.
+// Pointers and arrays follow the encodings of misc/templates/TypesDef.bt.
+// Chunks whose pointers were rewritten by relocatePackFile are read the same way.
+
+// Common types of TypesDef.bt
+struct byte3  { int8_t  data[3]; };
+struct byte4  { int8_t  data[4]; };
+struct byte16 { int8_t  data[16]; };
+struct word3  { int16_t data[3]; };
+struct dword2 { int32_t data[2]; };
+struct dword4 { int32_t data[4]; };
+struct float2 { float   data[2]; };
+struct float3 { float   data[3]; };
+struct float4 { float   data[4]; };
+
+// Bounds of the data of a chunk
+struct ChunkSpan
+{
+    ChunkSpan(const PackFileChunk& iChunk) :
+        pBegin(iChunk.pData),
+        pEnd(iChunk.pData + iChunk.dataSize),
+        pointerEncoding(iChunk.pointerEncoding)
+    {
+    }
+
+    ChunkSpan(const uint8_t* ipBegin, const uint8_t* ipEnd, PointerEncoding iPointerEncoding = PE_RELATIVE) :
+        pBegin(ipBegin),
+        pEnd(ipEnd),
+        pointerEncoding(iPointerEncoding)
+    {
+    }
+
+    void check(const uint8_t* ipPos, uint64_t iSize) const
+    {
+        if (ipPos < pBegin || ipPos > pEnd || iSize > static_cast<uint64_t>(pEnd - ipPos))
+        {
+            throw exception::Exception("Struct exceeds the chunk.");
+        }
+    }
+
+    // Pointers are stored as offsets relative to their own position, unless the chunk was relocated
+    const uint8_t* follow(const uint8_t* ipPos) const
+    {
+        check(ipPos, sizeof(uint32_t));
+
+        uint32_t aValue;
+        memcpy(&aValue, ipPos, sizeof(aValue));
+
+        switch (pointerEncoding)
+        {
+        case PE_BASE_INDEX:
+            return (aValue == sNullBaseIndex) ? nullptr : pBegin + aValue;
+        case PE_NATIVE:
+            return reinterpret_cast<const uint8_t*>(static_cast<uintptr_t>(aValue));
+        default:
+            return (aValue == 0) ? nullptr : ipPos + static_cast<int32_t>(aValue);
+        }
+    }
+
+    const uint8_t* pBegin;
+    const uint8_t* pEnd;
+    PointerEncoding pointerEncoding;
+};
+
+// Reading an element of type T at a position: T is either a view, built over
+// the position, or a plain value, copied from it
+template <typename T>
+struct ElementTraits
+{
+    typedef T Type;
+    static const uint32_t sSize = T::sSize;
+
+    static Type read(const ChunkSpan& iSpan, const uint8_t* ipPos)
+    {
+        return T(iSpan, ipPos);
+    }
+};
+
+template <typename T>
+struct ValueElementTraits
+{
+    typedef T Type;
+    static const uint32_t sSize = sizeof(T);
+
+    static Type read(const ChunkSpan& iSpan, const uint8_t* ipPos)
+    {
+        iSpan.check(ipPos, sizeof(T));
+
+        T aValue;
+        memcpy(&aValue, ipPos, sizeof(T));
+        return aValue;
+    }
+};
+
+template <> struct ElementTraits<int8_t>  : public ValueElementTraits<int8_t>  {};
+template <> struct ElementTraits<int16_t> : public ValueElementTraits<int16_t> {};
+template <> struct ElementTraits<int32_t> : public ValueElementTraits<int32_t> {};
+template <> struct ElementTraits<int64_t> : public ValueElementTraits<int64_t> {};
+template <> struct ElementTraits<float>   : public ValueElementTraits<float>   {};
+template <> struct ElementTraits<byte3>   : public ValueElementTraits<byte3>   {};
+template <> struct ElementTraits<byte4>   : public ValueElementTraits<byte4>   {};
+template <> struct ElementTraits<byte16>  : public ValueElementTraits<byte16>  {};
+template <> struct ElementTraits<word3>   : public ValueElementTraits<word3>   {};
+template <> struct ElementTraits<dword2>  : public ValueElementTraits<dword2>  {};
+template <> struct ElementTraits<dword4>  : public ValueElementTraits<dword4>  {};
+template <> struct ElementTraits<float2>  : public ValueElementTraits<float2>  {};
+template <> struct ElementTraits<float3>  : public ValueElementTraits<float3>  {};
+template <> struct ElementTraits<float4>  : public ValueElementTraits<float4>  {};
+
+// Base of the generated structs
+class StructView
+{
+public:
+    StructView(const ChunkSpan& iSpan, const uint8_t* ipPos, uint32_t iSize) :
+        _span(iSpan),
+        _pPos(ipPos)
+    {
+        _span.check(_pPos, iSize);
+    }
+
+    const uint8_t* getPos() const
+    {
+        return _pPos;
+    }
+
+protected:
+    template <typename T>
+    typename ElementTraits<T>::Type getField(uint32_t iOffset) const
+    {
+        return ElementTraits<T>::read(_span, _pPos + iOffset);
+    }
+
+    // Element of a fixed size array held by the struct
+    template <typename T>
+    typename ElementTraits<T>::Type getField(uint32_t iOffset, uint32_t iIndex, uint32_t iNbOfElements) const
+    {
+        if (iIndex >= iNbOfElements)
+        {
+            throw exception::Exception("Index is out of the array.");
+        }
+        return ElementTraits<T>::read(_span, _pPos + iOffset + iIndex * ElementTraits<T>::sSize);
+    }
+
+    ChunkSpan _span;
+    const uint8_t* _pPos;
+};
+
+// 0x10 -- struct*
+template <typename T>
+class PtrView
+{
+public:
+    static const uint32_t sSize = sizeof(uint32_t);
+
+    PtrView(const ChunkSpan& iSpan, const uint8_t* ipPos) :
+        _span(iSpan),
+        _pTarget(iSpan.follow(ipPos))
+    {
+    }
+
+    bool isNull() const
+    {
+        return _pTarget == nullptr;
+    }
+
+    typename ElementTraits<T>::Type get() const
+    {
+        if (_pTarget == nullptr)
+        {
+            throw exception::Exception("Pointer is null.");
+        }
+        return ElementTraits<T>::read(_span, _pTarget);
+    }
+
+private:
+    ChunkSpan _span;
+    const uint8_t* _pTarget;
+};
+
+// 0x01, 0x02 -- array<struct>*: number of elements, then a pointer to them
+template <typename T>
+class ArrayView
+{
+public:
+    static const uint32_t sSize = 2 * sizeof(uint32_t);
+
+    ArrayView(const ChunkSpan& iSpan, const uint8_t* ipPos) :
+        _span(iSpan),
+        _pTarget(nullptr),
+        _size(0)
+    {
+        _span.check(ipPos, sSize);
+        memcpy(&_size, ipPos, sizeof(_size));
+
+        _pTarget = _span.follow(ipPos + sizeof(uint32_t));
+        if (_pTarget == nullptr)
+        {
+            _size = 0;
+        }
+        else
+        {
+            _span.check(_pTarget, static_cast<uint64_t>(_size) * ElementTraits<T>::sSize);
+        }
+    }
+
+    uint32_t size() const
+    {
+        return _size;
+    }
+
+    typename ElementTraits<T>::Type operator[](uint32_t iIndex) const
+    {
+        if (iIndex >= _size)
+        {
+            throw exception::Exception("Index is out of the array.");
+        }
+        return ElementTraits<T>::read(_span, _pTarget + iIndex * ElementTraits<T>::sSize);
+    }
+
+private:
+    ChunkSpan _span;
+    const uint8_t* _pTarget;
+    uint32_t _size;
+};
+
+// 0x03 -- array<struct*>*: number of elements, then a pointer to their pointers
+template <typename T>
+class PtrArrayView
+{
+public:
+    static const uint32_t sSize = 2 * sizeof(uint32_t);
+
+    PtrArrayView(const ChunkSpan& iSpan, const uint8_t* ipPos) :
+        _pointers(iSpan, ipPos)
+    {
+    }
+
+    uint32_t size() const
+    {
+        return _pointers.size();
+    }
+
+    PtrView<T> operator[](uint32_t iIndex) const
+    {
+        return _pointers[iIndex];
+    }
+
+private:
+    ArrayView<PtrView<T>> _pointers;
+};
+
+// 0x0B -- filename: pointer to two 16 bits values encoding the file id
+class FilenameView
+{
+public:
+    static const uint32_t sSize = sizeof(uint32_t);
+
+    FilenameView(const ChunkSpan& iSpan, const uint8_t* ipPos) :
+        _span(iSpan),
+        _pTarget(iSpan.follow(ipPos))
+    {
+    }
+
+    bool isNull() const
+    {
+        return _pTarget == nullptr;
+    }
+
+    // 0 if the pointer is null
+    uint32_t getFileId() const
+    {
+        if (_pTarget == nullptr)
+        {
+            return 0;
+        }
+
+        _span.check(_pTarget, 3 * sizeof(uint16_t));
+
+        uint16_t aLowValue;
+        uint16_t aHighValue;
+        memcpy(&aLowValue, _pTarget, sizeof(aLowValue));
+        memcpy(&aHighValue, _pTarget + sizeof(uint16_t), sizeof(aHighValue));
+
+        return 0xFF00 * (aHighValue - 0x100) + (aLowValue - 0x100) + 1;
+    }
+
+private:
+    ChunkSpan _span;
+    const uint8_t* _pTarget;
+};
+
+// 0x12, 0x13 -- wchar*, char*: pointer to a null terminated string
+template <typename CharType>
+class StringPtrView
+{
+public:
+    static const uint32_t sSize = sizeof(uint32_t);
+
+    StringPtrView(const ChunkSpan& iSpan, const uint8_t* ipPos) :
+        _span(iSpan),
+        _pTarget(iSpan.follow(ipPos))
+    {
+    }
+
+    bool isNull() const
+    {
+        return _pTarget == nullptr;
+    }
+
+    // Number of characters before the terminator, which shall be in the chunk
+    uint32_t getLength() const
+    {
+        uint32_t aLength = 0;
+        while (getChar(aLength) != 0)
+        {
+            ++aLength;
+        }
+        return aLength;
+    }
+
+    CharType getChar(uint32_t iIndex) const
+    {
+        if (_pTarget == nullptr)
+        {
+            throw exception::Exception("Pointer is null.");
+        }
+        return static_cast<CharType>(ElementTraits<CharTypeStorage>::read(_span, _pTarget + iIndex * sizeof(CharType)));
+    }
+
+    // Copy of the string, empty if the pointer is null
+    std::basic_string<CharType> toString() const
+    {
+        std::basic_string<CharType> aString;
+        if (_pTarget != nullptr)
+        {
+            aString.resize(getLength());
+            memcpy(&aString[0], _pTarget, aString.size() * sizeof(CharType));
+        }
+        return aString;
+    }
+
+private:
+    typedef typename std::conditional<sizeof(CharType) == 1, int8_t, int16_t>::type CharTypeStorage;
+
+    ChunkSpan _span;
+    const uint8_t* _pTarget;
+};
+
+typedef StringPtrView<char16_t> WCharPtrView;
+typedef StringPtrView<char> CharPtrView;
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMAT_STRUCTVIEW_H
@@ -0,0 +1,74 @@
+#ifndef GW2DATTOOLS_INTERFACE_ANDATCACHE_H
+#define GW2DATTOOLS_INTERFACE_ANDATCACHE_H
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Thread-safe cache of the content of the records of an ANDatInterface.
+// Raw (possibly compressed) buffers and inflated buffers are kept in two tiers
+// sharing the same byte budget. Entries are evicted according to the cost of
+// getting them back (disk read or decoding time) per byte they hold.
+// Entries are keyed on the archive, offset, size and CRC of the record: a record
+// changed by ANDatInterface::reload, or another version of it in an overlay, is
+// never served from the entry of the old one.
+class GW2DATTOOLS_API ANDatCache
+{
+public:
+    typedef std::shared_ptr<const std::vector<uint8_t>> Buffer;
+
+    struct Stats
+    {
+        uint64_t rawHits;
+        uint64_t rawMisses;
+        uint64_t inflatedHits;
+        uint64_t inflatedMisses;
+        uint64_t evictions;
+
+        uint64_t usedBytes;
+        uint64_t budgetBytes;
+    };
+
+    virtual ~ANDatCache() {};
+
+    // Content of the record as stored in the dat
+    virtual Buffer getBuffer(const ANDatInterface::FileRecord& iFileRecord) = 0;
+
+    // Content of the record once inflated, same as getBuffer for uncompressed records.
+    // Records held by the sidecar attached to the interface are read from it.
+    virtual Buffer getInflatedBuffer(const ANDatInterface::FileRecord& iFileRecord) = 0;
+
+    // Reads the raw content of the records which are not cached yet, in the given order.
+    // Meant for ANDatInterface::getDependencyClosure, whose records are sorted by offset.
+    virtual void prefetch(const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect) = 0;
+
+    // Drops the entries of the given files in every archive. Not needed for correctness after
+    // ANDatInterface::reload, but frees the memory held by the changed and removed records.
+    virtual void invalidate(const std::vector<uint32_t>& iFileIdVect) = 0;
+
+    virtual void clear() = 0;
+
+    virtual Stats getStats() const = 0;
+};
+
+/** @Inputs:
+ *    - iANDatInterface: Interface the records are read from, it shall outlive the cache.
+ *    - iBudgetBytes: Maximum number of bytes held by the cache, both tiers included
+ *  @Return:
+ *    - The cache
+ */
+
+GW2DATTOOLS_API std::unique_ptr<ANDatCache> GW2DATTOOLS_APIENTRY createANDatCache(ANDatInterface& iANDatInterface, uint64_t iBudgetBytes);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_ANDATCACHE_H
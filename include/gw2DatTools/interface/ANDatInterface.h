@@ -2,6 +2,8 @@
 #define GW2DATTOOLS_INTERFACE_ANDATINTERFACE_H
 
 #include <cstdint>
+#include <functional>
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -9,14 +11,39 @@
 
 namespace gw2dt
 {
+namespace format
+{
+struct ANStructsSchema;
+}
+
 namespace interface
 {
 
+struct ArchiveDiff;
+
+// The getters can be called from any thread, including while a new version of the records is published:
+// they do not wait, and calls in progress go on with the version they started with. A new version is published
+// by reload, and by the functions computing or loading the data of the records, which work on a copy of the
+// published one. Records returned before stay valid, and are still read from their version with the data it
+// had, until releaseRetiredSnapshots is called.
+// getBuffer and getInflatedBuffer can also be called from any thread, including while the data of the records
+// is computed or saved: the reads of an archive are serialized by the interface.
 class GW2DATTOOLS_API ANDatInterface
 {
 public:
+    enum FileType
+    {
+        FT_UNKNOWN,   // Not classified yet, or could not be inflated
+        FT_OTHER,
+        FT_TEXTURE,   // ATEX, ATTX, ATEC, ATEP, ATEU, ATET
+        FT_PACKFILE,  // PF, see packFileType
+        FT_SOUND,     // Ogg or mp3
+        FT_STRINGS    // strs
+    };
+
     struct FileRecord
     {
+        uint32_t archiveIndex; // Archive holding the record, see createOverlayANDatInterface
         uint64_t offset;
         uint32_t size;
 
@@ -24,8 +51,21 @@ public:
         uint32_t fileId;
 
         bool isCompressed;
+
+        // CRC-32C of the record as stored, from the MFT, 0 if it has none
+        uint32_t crc;
+
+        // Size of the content once inflated, 0 for compressed records until
+        // computeUncompressedSizes or loadIndex is called
+        uint32_t uncompressedSize;
+
+        // Set by classifyFileRecords or loadIndex
+        FileType fileType;
+        uint32_t packFileType; // type[4] of the PF header, 0 for other types
     };
 
+    typedef std::function<void(const ArchiveDiff& iArchiveDiff)> ReloadCallback;
+
     virtual ~ANDatInterface() {};
 
     virtual void getBuffer(const ANDatInterface::FileRecord& iFileRecord, uint32_t& ioOutputSize, uint8_t* ioBuffer) = 0;
@@ -34,10 +74,82 @@ public:
     virtual const FileRecord& getFileRecordForBaseId(const uint32_t& iBaseId) const = 0;
 
     virtual const std::vector<FileRecord>& getFileRecordVect() const = 0;
+
+    // Reads the uncompressed size of the compressed records from the header of their stream
+    virtual void computeUncompressedSizes() = 0;
+
+    // Sets the fileType and packFileType of the records by inflating the first bytes of each of them.
+    // Also sets the uncompressedSize. iNbOfThreads is the number of decoding threads, 0 for one per hardware thread.
+    virtual void classifyFileRecords(uint32_t iNbOfThreads = 0) = 0;
+    // Same, for the given records only, the changed ones after loadPreviousIndex for example
+    virtual void classifyFileRecords(const std::vector<const FileRecord*>& iFileRecordPtrVect, uint32_t iNbOfThreads = 0) = 0;
+
+    // Builds the graph of the references between records, from the filename and fileref fields of the
+    // PackFile chunks described by iSchema. Records should be classified beforehand so that only PackFiles are read.
+    // iNbOfThreads is the number of decoding threads, 0 for one per hardware thread.
+    virtual void computeDependencies(const format::ANStructsSchema& iSchema, uint32_t iNbOfThreads = 0) = 0;
+    // Same, only the dependencies of the given records are computed again, those of the others are kept
+    virtual void computeDependencies(const format::ANStructsSchema& iSchema, const std::vector<const FileRecord*>& iFileRecordPtrVect,
+                                     uint32_t iNbOfThreads = 0) = 0;
+
+    // Records directly referenced by iFileRecord, empty until computeDependencies or loadIndex is called
+    virtual std::vector<const FileRecord*> getDependencies(const FileRecord& iFileRecord) const = 0;
+    // iFileRecord and every record reachable from it, in archive then offset order so that they can be
+    // read forward, by ANDatCache::prefetch for example
+    virtual std::vector<const FileRecord*> getDependencyClosure(const FileRecord& iFileRecord) const = 0;
+
+    // Persists the computed data of the records, so that it does not have to be computed again
+    virtual void saveIndex(const char* iIndexPath) const = 0;
+    // Returns false if the index is missing or was built for another archive
+    virtual bool loadIndex(const char* iIndexPath) = 0;
+    // Loads an index saved for a previous version of the archive, after a patch. The computed data of the records
+    // whose content did not change is kept, including their dependencies to records which are still there.
+    // oArchiveDiff lists the added and changed records, whose data has to be computed again.
+    // Returns false if the index is missing or does not hold its records.
+    virtual bool loadPreviousIndex(const char* iIndexPath, ArchiveDiff& oArchiveDiff) = 0;
+
+    // Writes the inflated content of the compressed records to a sidecar file, trading disk for not decoding
+    // them again, see attachSidecar. Records which cannot be inflated are left out. The content is stored
+    // uncompressed: the sidecar takes about the sum of the uncompressedSize of the compressed records.
+    // iNbOfThreads is the number of decoding threads, 0 for one per hardware thread.
+    virtual void saveSidecar(const char* iSidecarPath, uint32_t iNbOfThreads = 0) = 0;
+    // Serves the inflated content of the records from the sidecar, also after a reload if it was written for
+    // the new version. Returns false if the sidecar is missing or was written for another version of the archive.
+    virtual bool attachSidecar(const char* iSidecarPath) = 0;
+    // True if getInflatedBuffer reads the record from the attached sidecar
+    virtual bool isInSidecar(const FileRecord& iFileRecord) const = 0;
+    // Content of the record once inflated, from the attached sidecar if it holds the record, inflated from
+    // the dat otherwise.
+    // Throws if the record cannot be read or inflated.
+    virtual void getInflatedBuffer(const FileRecord& iFileRecord, std::vector<uint8_t>& oBuffer) = 0;
+
+    // Checks whether the archive changed on disk and, if so, reads its new version and publishes it. The computed data
+    // of the records whose content did not change is carried over, as with loadPreviousIndex.
+    // Returns true if a new version was published, oArchiveDiff then lists its differences with the previous one.
+    virtual bool reload(ArchiveDiff& oArchiveDiff) = 0;
+    // Calls reload every iPeriodMs on a background thread, and iCallback on that thread after each new version.
+    // An archive being patched is read again at the next period.
+    virtual void startAutoReload(uint32_t iPeriodMs, const ReloadCallback& iCallback) = 0;
+    virtual void stopAutoReload() = 0;
+    // Frees the versions replaced by reload or by the functions computing the data of the records, once the
+    // calls still reading them are over. Records returned before the last new version shall not be used anymore.
+    virtual void releaseRetiredSnapshots() = 0;
 };
 
 GW2DATTOOLS_API std::unique_ptr<ANDatInterface> GW2DATTOOLS_APIENTRY createANDatInterface(const char* iDatPath);
 
+/** @Inputs:
+ *    - iDatPathVect: Archives sharing the format of Gw2.dat, Local.dat or override archives for example,
+ *                    by decreasing priority: a fileId found in several of them is read from the first one
+ *  @Return:
+ *    - Interface over the records of all the archives, looked up in a single merged index. The archiveIndex
+ *      of the records is their archive in iDatPathVect, reload checks every archive.
+ *  @Throws:
+ *    - gw2dt::exception::Exception if an archive cannot be read
+ */
+
+GW2DATTOOLS_API std::unique_ptr<ANDatInterface> GW2DATTOOLS_APIENTRY createOverlayANDatInterface(const std::vector<std::string>& iDatPathVect);
+
 }
 }
 
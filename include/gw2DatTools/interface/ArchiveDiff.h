@@ -0,0 +1,50 @@
+#ifndef GW2DATTOOLS_INTERFACE_ARCHIVEDIFF_H
+#define GW2DATTOOLS_INTERFACE_ARCHIVEDIFF_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Differences between two versions of an archive, records are matched on their fileId.
+// The content of a record is deemed unchanged if its archive, size, compression and CRC did not change.
+// A record without a meaningful CRC, such as a compressed record of a single block, is always deemed changed:
+// it could have been rewritten in place.
+// Every list is sorted by increasing fileId.
+struct ArchiveDiff
+{
+    std::vector<uint32_t> addedFileIdVect;
+    std::vector<uint32_t> removedFileIdVect;
+    std::vector<uint32_t> changedFileIdVect;    // Content changed
+    std::vector<uint32_t> remappedFileIdVect;   // Same content, but at another offset or with another baseId
+};
+
+/** @Inputs:
+ *    - iOldFileRecordVect: Records of the previous version, as returned by ANDatInterface::getFileRecordVect
+ *    - iNewFileRecordVect: Records of the current version
+ *  @Return:
+ *    - The differences between both versions
+ */
+
+GW2DATTOOLS_API ArchiveDiff GW2DATTOOLS_APIENTRY diffFileRecords(const std::vector<ANDatInterface::FileRecord>& iOldFileRecordVect,
+                                                                 const std::vector<ANDatInterface::FileRecord>& iNewFileRecordVect);
+
+/** @Inputs:
+ *    - iOldFileRecord: Record of the previous version
+ *    - iNewFileRecord: Record of the current version with the same fileId
+ *  @Return:
+ *    - true if the content of the record did not change, see ArchiveDiff
+ */
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY isSameContent(const ANDatInterface::FileRecord& iOldFileRecord, const ANDatInterface::FileRecord& iNewFileRecord);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_ARCHIVEDIFF_H
@@ -0,0 +1,52 @@
+#ifndef GW2DATTOOLS_INTERFACE_ARCHIVEEXPORT_H
+#define GW2DATTOOLS_INTERFACE_ARCHIVEEXPORT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Container written by exportArchive:
+//   ExportContainerHeader
+//   Inflated content of the records, back to back in the order of the records in the archive
+//   ExportContainerEntry, nbOfEntries times from indexOffset, sorted by fileId
+#pragma pack(push, 1)
+struct ExportContainerHeader
+{
+    uint8_t  magic[4];      // "GW2X"
+    uint32_t version;
+    uint32_t nbOfEntries;
+    uint64_t indexOffset;
+};
+
+struct ExportContainerEntry
+{
+    uint32_t fileId;
+    uint32_t baseId;
+    uint32_t size;          // Inflated
+    uint64_t offset;        // From the start of the container
+};
+#pragma pack(pop)
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to export, records are read in storage order
+ *    - iContainerPath: Path of the container, written sequentially by large blocks
+ *    - iNbOfThreads: Number of decoding threads, 0 for one per hardware thread
+ *  @Return:
+ *    - Number of exported records. Empty records and records which cannot be inflated are left out.
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the archive cannot be read or the container cannot be written
+ */
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY exportArchive(ANDatInterface& ioANDatInterface, const char* iContainerPath, uint32_t iNbOfThreads = 0);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_ARCHIVEEXPORT_H
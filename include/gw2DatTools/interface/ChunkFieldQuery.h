@@ -0,0 +1,83 @@
+#ifndef GW2DATTOOLS_INTERFACE_CHUNKFIELDQUERY_H
+#define GW2DATTOOLS_INTERFACE_CHUNKFIELDQUERY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/format/ANStructsSchema.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Extraction of one field from a chunk type, across every PackFile of the archive
+struct ChunkFieldQuery
+{
+    uint32_t packFileType;      // type[4] of the PackFiles to look at, 0 for all of them
+    std::string chunkName;      // As in ANStructs.txt: MODL, GEOM, trn, ...
+    uint32_t chunkVersion;
+
+    // Names of the fields from the root struct of the chunk, separated by dots.
+    // Arrays and pointers are followed: every element gives a value.
+    // The last field shall be a value, filenames give the file id they point to.
+    std::string fieldPath;
+};
+
+// Values extracted by a query, in the order of the records in the archive then of the chunks
+struct ChunkFieldColumn
+{
+    format::SchemaValueType valueType;
+    uint32_t valueSize;                 // 4 for filenames, which hold the file id
+
+    std::vector<uint32_t> fileIdVect;   // File each value comes from
+    std::vector<uint8_t> valueVect;     // valueSize bytes per value
+};
+
+// Column file written by saveChunkFieldColumn, sections are 16 bytes aligned
+// so that the file can be mapped and used as is
+#pragma pack(push, 1)
+struct ChunkFieldColumnFileHeader
+{
+    uint8_t  magic[4];          // "GW2C"
+    uint32_t version;
+    uint32_t valueType;
+    uint32_t valueSize;
+    uint64_t nbOfValues;
+    uint64_t fileIdOffset;      // nbOfValues uint32_t
+    uint64_t valueOffset;       // nbOfValues * valueSize bytes
+};
+#pragma pack(pop)
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to scan, its records should be classified beforehand
+ *                        (classifyFileRecords or loadIndex) so that only PackFiles are read
+ *    - iSchema: Layouts of the chunks
+ *    - iQueryVect: Queries answered by the scan
+ *    - iNbOfThreads: Number of decoding threads, 0 for one per hardware thread
+ *  @Return:
+ *    - One column per query
+ *  @Throws:
+ *    - gw2dt::exception::Exception if a query does not match the schema or the archive cannot be read.
+ *      Records which cannot be inflated or parsed are skipped.
+ */
+
+GW2DATTOOLS_API std::vector<ChunkFieldColumn> GW2DATTOOLS_APIENTRY runChunkFieldQueries(ANDatInterface& ioANDatInterface, const format::ANStructsSchema& iSchema,
+                                                                                         const std::vector<ChunkFieldQuery>& iQueryVect, uint32_t iNbOfThreads = 0);
+
+/** @Inputs:
+ *    - iColumn: Column to save
+ *    - iPath: Path of the column file
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the file cannot be written
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY saveChunkFieldColumn(const ChunkFieldColumn& iColumn, const char* iPath);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_CHUNKFIELDQUERY_H
@@ -0,0 +1,42 @@
+#ifndef GW2DATTOOLS_INTERFACE_CONTENTSEARCH_H
+#define GW2DATTOOLS_INTERFACE_CONTENTSEARCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+struct ContentSearchHit
+{
+    uint32_t fileId;
+    uint32_t patternIndex;      // In the searched patterns
+    uint32_t offset;            // In the inflated content of the record
+};
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to search, every record is read once, in offset order
+ *    - iPatternVect: Byte patterns to look for, they may hold any byte and shall not be empty
+ *    - iMaxHitsPerFile: Number of hits after which a record is not searched further, 0 for no limit
+ *    - iNbOfThreads: Number of decoding threads, 0 for one per hardware thread
+ *  @Return:
+ *    - Hits in the order of the records in the archive, then of their offset and of the patterns.
+ *      Overlapping hits are all reported.
+ *  @Throws:
+ *    - gw2dt::exception::Exception if a pattern is empty or the archive cannot be read.
+ *      Records which cannot be inflated are skipped.
+ */
+
+GW2DATTOOLS_API std::vector<ContentSearchHit> GW2DATTOOLS_APIENTRY searchContent(ANDatInterface& ioANDatInterface, const std::vector<std::string>& iPatternVect,
+                                                                                 uint32_t iMaxHitsPerFile = 0, uint32_t iNbOfThreads = 0);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_CONTENTSEARCH_H
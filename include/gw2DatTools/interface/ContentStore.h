@@ -0,0 +1,85 @@
+#ifndef GW2DATTOOLS_INTERFACE_CONTENTSTORE_H
+#define GW2DATTOOLS_INTERFACE_CONTENTSTORE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Manifest file written by extractToContentStore:
+//   ContentManifestHeader
+//   ContentManifestEntry, nbOfEntries times, sorted by fileId
+// The inflated content of a record is in the store directory, in the file named by getContentPath.
+#pragma pack(push, 1)
+struct ContentManifestHeader
+{
+    uint8_t  magic[4];      // "GW2M"
+    uint32_t version;
+    uint32_t nbOfEntries;
+};
+
+struct ContentManifestEntry
+{
+    uint32_t fileId;
+    uint32_t size;          // Of the record as stored in the dat
+    uint32_t crc;           // Of the record as stored in the dat, see ANDatInterface::FileRecord
+    uint32_t contentSize;   // Once inflated
+    uint64_t hash[2];       // MurmurHash3_x64_128 of the inflated content
+};
+#pragma pack(pop)
+
+struct ContentStoreStats
+{
+    uint32_t nbOfRecords;           // In the manifest
+    uint32_t nbOfReusedRecords;     // Unchanged since the previous manifest, not read at all
+    uint32_t nbOfWrittenContents;   // Not in the store yet, the others are duplicates
+    uint64_t nbOfWrittenBytes;
+};
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to extract, records are read in storage order
+ *    - iStorePath: Existing directory holding the contents, shared by every build extracted to it
+ *    - iManifestPath: Path of the manifest of the archive
+ *    - iPreviousManifestPath: Manifest of a previous build extracted to the same store, nullptr if none.
+ *                             Records whose size and CRC did not change are not read again.
+ *    - iNbOfThreads: Number of decoding threads, 0 for one per hardware thread
+ *  @Return:
+ *    - What was extracted
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the archive cannot be read, or the store or the manifest cannot be written.
+ *      Records which cannot be inflated are left out of the manifest.
+ */
+
+GW2DATTOOLS_API ContentStoreStats GW2DATTOOLS_APIENTRY extractToContentStore(ANDatInterface& ioANDatInterface, const char* iStorePath, const char* iManifestPath,
+                                                                             const char* iPreviousManifestPath = nullptr, uint32_t iNbOfThreads = 0);
+
+/** @Inputs:
+ *    - iManifestPath: Path of the manifest
+ *  @Outputs:
+ *    - oEntryVect: Entries of the manifest
+ *  @Return:
+ *    - false if the manifest is missing or broken
+ */
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY loadContentManifest(const char* iManifestPath, std::vector<ContentManifestEntry>& oEntryVect);
+
+/** @Inputs:
+ *    - iStorePath: Directory of the store
+ *    - iEntry: Entry of a manifest
+ *  @Return:
+ *    - Path of the file holding the content of the entry
+ */
+
+GW2DATTOOLS_API std::string GW2DATTOOLS_APIENTRY getContentPath(const char* iStorePath, const ContentManifestEntry& iEntry);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_CONTENTSTORE_H
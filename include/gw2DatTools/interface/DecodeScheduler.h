@@ -0,0 +1,85 @@
+#ifndef GW2DATTOOLS_INTERFACE_DECODESCHEDULER_H
+#define GW2DATTOOLS_INTERFACE_DECODESCHEDULER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Decode submitted to a DecodeScheduler, can be waited for and cancelled from any thread
+class GW2DATTOOLS_API DecodeTicket
+{
+public:
+    enum Status
+    {
+        ST_PENDING,     // Queued or being decoded
+        ST_DONE,
+        ST_FAILED,      // Record could not be read or inflated, see getErrorMessage
+        ST_CANCELLED,
+        ST_EXPIRED      // Deadline was reached before the end of the decode
+    };
+
+    virtual ~DecodeTicket() {};
+
+    // Stops the decode at the next check, it does nothing once the decode is over
+    virtual void cancel() = 0;
+
+    virtual Status getStatus() const = 0;
+
+    // Blocks until the decode is over, returns its status
+    virtual Status wait() = 0;
+    // Same as wait, returns ST_PENDING if the decode is still not over after iTimeoutMs
+    virtual Status waitFor(uint32_t iTimeoutMs) = 0;
+
+    // Inflated content, once the status is ST_DONE
+    virtual const std::vector<uint8_t>& getBuffer() const = 0;
+    virtual const std::string& getErrorMessage() const = 0;
+};
+
+// Pool of decoding threads shared by latency-sensitive and bulk work. Each thread has a queue per priority
+// and steals from the others once its own queues are empty. Decodes are done by steps: between two steps,
+// a decode checks its cancellation and deadline, and a decode of lower priority gives its thread back to
+// queued work of higher priority, it resumes later where it stopped.
+class GW2DATTOOLS_API DecodeScheduler
+{
+public:
+    enum Priority
+    {
+        PR_INTERACTIVE,  // Someone waits for the record
+        PR_NORMAL,
+        PR_BULK          // Background jobs
+    };
+
+    virtual ~DecodeScheduler() {};
+
+    // Reads and inflates a record of the interface of the scheduler.
+    // iDeadlineMs is counted from now, 0 for no deadline.
+    virtual std::shared_ptr<DecodeTicket> submit(const ANDatInterface::FileRecord& iFileRecord, Priority iPriority, uint32_t iDeadlineMs = 0) = 0;
+
+    // Inflates a compressed buffer, which shall stay valid until the decode is over
+    virtual std::shared_ptr<DecodeTicket> submitBuffer(uint32_t iInputSize, const uint8_t* iInputTab, Priority iPriority, uint32_t iDeadlineMs = 0) = 0;
+};
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive the submitted records are read from, it shall outlive the scheduler.
+ *    - iNbOfThreads: Number of decoding threads, 0 for one per hardware thread
+ *  @Return:
+ *    - The scheduler, decodes not over when it is destroyed are cancelled
+ *  @Throws:
+ *    - gw2dt::exception::Exception if no decoding thread can be started
+ */
+
+GW2DATTOOLS_API std::unique_ptr<DecodeScheduler> GW2DATTOOLS_APIENTRY createDecodeScheduler(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads = 0);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_DECODESCHEDULER_H
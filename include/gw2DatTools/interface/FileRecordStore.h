@@ -0,0 +1,95 @@
+#ifndef GW2DATTOOLS_INTERFACE_FILERECORDSTORE_H
+#define GW2DATTOOLS_INTERFACE_FILERECORDSTORE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Bits of FileRecordStore::flagVect
+const uint8_t sFileRecordCompressedFlag = 0x01;
+
+// Records as packed columns, all indexed like the records they were built from. It takes about 30 bytes
+// per record instead of sizeof(ANDatInterface::FileRecord), and a query only reads the columns it needs.
+struct FileRecordStore
+{
+    std::vector<uint64_t> offsetVect;
+    std::vector<uint32_t> sizeVect;
+    std::vector<uint32_t> baseIdVect;
+    std::vector<uint32_t> fileIdVect;
+    std::vector<uint8_t> flagVect;
+    std::vector<uint8_t> fileTypeVect;          // ANDatInterface::FileType
+    std::vector<uint32_t> packFileTypeVect;
+
+    std::vector<uint32_t> uncompressedSizeVect; // Empty if no compressed record has its uncompressed size
+    std::vector<uint32_t> archiveIndexVect;     // Empty if every record is in the first archive
+};
+
+// A record matches if every condition holds, the default filter matches every record
+struct FileRecordFilter
+{
+    FileRecordFilter() :
+        minSize(0),
+        maxSize(0xFFFFFFFF),
+        flagMask(0),
+        flagValue(0),
+        fileTypeMask(0xFFFFFFFF),
+        packFileType(0)
+    {
+    }
+
+    uint32_t minSize;       // Size as stored, inclusive
+    uint32_t maxSize;
+
+    uint8_t flagMask;       // (flags & flagMask) == flagValue
+    uint8_t flagValue;
+
+    uint32_t fileTypeMask;  // Bit (1 << fileType) is set for each accepted FileType
+    uint32_t packFileType;  // 0 for any
+};
+
+/** @Inputs:
+ *    - iFileRecordVect: Records to store, as returned by ANDatInterface::getFileRecordVect
+ *  @Return:
+ *    - The store, index i of every column being iFileRecordVect[i]
+ */
+
+GW2DATTOOLS_API FileRecordStore GW2DATTOOLS_APIENTRY buildFileRecordStore(const std::vector<ANDatInterface::FileRecord>& iFileRecordVect);
+
+/** @Inputs:
+ *    - iFileRecordStore: Records to filter
+ *    - iFileRecordFilter: Conditions on the records
+ *  @Return:
+ *    - Indexes of the matching records, in increasing order
+ */
+
+GW2DATTOOLS_API std::vector<uint32_t> GW2DATTOOLS_APIENTRY filterFileRecords(const FileRecordStore& iFileRecordStore, const FileRecordFilter& iFileRecordFilter);
+
+/** @Inputs:
+ *    - iFileRecordStore: Records the indexes refer to
+ *    - ioIndexVect: Indexes of records, sorted in place by archive then offset, so that they can be read forward
+ *  @Throws:
+ *    - gw2dt::exception::Exception if an index is out of the store
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY sortByOffset(const FileRecordStore& iFileRecordStore, std::vector<uint32_t>& ioIndexVect);
+
+/** @Inputs:
+ *    - iFileRecordStore: Records the indexes refer to
+ *    - ioIndexVect: Indexes of records, sorted in place by fileId
+ *  @Throws:
+ *    - gw2dt::exception::Exception if an index is out of the store
+ */
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY sortByFileId(const FileRecordStore& iFileRecordStore, std::vector<uint32_t>& ioIndexVect);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_FILERECORDSTORE_H
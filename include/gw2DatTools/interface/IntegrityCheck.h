@@ -0,0 +1,41 @@
+#ifndef GW2DATTOOLS_INTERFACE_INTEGRITYCHECK_H
+#define GW2DATTOOLS_INTERFACE_INTEGRITYCHECK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// blockIndex of the errors on the CRC of a whole record
+const uint32_t sRecordCrcBlockIndex = 0xFFFFFFFF;
+
+struct IntegrityError
+{
+    uint32_t fileId;
+    uint32_t blockIndex;        // Block of a compressed record, see compression::sDatFileBlockSize, or sRecordCrcBlockIndex
+    uint32_t expectedCrc;
+    uint32_t computedCrc;
+};
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to check, every record is read once, in offset order
+ *    - iNbOfThreads: Number of checking threads, 0 for one per hardware thread
+ *  @Return:
+ *    - Mismatching CRCs, in the order of the records in the archive then of their blocks.
+ *      Empty if the archive is sound. The CRCs of the MFT are only checked when they are set.
+ *  @Throws:
+ *    - gw2dt::exception::Exception if the archive cannot be read
+ */
+
+GW2DATTOOLS_API std::vector<IntegrityError> GW2DATTOOLS_APIENTRY verifyArchive(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads = 0);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_INTEGRITYCHECK_H
@@ -0,0 +1,105 @@
+#ifndef GW2DATTOOLS_INTERFACE_RECORDREADER_H
+#define GW2DATTOOLS_INTERFACE_RECORDREADER_H
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "gw2DatTools/dllMacros.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+#include "gw2DatTools/interface/FileRecordStore.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Default number of records a RecordReader holds, the one being used included
+const uint32_t sRecordReaderNbOfBuffers = 4;
+
+// Record with its content once inflated
+struct DecodedRecord
+{
+    const ANDatInterface::FileRecord* pFileRecord;
+    uint32_t size;
+    const uint8_t* pTab;    // Valid until the reader moves to the next record
+};
+
+// Reads and inflates the records ahead of the consumer on a background thread, in storage order.
+// Contents are held by a fixed number of buffers reused from one record to the next.
+// Records which cannot be read or inflated are skipped.
+class GW2DATTOOLS_API RecordReader
+{
+public:
+    // Input iterator over the records left in the reader, so that it can be used in a range-based for loop
+    class Iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef DecodedRecord value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const DecodedRecord* pointer;
+        typedef const DecodedRecord& reference;
+
+        Iterator() : _pReader(nullptr) {}
+        explicit Iterator(RecordReader& ioReader) : _pReader(&ioReader) { ++(*this); }
+
+        const DecodedRecord& operator*() const { return _record; }
+        const DecodedRecord* operator->() const { return &_record; }
+
+        Iterator& operator++()
+        {
+            if (!_pReader->next(_record))
+            {
+                _pReader = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& iOther) const { return _pReader == iOther._pReader; }
+        bool operator!=(const Iterator& iOther) const { return _pReader != iOther._pReader; }
+
+    private:
+        RecordReader* _pReader; // nullptr at the end
+        DecodedRecord _record;
+    };
+
+    virtual ~RecordReader() {};
+
+    // Moves to the next record, releasing the buffer of the previous one. Returns false once every record was read.
+    virtual bool next(DecodedRecord& oRecord) = 0;
+
+    Iterator begin() { return Iterator(*this); }
+    Iterator end() { return Iterator(); }
+};
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to read, it shall outlive the reader. Its getBuffer is called by
+ *                        the background thread.
+ *    - iFileRecordFilter: Conditions on the records to read, see filterFileRecords
+ *    - iNbOfBuffers: Number of records held at once, at least 2, the one being used included
+ *  @Return:
+ *    - The reader, already reading ahead
+ */
+
+GW2DATTOOLS_API std::unique_ptr<RecordReader> GW2DATTOOLS_APIENTRY createRecordReader(ANDatInterface& ioANDatInterface,
+                                                                                       const FileRecordFilter& iFileRecordFilter = FileRecordFilter(),
+                                                                                       uint32_t iNbOfBuffers = sRecordReaderNbOfBuffers);
+
+/** @Inputs:
+ *    - ioANDatInterface: Archive to read, same as above
+ *    - iFileRecordPtrVect: Records to read, from ioANDatInterface, they are read in storage order
+ *    - iNbOfBuffers: Number of records held at once, at least 2, the one being used included
+ *  @Return:
+ *    - The reader, already reading ahead
+ */
+
+GW2DATTOOLS_API std::unique_ptr<RecordReader> GW2DATTOOLS_APIENTRY createRecordReader(ANDatInterface& ioANDatInterface,
+                                                                                       const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                                                                                       uint32_t iNbOfBuffers = sRecordReaderNbOfBuffers);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_RECORDREADER_H
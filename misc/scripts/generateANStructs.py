@@ -0,0 +1,268 @@
+#!/usr/bin/env python
+#
+# Generates the zero-copy chunk views of gw2DatTools/format/anstructs from
+# misc/templates/ANStructs.txt, the 010Editor templates extracted by
+# misc/ida/parseANStructs.idc.
+#
+# One header is written per chunk, holding a namespace per version. The last
+# struct of a version is the root of the chunk, it is aliased as Root.
+# Chunks appearing several times in ANStructs.txt (they belong to different
+# PackFile types) get a numbered suffix, in order of appearance.
+#
+# Usage: generateANStructs.py <ANStructs.txt> <output directory>
+
+import os
+import re
+import sys
+
+# TypesDef.bt type -> (C++ type, size)
+PRIMITIVE_TYPES = {
+    'byte':      ('int8_t', 1),
+    'byte3':     ('gw2dt::format::byte3', 3),
+    'byte4':     ('gw2dt::format::byte4', 4),
+    'byte16':    ('gw2dt::format::byte16', 16),
+    'word':      ('int16_t', 2),
+    'word3':     ('gw2dt::format::word3', 6),
+    'dword':     ('int32_t', 4),
+    'dword2':    ('gw2dt::format::dword2', 8),
+    'dword4':    ('gw2dt::format::dword4', 16),
+    'qword':     ('int64_t', 8),
+    'float':     ('float', 4),
+    'float2':    ('gw2dt::format::float2', 8),
+    'float3':    ('gw2dt::format::float3', 12),
+    'float4':    ('gw2dt::format::float4', 16),
+    'fileref':   ('int32_t', 4),
+    'filename':  ('gw2dt::format::FilenameView', 4),
+    'wchar_ptr': ('gw2dt::format::WCharPtrView', 4),
+    'char_ptr':  ('gw2dt::format::CharPtrView', 4),
+}
+
+# Encoding -> (C++ template, size)
+POINTER_ENCODINGS = {
+    'TPTR_START':                  ('gw2dt::format::PtrView', 4),
+    'TSTRUCT_ARRAY_PTR_START':     ('gw2dt::format::ArrayView', 8),
+    'TSTRUCT_PTR_ARRAY_PTR_START': ('gw2dt::format::PtrArrayView', 8),
+}
+
+CHUNK_REGEX = re.compile(r'^\s*Chunk: (\S+), versions: (\d+)')
+VERSION_REGEX = re.compile(r'^=> Version: (\d+)')
+STRUCT_END_REGEX = re.compile(r'^\}\s*(\w+)<optimize=false>;')
+FIELD_REGEX = re.compile(r'^(?:(TPTR_START|TSTRUCT_ARRAY_PTR_START|TSTRUCT_PTR_ARRAY_PTR_START) )?(\w+) ([\w.]+)(?:\[(\d+)\])?(?: \w+)?;$')
+
+
+class Field(object):
+    def __init__(self, encoding, typeName, name, count):
+        self.encoding = encoding
+        self.typeName = typeName
+        self.name = name
+        self.count = count
+
+
+class Struct(object):
+    def __init__(self, name, fields):
+        self.name = name
+        self.fields = fields
+
+
+def parse(iInputPath):
+    aChunks = []
+    aChunk = None
+    aVersion = None
+    aFields = None
+
+    with open(iInputPath) as aFile:
+        for aLine in aFile:
+            aLine = aLine.rstrip()
+
+            aMatch = CHUNK_REGEX.match(aLine)
+            if aMatch:
+                aChunk = (aMatch.group(1), [])
+                aChunks.append(aChunk)
+                continue
+
+            aMatch = VERSION_REGEX.match(aLine)
+            if aMatch:
+                aVersion = (int(aMatch.group(1)), [])
+                aChunk[1].append(aVersion)
+                continue
+
+            if aLine.startswith('typedef struct'):
+                aFields = []
+                continue
+
+            aMatch = STRUCT_END_REGEX.match(aLine)
+            if aMatch:
+                aVersion[1].append(Struct(aMatch.group(1), aFields))
+                aFields = None
+                continue
+
+            if aFields is not None and aLine.strip() not in ('', '{'):
+                aMatch = FIELD_REGEX.match(aLine.strip())
+                if not aMatch:
+                    raise ValueError('Unexpected field: ' + aLine)
+                aFields.append(Field(aMatch.group(1), aMatch.group(2), aMatch.group(3),
+                                     int(aMatch.group(4)) if aMatch.group(4) else None))
+
+    return aChunks
+
+
+def getAccessorName(iFieldName):
+    aName = iFieldName.replace('.', '')
+    return 'get' + aName[0].upper() + aName[1:]
+
+
+def generateVersion(iVersion, iStructs, oLines):
+    # Structs may be redefined in a version, later fields use the latest definition
+    aDefinitions = {}       # ANStructs name -> (C++ name, size or None if unknown)
+    aNameCounts = {}
+
+    oLines.append('namespace v%d' % iVersion)
+    oLines.append('{')
+    oLines.append('')
+
+    for aStruct in iStructs:
+        aNameCounts[aStruct.name] = aNameCounts.get(aStruct.name, 0) + 1
+        aCppName = aStruct.name
+        if aNameCounts[aStruct.name] > 1:
+            aCppName = '%s_%d' % (aStruct.name, aNameCounts[aStruct.name])
+
+        aAccessors = []
+        anOffset = 0
+        aUsedNames = set()
+
+        for aField in aStruct.fields:
+            if aField.encoding is not None:
+                aTemplate, aFieldSize = POINTER_ENCODINGS[aField.encoding]
+                if aField.typeName in PRIMITIVE_TYPES:
+                    anElementType = PRIMITIVE_TYPES[aField.typeName][0]
+                elif aField.typeName in aDefinitions:
+                    anElementType = aDefinitions[aField.typeName][0]
+                else:
+                    anElementType = None
+                aCppType = '%s<%s>' % (aTemplate, anElementType) if anElementType else None
+            elif aField.typeName in PRIMITIVE_TYPES:
+                aCppType, aFieldSize = PRIMITIVE_TYPES[aField.typeName]
+            elif aField.typeName in aDefinitions:
+                aCppType, aFieldSize = aDefinitions[aField.typeName]
+            else:
+                aCppType, aFieldSize = None, None
+
+            # Pointed types only need to be known, not to be sized. The layout of
+            # anything after a field of unknown size is unknown too.
+            if anOffset is None or aCppType is None or aFieldSize is None:
+                aAccessors.append('    // %s: layout unknown, no accessor' % aField.name)
+                if aField.encoding is None:
+                    anOffset = None
+                else:
+                    anOffset = anOffset + aFieldSize if anOffset is not None else None
+                continue
+
+            aName = getAccessorName(aField.name)
+            while aName in aUsedNames:
+                aName += '_'
+            aUsedNames.add(aName)
+
+            if aField.count is None:
+                aAccessors.append('    %s %s() const { return getField<%s>(%d); }' % (aCppType, aName, aCppType, anOffset))
+                anOffset += aFieldSize
+            else:
+                aAccessors.append('    %s %s(uint32_t iIndex) const { return getField<%s>(%d, iIndex, %d); }' % (aCppType, aName, aCppType, anOffset, aField.count))
+                anOffset += aFieldSize * aField.count
+
+        if anOffset is None:
+            oLines.append('// %s: layout unknown, no view' % aStruct.name)
+            oLines.append('')
+            aDefinitions[aStruct.name] = (None, None)
+            continue
+
+        aDefinitions[aStruct.name] = (aCppName, anOffset)
+
+        oLines.append('struct %s : public gw2dt::format::StructView' % aCppName)
+        oLines.append('{')
+        oLines.append('    static const uint32_t sSize = %d;' % anOffset)
+        oLines.append('')
+        oLines.append('    %s(const gw2dt::format::ChunkSpan& iSpan, const uint8_t* ipPos) : StructView(iSpan, ipPos, sSize) {}' % aCppName)
+        oLines.append('    explicit %s(const gw2dt::format::PackFileChunk& iChunk) : StructView(iChunk, iChunk.pData, sSize) {}' % aCppName)
+        if aAccessors:
+            oLines.append('')
+            oLines.extend(aAccessors)
+        oLines.append('};')
+        oLines.append('')
+
+    if iStructs and aDefinitions[iStructs[-1].name][0] is not None:
+        oLines.append('typedef %s Root;' % aDefinitions[iStructs[-1].name][0])
+        oLines.append('')
+
+    oLines.append('}')
+    oLines.append('')
+
+
+def generateChunk(iChunkName, iVersions, iOutputDir):
+    aGuard = 'GW2DATTOOLS_FORMAT_ANSTRUCTS_%s_H' % iChunkName.upper()
+
+    aLines = []
+    aLines.append('// Generated by misc/scripts/generateANStructs.py from misc/templates/ANStructs.txt, do not edit.')
+    aLines.append('')
+    aLines.append('#ifndef %s' % aGuard)
+    aLines.append('#define %s' % aGuard)
+    aLines.append('')
+    aLines.append('#include "gw2DatTools/format/StructView.h"')
+    aLines.append('')
+    aLines.append('namespace gw2dt')
+    aLines.append('{')
+    aLines.append('namespace format')
+    aLines.append('{')
+    aLines.append('namespace anstructs')
+    aLines.append('{')
+    aLines.append('namespace %s' % iChunkName)
+    aLines.append('{')
+    aLines.append('')
+
+    for aVersion, aStructs in iVersions:
+        generateVersion(aVersion, aStructs, aLines)
+
+    aLines.append('}')
+    aLines.append('}')
+    aLines.append('}')
+    aLines.append('}')
+    aLines.append('')
+    aLines.append('#endif // %s' % aGuard)
+    aLines.append('')
+
+    aContent = '\n'.join(aLines)
+    aPath = os.path.join(iOutputDir, iChunkName + '.h')
+
+    # Leaving untouched headers alone, so that their dependents are not rebuilt
+    if os.path.exists(aPath):
+        with open(aPath) as aFile:
+            if aFile.read() == aContent:
+                return
+
+    with open(aPath, 'w') as aFile:
+        aFile.write(aContent)
+
+
+def main(iArgs):
+    if len(iArgs) != 3:
+        sys.stderr.write('Usage: %s <ANStructs.txt> <output directory>\n' % iArgs[0])
+        return 1
+
+    aChunks = parse(iArgs[1])
+
+    if not os.path.isdir(iArgs[2]):
+        os.makedirs(iArgs[2])
+
+    # File names shall not clash on case insensitive file systems
+    aNameCounts = {}
+    for aChunkName, aVersions in aChunks:
+        aName = re.sub(r'\W', '_', aChunkName)
+        aNameCounts[aName.lower()] = aNameCounts.get(aName.lower(), 0) + 1
+        if aNameCounts[aName.lower()] > 1:
+            aName = '%s_%d' % (aName, aNameCounts[aName.lower()])
+        generateChunk(aName, aVersions, iArgs[2])
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,59 @@
+#ifndef GW2DATTOOLS_COMPRESSION_DATFILEINFLATER_H
+#define GW2DATTOOLS_COMPRESSION_DATFILEINFLATER_H
+
+#include <cstdint>
+#include <memory>
+
+namespace gw2dt
+{
+namespace compression
+{
+namespace dat
+{
+
+// Farthest a copy can look back in the output
+const uint32_t sDatFileMaxWriteOffset = 131072;
+
+// Inflates a dat file buffer piece by piece, so that the output does not
+// have to be held entirely in memory. The input can be given piece by piece too.
+// The decoding state is kept out of this header, as the dat HuffmanTree
+// template clashes with the texture one.
+class DatFileInflater
+{
+public:
+    // The whole compressed buffer is given at once
+    DatFileInflater(uint32_t iInputSize, const uint8_t* iInputTab);
+    // The compressed buffer is given piece by piece with setInput
+    DatFileInflater();
+    ~DatFileInflater();
+
+    // Size of the uncompressed data, as stored in the header, 0 until the header is in the input
+    uint32_t getOutputSize() const;
+
+    // Bytes at the end of the last input which were not read yet
+    uint32_t getInputSize() const;
+
+    // iInputTab starts with the getInputSize bytes left from the previous input, followed by the next bytes
+    // of the compressed buffer. iIsLast once the end of the compressed buffer is in the input.
+    // The input shall stay valid until the next call.
+    void setInput(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsLast);
+
+    // Inflates into ioOutputTab, from ioOutputPos up to iOutputEnd.
+    // The sDatFileMaxWriteOffset bytes before ioOutputPos (or all of them if
+    // there are fewer) shall hold the previously inflated data.
+    // Until the last input is given, stops before iOutputEnd once the input
+    // left may not hold the next code.
+    // Returns false once the compressed stream is exhausted.
+    bool inflate(uint8_t* ioOutputTab, uint32_t& ioOutputPos, uint32_t iOutputEnd);
+
+private:
+    struct State;
+
+    std::unique_ptr<State> _pState;
+};
+
+}
+}
+}
+
+#endif // GW2DATTOOLS_COMPRESSION_DATFILEINFLATER_H
@@ -0,0 +1,407 @@
+#include "decodeTextureBlocks.h"
+
+#include <memory.h>
+#include <algorithm>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GW2DATTOOLS_TEXTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace gw2dt
+{
+namespace compression
+{
+namespace texture
+{
+
+inline uint16_t readWord(const uint8_t* iTab)
+{
+    return static_cast<uint16_t>(iTab[0] | (iTab[1] << 8));
+}
+
+inline uint32_t readDWord(const uint8_t* iTab)
+{
+    return iTab[0] | (iTab[1] << 8) | (iTab[2] << 16) | (static_cast<uint32_t>(iTab[3]) << 24);
+}
+
+// Computes the RGBA8 palettes of two 565 color components at once
+// iIsFourColorsForced: BC2/BC3 color components never use the three colors + transparent mode
+void computeColorPalettes(const uint8_t* iComponentA, const uint8_t* iComponentB, bool iIsFourColorsForced, uint32_t* oPaletteA, uint32_t* oPaletteB)
+{
+    uint16_t aColor0A = readWord(iComponentA);
+    uint16_t aColor1A = readWord(iComponentA + 2);
+    uint16_t aColor0B = readWord(iComponentB);
+    uint16_t aColor1B = readWord(iComponentB + 2);
+
+    bool isFourColorsA = iIsFourColorsForced || aColor0A > aColor1A;
+    bool isFourColorsB = iIsFourColorsForced || aColor0B > aColor1B;
+
+#ifdef GW2DATTOOLS_TEXTURE_SSE2
+    // One 16 bits lane per channel: [R G B A] of A then [R G B A] of B
+    const __m128i aChannelMask = _mm_setr_epi16(static_cast<short>(0xF800), 0x07E0, 0x001F, 0, static_cast<short>(0xF800), 0x07E0, 0x001F, 0);
+    const __m128i aHighShift1  = _mm_setr_epi16(1 << 8, 1 << 13, 0, 0, 1 << 8, 1 << 13, 0, 0);         // r << 3, g << 2
+    const __m128i aLowShift1   = _mm_setr_epi16(0, 0, 8, 0, 0, 0, 8, 0);                               // b << 3
+    const __m128i aHighShift2  = _mm_setr_epi16(1 << 3, 1 << 7, 1 << 14, 0, 1 << 3, 1 << 7, 1 << 14, 0); // r >> 2, g >> 4, b >> 2
+    const __m128i anAlpha      = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i aOneThird    = _mm_set1_epi16(0x5556);
+
+    __m128i aColor0 = _mm_and_si128(_mm_setr_epi16(aColor0A, aColor0A, aColor0A, 0, aColor0B, aColor0B, aColor0B, 0), aChannelMask);
+    __m128i aColor1 = _mm_and_si128(_mm_setr_epi16(aColor1A, aColor1A, aColor1A, 0, aColor1B, aColor1B, aColor1B, 0), aChannelMask);
+
+    __m128i aPalette0 = _mm_or_si128(_mm_or_si128(_mm_mulhi_epu16(aColor0, aHighShift1), _mm_mullo_epi16(aColor0, aLowShift1)),
+                                     _mm_or_si128(_mm_mulhi_epu16(aColor0, aHighShift2), anAlpha));
+    __m128i aPalette1 = _mm_or_si128(_mm_or_si128(_mm_mulhi_epu16(aColor1, aHighShift1), _mm_mullo_epi16(aColor1, aLowShift1)),
+                                     _mm_or_si128(_mm_mulhi_epu16(aColor1, aHighShift2), anAlpha));
+
+    // Four colors mode: 2/3 p0 + 1/3 p1, 1/3 p0 + 2/3 p1
+    __m128i aFourColors2 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(aPalette0, aPalette0), aPalette1), aOneThird);
+    __m128i aFourColors3 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(aPalette1, aPalette1), aPalette0), aOneThird);
+
+    // Three colors mode: 1/2 p0 + 1/2 p1, transparent black
+    __m128i aThreeColors2 = _mm_srli_epi16(_mm_add_epi16(aPalette0, aPalette1), 1);
+
+    short aMaskA = isFourColorsA ? -1 : 0;
+    short aMaskB = isFourColorsB ? -1 : 0;
+    __m128i aModeMask = _mm_setr_epi16(aMaskA, aMaskA, aMaskA, aMaskA, aMaskB, aMaskB, aMaskB, aMaskB);
+
+    __m128i aPalette2 = _mm_or_si128(_mm_and_si128(aModeMask, aFourColors2), _mm_andnot_si128(aModeMask, aThreeColors2));
+    __m128i aPalette3 = _mm_and_si128(aModeMask, aFourColors3);
+
+    uint32_t aPaletteTab[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&aPaletteTab[0]), _mm_packus_epi16(aPalette0, aPalette1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&aPaletteTab[4]), _mm_packus_epi16(aPalette2, aPalette3));
+
+    oPaletteA[0] = aPaletteTab[0];
+    oPaletteA[1] = aPaletteTab[2];
+    oPaletteA[2] = aPaletteTab[4];
+    oPaletteA[3] = aPaletteTab[6];
+
+    oPaletteB[0] = aPaletteTab[1];
+    oPaletteB[1] = aPaletteTab[3];
+    oPaletteB[2] = aPaletteTab[5];
+    oPaletteB[3] = aPaletteTab[7];
+#else
+    const uint16_t aColors[2][2] = { { aColor0A, aColor1A }, { aColor0B, aColor1B } };
+    const bool isFourColors[2] = { isFourColorsA, isFourColorsB };
+    uint32_t* aPalettes[2] = { oPaletteA, oPaletteB };
+
+    for (uint32_t aComponentIndex = 0; aComponentIndex < 2; ++aComponentIndex)
+    {
+        uint32_t aChannels[2][3];
+        for (uint32_t aColorIndex = 0; aColorIndex < 2; ++aColorIndex)
+        {
+            uint32_t aColor = aColors[aComponentIndex][aColorIndex];
+            uint32_t aRed = (aColor >> 11) & 0x1F;
+            uint32_t aGreen = (aColor >> 5) & 0x3F;
+            uint32_t aBlue = aColor & 0x1F;
+
+            aChannels[aColorIndex][0] = (aRed << 3) | (aRed >> 2);
+            aChannels[aColorIndex][1] = (aGreen << 2) | (aGreen >> 4);
+            aChannels[aColorIndex][2] = (aBlue << 3) | (aBlue >> 2);
+        }
+
+        uint32_t* pPalette = aPalettes[aComponentIndex];
+        pPalette[0] = aChannels[0][0] | (aChannels[0][1] << 8) | (aChannels[0][2] << 16) | 0xFF000000;
+        pPalette[1] = aChannels[1][0] | (aChannels[1][1] << 8) | (aChannels[1][2] << 16) | 0xFF000000;
+        pPalette[2] = 0xFF000000;
+        pPalette[3] = 0;
+
+        for (uint32_t aChannelIndex = 0; aChannelIndex < 3; ++aChannelIndex)
+        {
+            uint32_t aValue0 = aChannels[0][aChannelIndex];
+            uint32_t aValue1 = aChannels[1][aChannelIndex];
+
+            if (isFourColors[aComponentIndex])
+            {
+                pPalette[2] |= ((2 * aValue0 + aValue1) / 3) << (8 * aChannelIndex);
+                pPalette[3] |= ((aValue0 + 2 * aValue1) / 3) << (8 * aChannelIndex);
+            }
+            else
+            {
+                pPalette[2] |= ((aValue0 + aValue1) / 2) << (8 * aChannelIndex);
+            }
+        }
+
+        if (isFourColors[aComponentIndex])
+        {
+            pPalette[3] |= 0xFF000000;
+        }
+    }
+#endif
+}
+
+// Computes the 8 entries palette of an interpolated component (BC3 alpha, BC4, BC5)
+void computeInterpolatedPalette(const uint8_t* iComponent, uint8_t* oPalette)
+{
+    uint16_t aValue0 = iComponent[0];
+    uint16_t aValue1 = iComponent[1];
+
+#ifdef GW2DATTOOLS_TEXTURE_SSE2
+    __m128i aValues0 = _mm_set1_epi16(aValue0);
+    __m128i aValues1 = _mm_set1_epi16(aValue1);
+    __m128i aPalette;
+
+    if (aValue0 > aValue1)
+    {
+        const __m128i aWeights0 = _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1);
+        const __m128i aWeights1 = _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6);
+        __m128i aSum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(aValues0, aWeights0), _mm_mullo_epi16(aValues1, aWeights1)), _mm_set1_epi16(3));
+        aPalette = _mm_mulhi_epu16(aSum, _mm_set1_epi16(9363)); // / 7
+    }
+    else
+    {
+        const __m128i aWeights0 = _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0);
+        const __m128i aWeights1 = _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0);
+        __m128i aSum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(aValues0, aWeights0), _mm_mullo_epi16(aValues1, aWeights1)), _mm_set1_epi16(2));
+        aPalette = _mm_mulhi_epu16(aSum, _mm_set1_epi16(13108)); // / 5
+        aPalette = _mm_or_si128(aPalette, _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+    }
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(oPalette), _mm_packus_epi16(aPalette, aPalette));
+#else
+    oPalette[0] = static_cast<uint8_t>(aValue0);
+    oPalette[1] = static_cast<uint8_t>(aValue1);
+
+    if (aValue0 > aValue1)
+    {
+        for (uint32_t anIndex = 1; anIndex < 7; ++anIndex)
+        {
+            oPalette[anIndex + 1] = static_cast<uint8_t>(((7 - anIndex) * aValue0 + anIndex * aValue1 + 3) / 7);
+        }
+    }
+    else
+    {
+        for (uint32_t anIndex = 1; anIndex < 5; ++anIndex)
+        {
+            oPalette[anIndex + 1] = static_cast<uint8_t>(((5 - anIndex) * aValue0 + anIndex * aValue1 + 2) / 5);
+        }
+        oPalette[6] = 0;
+        oPalette[7] = 255;
+    }
+#endif
+}
+
+// Expands an interpolated component into 16 values, one per pixel
+void decodeInterpolatedComponent(const uint8_t* iComponent, uint8_t* oValues)
+{
+    uint8_t aPalette[8];
+    computeInterpolatedPalette(iComponent, aPalette);
+
+    uint64_t anIndices = readDWord(iComponent + 2) | (static_cast<uint64_t>(readWord(iComponent + 6)) << 32);
+
+    for (uint32_t aPixelIndex = 0; aPixelIndex < 16; ++aPixelIndex)
+    {
+        oValues[aPixelIndex] = aPalette[anIndices & 0x07];
+        anIndices >>= 3;
+    }
+}
+
+// Expands an explicit 4 bits alpha component into 16 values, one per pixel
+void decodeExplicitAlphaComponent(const uint8_t* iComponent, uint8_t* oValues)
+{
+    for (uint32_t aByteIndex = 0; aByteIndex < 8; ++aByteIndex)
+    {
+        oValues[2 * aByteIndex]     = (iComponent[aByteIndex] & 0x0F) * 17;
+        oValues[2 * aByteIndex + 1] = (iComponent[aByteIndex] >> 4) * 17;
+    }
+}
+
+// Writes a 4x4 RGBA8 block given its color palette and optionally its alpha values
+void writeColorBlock(const uint32_t* iPalette, uint32_t iIndices, const uint8_t* iAlphaValues, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    for (uint32_t aRow = 0; aRow < 4; ++aRow)
+    {
+        uint32_t aRowIndices = iIndices >> (8 * aRow);
+        uint32_t* pOutputRow = reinterpret_cast<uint32_t*>(ioOutputTab + aRow * iOutputPitch);
+
+#ifdef GW2DATTOOLS_TEXTURE_SSE2
+        __m128i aPixels = _mm_setr_epi32(iPalette[aRowIndices & 0x03], iPalette[(aRowIndices >> 2) & 0x03],
+                                         iPalette[(aRowIndices >> 4) & 0x03], iPalette[(aRowIndices >> 6) & 0x03]);
+        if (iAlphaValues != nullptr)
+        {
+            const uint8_t* pAlphas = iAlphaValues + 4 * aRow;
+            __m128i anAlphas = _mm_slli_epi32(_mm_setr_epi32(pAlphas[0], pAlphas[1], pAlphas[2], pAlphas[3]), 24);
+            aPixels = _mm_or_si128(_mm_and_si128(aPixels, _mm_set1_epi32(0x00FFFFFF)), anAlphas);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutputRow), aPixels);
+#else
+        for (uint32_t aColumn = 0; aColumn < 4; ++aColumn)
+        {
+            uint32_t aPixel = iPalette[(aRowIndices >> (2 * aColumn)) & 0x03];
+            if (iAlphaValues != nullptr)
+            {
+                aPixel = (aPixel & 0x00FFFFFF) | (static_cast<uint32_t>(iAlphaValues[4 * aRow + aColumn]) << 24);
+            }
+            memcpy(&pOutputRow[aColumn], &aPixel, sizeof(uint32_t));
+        }
+#endif
+    }
+}
+
+void decodeColorBlockRow(BlockFormat iBlockFormat, const uint8_t* iBlockTab, uint32_t iNbBlocks, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    const uint32_t aBlockSize = getBlockFormatBlockSize(iBlockFormat);
+    const uint32_t aColorOffset = (iBlockFormat == BF_BC1) ? 0 : 8;
+    const bool isFourColorsForced = (iBlockFormat != BF_BC1);
+
+    uint32_t aPalettes[2][4];
+    uint8_t anAlphaValues[16];
+
+    // Palettes are computed two blocks at a time
+    for (uint32_t aBlockIndex = 0; aBlockIndex < iNbBlocks; aBlockIndex += 2)
+    {
+        const uint8_t* pBlockA = iBlockTab + aBlockIndex * aBlockSize;
+        const uint8_t* pBlockB = (aBlockIndex + 1 < iNbBlocks) ? pBlockA + aBlockSize : pBlockA;
+
+        computeColorPalettes(pBlockA + aColorOffset, pBlockB + aColorOffset, isFourColorsForced, aPalettes[0], aPalettes[1]);
+
+        uint32_t aNbBlocksInPair = std::min<uint32_t>(2, iNbBlocks - aBlockIndex);
+        for (uint32_t aPairIndex = 0; aPairIndex < aNbBlocksInPair; ++aPairIndex)
+        {
+            const uint8_t* pBlock = iBlockTab + (aBlockIndex + aPairIndex) * aBlockSize;
+            const uint8_t* pAlphaValues = nullptr;
+
+            if (iBlockFormat == BF_BC2)
+            {
+                decodeExplicitAlphaComponent(pBlock, anAlphaValues);
+                pAlphaValues = anAlphaValues;
+            }
+            else if (iBlockFormat == BF_BC3)
+            {
+                decodeInterpolatedComponent(pBlock, anAlphaValues);
+                pAlphaValues = anAlphaValues;
+            }
+
+            writeColorBlock(aPalettes[aPairIndex], readDWord(pBlock + aColorOffset + 4), pAlphaValues,
+                            ioOutputTab + (aBlockIndex + aPairIndex) * 4 * sizeof(uint32_t), iOutputPitch);
+        }
+    }
+}
+
+void decodeChannelBlockRow(BlockFormat iBlockFormat, const uint8_t* iBlockTab, uint32_t iNbBlocks, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    const uint32_t aBlockSize = getBlockFormatBlockSize(iBlockFormat);
+    const uint32_t aPixelSize = getBlockFormatPixelSize(iBlockFormat);
+
+    uint8_t aFirstValues[16];
+    uint8_t aSecondValues[16];
+
+    for (uint32_t aBlockIndex = 0; aBlockIndex < iNbBlocks; ++aBlockIndex)
+    {
+        const uint8_t* pBlock = iBlockTab + aBlockIndex * aBlockSize;
+        uint8_t* pOutputBlock = ioOutputTab + aBlockIndex * 4 * aPixelSize;
+
+        decodeInterpolatedComponent(pBlock, aFirstValues);
+
+        if (iBlockFormat == BF_BC4)
+        {
+            for (uint32_t aRow = 0; aRow < 4; ++aRow)
+            {
+                memcpy(pOutputBlock + aRow * iOutputPitch, &aFirstValues[4 * aRow], 4);
+            }
+        }
+        else
+        {
+            decodeInterpolatedComponent(pBlock + 8, aSecondValues);
+
+#ifdef GW2DATTOOLS_TEXTURE_SSE2
+            __m128i anInterleaved0 = _mm_unpacklo_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(aFirstValues)),
+                                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSecondValues)));
+            __m128i anInterleaved1 = _mm_unpackhi_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(aFirstValues)),
+                                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSecondValues)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pOutputBlock), anInterleaved0);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pOutputBlock + iOutputPitch), _mm_srli_si128(anInterleaved0, 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pOutputBlock + 2 * iOutputPitch), anInterleaved1);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pOutputBlock + 3 * iOutputPitch), _mm_srli_si128(anInterleaved1, 8));
+#else
+            for (uint32_t aRow = 0; aRow < 4; ++aRow)
+            {
+                uint8_t* pOutputRow = pOutputBlock + aRow * iOutputPitch;
+                for (uint32_t aColumn = 0; aColumn < 4; ++aColumn)
+                {
+                    pOutputRow[2 * aColumn]     = aFirstValues[4 * aRow + aColumn];
+                    pOutputRow[2 * aColumn + 1] = aSecondValues[4 * aRow + aColumn];
+                }
+            }
+#endif
+        }
+    }
+}
+
+void decodeBlockRow(BlockFormat iBlockFormat, const uint8_t* iBlockTab, uint32_t iNbBlocks, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    if (iBlockFormat == BF_BC4 || iBlockFormat == BF_BC5)
+    {
+        decodeChannelBlockRow(iBlockFormat, iBlockTab, iNbBlocks, ioOutputTab, iOutputPitch);
+    }
+    else
+    {
+        decodeColorBlockRow(iBlockFormat, iBlockTab, iNbBlocks, ioOutputTab, iOutputPitch);
+    }
+}
+
+uint32_t getBlockFormatPixelSize(BlockFormat iBlockFormat)
+{
+    switch (iBlockFormat)
+    {
+    case BF_BC1:
+    case BF_BC2:
+    case BF_BC3:
+        return 4;
+
+    case BF_BC4:
+        return 1;
+
+    case BF_BC5:
+        return 2;
+
+    default:
+        throw exception::Exception("Pixel expansion is not available for this format.");
+    }
+}
+
+uint32_t getBlockFormatBlockSize(BlockFormat iBlockFormat)
+{
+    return (iBlockFormat == BF_BC1 || iBlockFormat == BF_BC4) ? 8 : 16;
+}
+
+void decodeBlockRows(BlockFormat iBlockFormat, uint16_t iWidth, uint16_t iHeight, uint32_t iFirstBlockRow, uint32_t iEndBlockRow,
+                     const uint8_t* iBlockTab, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    const uint32_t aPixelSize = getBlockFormatPixelSize(iBlockFormat);
+    const uint32_t aBlockSize = getBlockFormatBlockSize(iBlockFormat);
+
+    const uint32_t aNbBlocksPerRow = (iWidth + 3) / 4;
+
+    // Blocks crossing the right or bottom border are expanded here then cropped
+    uint8_t aBorderBlock[4 * 4 * 4];
+
+    for (uint32_t aBlockRow = iFirstBlockRow; aBlockRow < iEndBlockRow; ++aBlockRow)
+    {
+        const uint8_t* pBlockRow = iBlockTab + aBlockRow * aNbBlocksPerRow * aBlockSize;
+        uint8_t* pOutputRow = ioOutputTab + aBlockRow * 4 * iOutputPitch;
+
+        uint32_t aNbPixelRows = std::min<uint32_t>(4, iHeight - aBlockRow * 4);
+        uint32_t aNbFullBlocks = (aNbPixelRows == 4) ? iWidth / 4 : 0;
+
+        decodeBlockRow(iBlockFormat, pBlockRow, aNbFullBlocks, pOutputRow, iOutputPitch);
+
+        for (uint32_t aBlockIndex = aNbFullBlocks; aBlockIndex < aNbBlocksPerRow; ++aBlockIndex)
+        {
+            decodeBlockRow(iBlockFormat, pBlockRow + aBlockIndex * aBlockSize, 1, aBorderBlock, 4 * aPixelSize);
+
+            uint32_t aNbPixelColumns = std::min<uint32_t>(4, iWidth - aBlockIndex * 4);
+            for (uint32_t aRow = 0; aRow < aNbPixelRows; ++aRow)
+            {
+                memcpy(pOutputRow + aRow * iOutputPitch + aBlockIndex * 4 * aPixelSize, &aBorderBlock[aRow * 4 * aPixelSize], aNbPixelColumns * aPixelSize);
+            }
+        }
+    }
+}
+
+}
+}
+}
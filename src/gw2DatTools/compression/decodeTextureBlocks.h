@@ -0,0 +1,38 @@
+#ifndef GW2DATTOOLS_COMPRESSION_DECODETEXTUREBLOCKS_H
+#define GW2DATTOOLS_COMPRESSION_DECODETEXTUREBLOCKS_H
+
+#include <cstdint>
+
+namespace gw2dt
+{
+namespace compression
+{
+namespace texture
+{
+
+enum BlockFormat
+{
+    BF_NONE, // No pixel expansion available
+    BF_BC1,  // DXT1: 565 colors, 1 bit alpha
+    BF_BC2,  // DXT2/DXT3: explicit 4 bits alpha, 565 colors
+    BF_BC3,  // DXT4/DXT5: interpolated alpha, 565 colors
+    BF_BC4,  // DXTA: one interpolated channel
+    BF_BC5   // DXTN/3DCX: two interpolated channels
+};
+
+// Size in bytes of an expanded pixel: 4 (RGBA8), 1 (R8) or 2 (RG8)
+uint32_t getBlockFormatPixelSize(BlockFormat iBlockFormat);
+
+// Size in bytes of a 4x4 pixel block
+uint32_t getBlockFormatBlockSize(BlockFormat iBlockFormat);
+
+// Expands the rows [iFirstBlockRow, iEndBlockRow) of a tightly packed array of pixel blocks into a iWidth x iHeight image,
+// rows of the output being iOutputPitch bytes apart. iBlockTab and ioOutputTab point to the first row of the texture.
+void decodeBlockRows(BlockFormat iBlockFormat, uint16_t iWidth, uint16_t iHeight, uint32_t iFirstBlockRow, uint32_t iEndBlockRow,
+                     const uint8_t* iBlockTab, uint8_t* ioOutputTab, uint32_t iOutputPitch);
+
+}
+}
+}
+
+#endif // GW2DATTOOLS_COMPRESSION_DECODETEXTUREBLOCKS_H
@@ -27,12 +27,18 @@ struct HuffmanTree
     bool isEmpty;
 };
 
+class InputSource;
+
 struct State
 {
-    const uint32_t* input;
-    uint32_t inputSize;
+    const uint32_t* input;  // Words [inputBegin, inputEnd) of the input
+    uint32_t inputSize;     // Total number of words of the input
     uint32_t inputPos;
 
+    uint32_t inputBegin;
+    uint32_t inputEnd;
+    InputSource* source;    // Provides the next words when the input is not fully in memory, may be null
+
     uint32_t head;
     uint32_t buffer;
     uint8_t bits;
@@ -40,12 +46,38 @@ struct State
     bool isEmpty;
 };
 
+// Produces the input of a State piece by piece
+class InputSource
+{
+public:
+    virtual ~InputSource() {}
+
+    // Updates input/inputBegin/inputEnd so that the word at inputPos is available,
+    // the word before it shall stay available as well
+    virtual void fetch(State& ioState) = 0;
+};
+
 void buildHuffmanTree(HuffmanTree& ioHuffmanTree, int16_t* ioWorkingBitTab, int16_t* ioWorkingCodeTab);
 void fillWorkingTabsHelper(const uint8_t iBits, const int16_t iSymbol, int16_t* ioWorkingBitTab, int16_t* ioWorkingCodeTab);
 
 // Read the next code
 void readCode(const HuffmanTree& iHuffmanTree, State& ioState, uint16_t& ioCode);
 
+// Word at inputPos, inputPos being inferior to inputSize
+inline uint32_t readInputWord(State& ioState)
+{
+    if (ioState.inputPos < ioState.inputBegin || ioState.inputPos >= ioState.inputEnd)
+    {
+        if (ioState.source == nullptr)
+        {
+            throw exception::Exception("Tried to read a word out of the input.");
+        }
+        ioState.source->fetch(ioState);
+    }
+
+    return ioState.input[ioState.inputPos - ioState.inputBegin];
+}
+
 // Bits manipulation
 inline void pullByte(State& ioState)
 {
@@ -78,7 +110,7 @@ inline void pullByte(State& ioState)
     }
     else
     {
-        aValue = ioState.input[ioState.inputPos];
+        aValue = readInputWord(ioState);
     }
 
     // Pulling the data into head/buffer given that we need to keep the relevant bits
@@ -1,12 +1,15 @@
 #include "gw2DatTools/compression/inflateDatFileBuffer.h"
 
 #include <memory.h>
+#include <algorithm>
 #include <iostream>
 
 #include "gw2DatTools/exception/Exception.h"
 
+#include "DatFileInflater.h"
 #include "HuffmanTree.h"
 #include "../utils/BitArray.h"
+#include "../utils/Crc32c.h"
 
 namespace gw2dt
 {
@@ -19,6 +22,11 @@ const uint32_t sDatFileNbBitsHash        = 8;
 const uint32_t sDatFileMaxCodeBitsLength = 32;
 const uint32_t sDatFileMaxSymbolValue    = 285;
 
+// Input needed at most to read a part of the stream, a CRC included, when it is given piece by piece
+const uint32_t sDatFileMaxHeaderInputSize      = 16;
+const uint32_t sDatFileMaxBlockHeaderInputSize = 2048; // Two trees of sDatFileMaxSymbolValue codes of 16 bits at most
+const uint32_t sDatFileMaxCodeInputSize        = 16;   // Symbol, write size, write offset and their additional bits
+
 typedef utils::BitArray<uint32_t> DatFileBitArray;
 typedef HuffmanTree<uint16_t, sDatFileNbBitsHash, sDatFileMaxCodeBitsLength, sDatFileMaxSymbolValue> DatFileHuffmanTree;
 typedef HuffmanTreeBuilder<uint16_t, sDatFileMaxCodeBitsLength, sDatFileMaxSymbolValue> DatFileHuffmanTreeBuilder;
@@ -70,48 +78,178 @@ bool parseHuffmanTree(DatFileBitArray& ioInputBitArray, DatFileHuffmanTree& ioHu
     return ioHuffmanTreeBuilder.buildHuffmanTree(ioHuffmanTree);
 }
 
-void inflatedata(DatFileBitArray& ioInputBitArray, uint32_t iOutputSize,  uint8_t* ioOutputTab)
+struct DatFileInflater::State
+{
+    State(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsInputComplete);
+
+    DatFileBitArray inputBitArray;
+    bool isInputComplete;
+    bool isHeaderRead;
+    uint32_t outputSize;
+    uint16_t writeSizeConstAdd;
+
+    DatFileHuffmanTree huffmanTreeSymbol;
+    DatFileHuffmanTree huffmanTreeCopy;
+    DatFileHuffmanTreeBuilder huffmanTreeBuilder;
+
+    uint32_t maxCount;
+    uint32_t currentCodeReadCount;
+
+    // Copy interrupted by the end of the previous call
+    uint32_t pendingWriteSize;
+    uint32_t pendingWriteOffset;
+
+    bool isFinished;
+};
+
+DatFileInflater::State::State(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsInputComplete) :
+    inputBitArray(iInputTab, iInputSize, sDatFileBlockSize / sizeof(uint32_t)), // Skipping the CRC of every block
+    isInputComplete(iIsInputComplete),
+    isHeaderRead(false),
+    outputSize(0),
+    writeSizeConstAdd(0),
+    maxCount(0),
+    currentCodeReadCount(0),
+    pendingWriteSize(0),
+    pendingWriteOffset(0),
+    isFinished(false)
 {
-    uint32_t anOutputPos = 0;
+}
+
+// Reads the HuffmanTrees and the number of codes of the next block
+bool readBlockHeader(DatFileBitArray& ioInputBitArray, DatFileHuffmanTree& ioHuffmanTreeSymbol, DatFileHuffmanTree& ioHuffmanTreeCopy,
+                     DatFileHuffmanTreeBuilder& ioHuffmanTreeBuilder, uint32_t& oMaxCount)
+{
+    // Reading HuffmanTrees
+    if (   !parseHuffmanTree(ioInputBitArray, ioHuffmanTreeSymbol, ioHuffmanTreeBuilder)
+            || !parseHuffmanTree(ioInputBitArray, ioHuffmanTreeCopy, ioHuffmanTreeBuilder))
+    {
+        return false;
+    }
+
+    // Reading MaxCount
+    ioInputBitArray.read<4>(oMaxCount);
+    oMaxCount = (oMaxCount + 1) << 12;
+    ioInputBitArray.drop<4>();
+
+    return true;
+}
+
+// Reads the header of the compressed buffer
+void readHeader(DatFileBitArray& ioInputBitArray, uint32_t& oOutputSize, uint16_t& oWriteSizeConstAdd)
+{
+    // Skipping header
+    ioInputBitArray.drop<uint32_t>();
+
+    // Getting size of the uncompressed data
+    ioInputBitArray.read(oOutputSize);
+    ioInputBitArray.drop<uint32_t>();
 
     // Reading the const write size addition value
     ioInputBitArray.drop<4>();
-    uint16_t aWriteSizeConstAdd;
-    ioInputBitArray.read<4>(aWriteSizeConstAdd);
-    aWriteSizeConstAdd += 1;
+    ioInputBitArray.read<4>(oWriteSizeConstAdd);
+    oWriteSizeConstAdd += 1;
     ioInputBitArray.drop<4>();
+}
 
-    // Declaring our HuffmanTrees
-    DatFileHuffmanTree aHuffmanTreeSymbol;
-    DatFileHuffmanTree aHuffmanTreeCopy;
+DatFileInflater::DatFileInflater(uint32_t iInputSize, const uint8_t* iInputTab) :
+    _pState(new State(iInputSize, iInputTab, true))
+{
+    readHeader(_pState->inputBitArray, _pState->outputSize, _pState->writeSizeConstAdd);
+    _pState->isHeaderRead = true;
+}
+
+DatFileInflater::DatFileInflater() :
+    _pState(new State(0, nullptr, false))
+{
+}
+
+DatFileInflater::~DatFileInflater()
+{
+}
+
+uint32_t DatFileInflater::getOutputSize() const
+{
+    return _pState->outputSize;
+}
+
+uint32_t DatFileInflater::getInputSize() const
+{
+    return _pState->inputBitArray.getBytesAvail();
+}
+
+void DatFileInflater::setInput(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsLast)
+{
+    State& aState = *_pState;
+
+    aState.inputBitArray.setBuffer(iInputTab, iInputSize);
+    aState.isInputComplete = iIsLast;
+
+    if (!aState.isHeaderRead && (iIsLast || iInputSize >= sDatFileMaxHeaderInputSize))
+    {
+        readHeader(aState.inputBitArray, aState.outputSize, aState.writeSizeConstAdd);
+        aState.isHeaderRead = true;
+    }
+}
+
+bool DatFileInflater::inflate(uint8_t* ioOutputTab, uint32_t& ioOutputPos, uint32_t iOutputEnd)
+{
+    State& aState = *_pState;
+    DatFileBitArray& anInputBitArray = aState.inputBitArray;
 
-    DatFileHuffmanTreeBuilder aHuffmanTreeBuilder;
+    uint32_t anOutputPos = ioOutputPos;
 
-    while (anOutputPos < iOutputSize)
+    // Finishing the copy interrupted by the previous call
+    while ((aState.pendingWriteSize > 0) &&
+            (anOutputPos < iOutputEnd))
     {
-        // Reading HuffmanTrees
-        if (   !parseHuffmanTree(ioInputBitArray, aHuffmanTreeSymbol, aHuffmanTreeBuilder)
-                || !parseHuffmanTree(ioInputBitArray, aHuffmanTreeCopy, aHuffmanTreeBuilder))
+        ioOutputTab[anOutputPos] = ioOutputTab[anOutputPos - aState.pendingWriteOffset];
+        ++anOutputPos;
+        --aState.pendingWriteSize;
+    }
+
+    if (!aState.isHeaderRead)
+    {
+        return true;
+    }
+
+    while (anOutputPos < iOutputEnd && !aState.isFinished)
+    {
+        if (aState.currentCodeReadCount >= aState.maxCount)
         {
-            break;
-        }
+            if (!aState.isInputComplete && anInputBitArray.getBytesAvail() < sDatFileMaxBlockHeaderInputSize)
+            {
+                break;
+            }
 
-        // Reading MaxCount
-        uint32_t aMaxCount;
-        ioInputBitArray.read<4>(aMaxCount);
-        aMaxCount = (aMaxCount + 1) << 12;
-        ioInputBitArray.drop<4>();
+            if (!readBlockHeader(anInputBitArray, aState.huffmanTreeSymbol, aState.huffmanTreeCopy, aState.huffmanTreeBuilder, aState.maxCount))
+            {
+                aState.isFinished = true;
+                break;
+            }
+            aState.currentCodeReadCount = 0;
+        }
 
-        uint32_t aCurrentCodeReadCount = 0;
+        uint32_t aCodeReadEnd = aState.maxCount;
+        if (!aState.isInputComplete)
+        {
+            // Only the codes which are surely in the input
+            uint32_t aNbOfAvailableCodes = anInputBitArray.getBytesAvail() / sDatFileMaxCodeInputSize;
+            if (aNbOfAvailableCodes == 0)
+            {
+                break;
+            }
+            aCodeReadEnd = std::min(aCodeReadEnd, aState.currentCodeReadCount + aNbOfAvailableCodes);
+        }
 
-        while ((aCurrentCodeReadCount < aMaxCount) &&
-                (anOutputPos < iOutputSize))
+        while ((aState.currentCodeReadCount < aCodeReadEnd) &&
+                (anOutputPos < iOutputEnd))
         {
-            ++aCurrentCodeReadCount;
+            ++aState.currentCodeReadCount;
 
             // Reading next code
             uint16_t aSymbol = 0;
-            aHuffmanTreeSymbol.readCode(ioInputBitArray, aSymbol);
+            aState.huffmanTreeSymbol.readCode(anInputBitArray, aSymbol);
 
             if (aSymbol < 0x100)
             {
@@ -150,15 +288,15 @@ void inflatedata(DatFileBitArray& ioInputBitArray, uint32_t iOutputSize,  uint8_
             {
                 uint8_t aWriteSizeAddBits = aCodeDiv4.quot - 1;
                 uint32_t aWriteSizeAdd;
-                ioInputBitArray.read(aWriteSizeAddBits, aWriteSizeAdd);
+                anInputBitArray.read(aWriteSizeAddBits, aWriteSizeAdd);
                 aWriteSize |= aWriteSizeAdd;
-                ioInputBitArray.drop(aWriteSizeAddBits);
+                anInputBitArray.drop(aWriteSizeAddBits);
             }
-            aWriteSize += aWriteSizeConstAdd;
+            aWriteSize += aState.writeSizeConstAdd;
 
             // write offset
             // Reading the write offset
-            aHuffmanTreeCopy.readCode(ioInputBitArray, aSymbol);
+            aState.huffmanTreeCopy.readCode(anInputBitArray, aSymbol);
 
             div_t aCodeDiv2 = div(aSymbol, 2);
 
@@ -181,32 +319,89 @@ void inflatedata(DatFileBitArray& ioInputBitArray, uint32_t iOutputSize,  uint8_
             {
                 uint8_t aWriteOffsetAddBits = aCodeDiv2.quot - 1;
                 uint32_t aWriteOffsetAdd;
-                ioInputBitArray.read(aWriteOffsetAddBits, aWriteOffsetAdd);
+                anInputBitArray.read(aWriteOffsetAddBits, aWriteOffsetAdd);
                 aWriteOffset |= aWriteOffsetAdd;
-                ioInputBitArray.drop(aWriteOffsetAddBits);
+                anInputBitArray.drop(aWriteOffsetAddBits);
             }
             aWriteOffset += 1;
 
+            if (aWriteOffset > anOutputPos)
+            {
+                throw exception::Exception("Invalid value for writeOffset.");
+            }
+
             uint32_t anAlreadyWritten = 0;
             while ((anAlreadyWritten < aWriteSize) &&
-                    (anOutputPos < iOutputSize))
+                    (anOutputPos < iOutputEnd))
             {
                 ioOutputTab[anOutputPos] = ioOutputTab[anOutputPos - aWriteOffset];
                 ++anOutputPos;
                 ++anAlreadyWritten;
             }
+
+            aState.pendingWriteSize = aWriteSize - anAlreadyWritten;
+            aState.pendingWriteOffset = aWriteOffset;
         }
     }
+
+    ioOutputPos = anOutputPos;
+
+    return !aState.isFinished;
+}
+
+}
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getNbOfDatFileBlocks(uint32_t iInputSize)
+{
+    uint32_t aNbOfBlocks = iInputSize / sDatFileBlockSize;
+    if (iInputSize % sDatFileBlockSize >= sizeof(uint32_t))
+    {
+        ++aNbOfBlocks;
+    }
+    return aNbOfBlocks;
 }
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY checkDatFileBlock(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iBlockIndex,
+                                                           uint32_t& oExpectedCrc, uint32_t& oComputedCrc)
+{
+    if (iBlockIndex >= getNbOfDatFileBlocks(iInputSize))
+    {
+        throw exception::Exception("Block is out of the buffer.");
+    }
+
+    uint32_t aBlockPos = iBlockIndex * sDatFileBlockSize;
+    uint32_t aBlockSize = std::min(sDatFileBlockSize, iInputSize - aBlockPos);
+    uint32_t aDataSize = aBlockSize - sizeof(uint32_t);
+
+    memcpy(&oExpectedCrc, iInputTab + aBlockPos + aDataSize, sizeof(oExpectedCrc));
+    oComputedCrc = utils::computeCrc32c(iInputTab + aBlockPos, aDataSize);
+
+    return oExpectedCrc == oComputedCrc;
 }
 
-GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab,
+                                                                    bool iIsVerified)
 {
     if (iInputTab == nullptr)
     {
         throw exception::Exception("Input buffer is null.");
     }
 
+    if (iIsVerified)
+    {
+        // Checked before decoding, the input is then already in the cache
+        uint32_t aNbOfBlocks = getNbOfDatFileBlocks(iInputSize);
+        for (uint32_t aBlockIndex = 0; aBlockIndex < aNbOfBlocks; ++aBlockIndex)
+        {
+            uint32_t anExpectedCrc;
+            uint32_t aComputedCrc;
+            if (!checkDatFileBlock(iInputSize, iInputTab, aBlockIndex, anExpectedCrc, aComputedCrc))
+            {
+                throw exception::Exception("CRC of a block does not match.");
+            }
+        }
+    }
+
     if (ioOutputTab != nullptr && ioOutputSize == 0)
     {
         throw exception::Exception("Output buffer is not null and outputSize is not defined.");
@@ -217,15 +412,10 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInp
 
     try
     {
-        dat::DatFileBitArray anInputBitArray(iInputTab, iInputSize, 16384); // Skipping four bytes every 65k chunk
-
-        // Skipping header & Getting size of the uncompressed data
-        anInputBitArray.drop<uint32_t>();
+        dat::DatFileInflater anInflater(iInputSize, iInputTab);
 
         // Getting size of the uncompressed data
-        uint32_t anOutputSize;
-        anInputBitArray.read(anOutputSize);
-        anInputBitArray.drop<uint32_t>();
+        uint32_t anOutputSize = anInflater.getOutputSize();
 
         if (ioOutputSize != 0)
         {
@@ -244,7 +434,8 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateDatFileBuffer(uint32_t iInp
             anOutputTab = ioOutputTab;
         }
 
-        dat::inflatedata(anInputBitArray, anOutputSize, anOutputTab);
+        uint32_t anOutputPos = 0;
+        anInflater.inflate(anOutputTab, anOutputPos, anOutputSize);
 
         return anOutputTab;
     }
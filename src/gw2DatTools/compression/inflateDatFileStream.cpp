@@ -0,0 +1,142 @@
+#include "gw2DatTools/compression/inflateDatFileStream.h"
+
+#include <memory.h>
+#include <algorithm>
+#include <vector>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "DatFileInflater.h"
+
+namespace gw2dt
+{
+namespace compression
+{
+
+class DatFileStreamInflaterImpl : public DatFileStreamInflater
+{
+public:
+    DatFileStreamInflaterImpl(uint32_t iSliceSize);
+    virtual ~DatFileStreamInflaterImpl();
+
+    virtual void reset();
+
+    virtual void pushInput(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsLast);
+    virtual uint32_t pullOutput(const uint8_t*& oSliceTab);
+
+    virtual bool isFinished() const;
+    virtual uint32_t getOutputSize() const;
+
+private:
+    uint32_t _sliceSize;
+    std::unique_ptr<dat::DatFileInflater> _pInflater;
+
+    // Ends with the input not read yet by the inflater
+    std::vector<uint8_t> _inputBuffer;
+    bool _isInputComplete;
+
+    // History reachable by the copies, followed by the slice being inflated
+    std::vector<uint8_t> _window;
+    uint32_t _windowSize;   // Bytes inflated in the window
+    uint32_t _outputPos;    // Bytes inflated since the start of the output
+    bool _isFinished;
+};
+
+DatFileStreamInflaterImpl::DatFileStreamInflaterImpl(uint32_t iSliceSize) :
+    _sliceSize(iSliceSize),
+    _window(dat::sDatFileMaxWriteOffset + iSliceSize)
+{
+    if (iSliceSize == 0)
+    {
+        throw exception::Exception("Slice size is null.");
+    }
+
+    reset();
+}
+
+DatFileStreamInflaterImpl::~DatFileStreamInflaterImpl()
+{
+}
+
+void DatFileStreamInflaterImpl::reset()
+{
+    _pInflater.reset(new dat::DatFileInflater());
+    _inputBuffer.clear();
+    _isInputComplete = false;
+    _windowSize = 0;
+    _outputPos = 0;
+    _isFinished = false;
+}
+
+void DatFileStreamInflaterImpl::pushInput(uint32_t iInputSize, const uint8_t* iInputTab, bool iIsLast)
+{
+    if (_isInputComplete)
+    {
+        throw exception::Exception("Last input was already pushed.");
+    }
+
+    // Keeping only the bytes the inflater did not read
+    _inputBuffer.erase(_inputBuffer.begin(), _inputBuffer.end() - _pInflater->getInputSize());
+    _inputBuffer.insert(_inputBuffer.end(), iInputTab, iInputTab + iInputSize);
+
+    _isInputComplete = iIsLast;
+    _pInflater->setInput(static_cast<uint32_t>(_inputBuffer.size()), _inputBuffer.data(), iIsLast);
+}
+
+uint32_t DatFileStreamInflaterImpl::pullOutput(const uint8_t*& oSliceTab)
+{
+    oSliceTab = nullptr;
+
+    uint32_t anOutputSize = _pInflater->getOutputSize();
+    if (_isFinished || (anOutputSize == 0 && !_isInputComplete))
+    {
+        return 0;
+    }
+
+    // Window is full, keeping only the history needed by the copies
+    if (_windowSize == _window.size())
+    {
+        memmove(_window.data(), _window.data() + _windowSize - dat::sDatFileMaxWriteOffset, dat::sDatFileMaxWriteOffset);
+        _windowSize = dat::sDatFileMaxWriteOffset;
+    }
+
+    uint32_t aSliceBegin = _windowSize;
+    uint32_t aSliceEnd = std::min(static_cast<uint32_t>(_window.size()), aSliceBegin + std::min(_sliceSize, anOutputSize - _outputPos));
+    uint32_t anOutputPos = aSliceBegin;
+
+    bool isExhausted = !_pInflater->inflate(_window.data(), anOutputPos, aSliceEnd);
+
+    uint32_t aSliceSize = anOutputPos - aSliceBegin;
+    _windowSize = anOutputPos;
+    _outputPos += aSliceSize;
+
+    if (isExhausted || _outputPos == anOutputSize)
+    {
+        _isFinished = true;
+    }
+    else if (aSliceSize == 0 && _isInputComplete)
+    {
+        throw exception::Exception("Compressed buffer ended before its output.");
+    }
+
+    oSliceTab = _window.data() + aSliceBegin;
+    return aSliceSize;
+}
+
+bool DatFileStreamInflaterImpl::isFinished() const
+{
+    return _isFinished;
+}
+
+uint32_t DatFileStreamInflaterImpl::getOutputSize() const
+{
+    return _pInflater->getOutputSize();
+}
+
+GW2DATTOOLS_API std::unique_ptr<DatFileStreamInflater> GW2DATTOOLS_APIENTRY createDatFileStreamInflater(uint32_t iSliceSize)
+{
+    return std::unique_ptr<DatFileStreamInflater>(new DatFileStreamInflaterImpl(iSliceSize));
+}
+
+}
+}
@@ -5,8 +5,13 @@
 #include "gw2DatTools/exception/Exception.h"
 
 #include "huffmanTreeUtils.h"
+#include "decodeTextureBlocks.h"
+#include "DatFileInflater.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 namespace gw2dt
@@ -20,6 +25,7 @@ struct Format
 {
     uint16_t flags;
     uint16_t pixelSizeInBits;
+    BlockFormat blockFormat;
 };
 
 struct FullFormat
@@ -34,6 +40,90 @@ struct FullFormat
     uint16_t height;
 };
 
+// Constant values written by the first passes of inflateData. In pixel mode they are recorded per pixel block
+// rather than written, and applied when the row of the block is assembled.
+enum BlockFillFlags
+{
+    BFF_WHITE = 0x01,
+    BFF_ALPHA_FROM4BITS = 0x02,
+    BFF_ALPHA_FROM8BITS = 0x04,
+    BFF_NULL_ALPHA = 0x08,      // Along with one of the two above
+    BFF_PLAIN_COLOR = 0x10
+};
+
+struct BlockFills
+{
+    std::vector<uint8_t> flagTab;  // BlockFillFlags per pixel block
+    uint64_t alphaFrom4BitsValue;
+    uint64_t alphaFrom8BitsValue;
+    uint64_t plainColorValue;
+};
+
+// Working buffers of the decoder, the batch decoder reuses them from one texture to the next
+struct Scratch
+{
+    std::vector<bool> colorBitmap;
+    std::vector<bool> alphaBitmap;
+
+    // Pixel mode only
+    BlockFills blockFills;
+    std::vector<uint8_t> blockRowTab; // Row of pixel blocks being assembled
+};
+
+// Destination of the pixel blocks
+struct Surface
+{
+    uint8_t* data;             // First pixel block of the texture
+    uint32_t rowPitch;         // Bytes between two rows of pixel blocks
+    uint32_t nbOfBlocksPerRow;
+};
+
+inline uint8_t* getPixelBlock(const Surface& iSurface, const FullFormat& iFullFormat, uint32_t iPixelBlockPos)
+{
+    return iSurface.data + (iPixelBlockPos / iSurface.nbOfBlocksPerRow) * iSurface.rowPitch
+                         + (iPixelBlockPos % iSurface.nbOfBlocksPerRow) * iFullFormat.bytesPerPixelBlock;
+}
+
+// Walks the pixel blocks of a surface in order, without any division
+class PixelBlockCursor
+{
+public:
+    PixelBlockCursor(const Surface& iSurface, const FullFormat& iFullFormat, uint32_t iOffsetInBlock) :
+        _pRow(iSurface.data + iOffsetInBlock),
+        _column(0),
+        _rowPitch(iSurface.rowPitch),
+        _nbOfBlocksPerRow(iSurface.nbOfBlocksPerRow),
+        _bytesPerPixelBlock(iFullFormat.bytesPerPixelBlock)
+    {
+    }
+
+    uint8_t* get() const
+    {
+        return _pRow + _column * _bytesPerPixelBlock;
+    }
+
+    // Returns true when the cursor leaves a row for the next one
+    bool next()
+    {
+        ++_column;
+        if (_column == _nbOfBlocksPerRow)
+        {
+            _column = 0;
+            _pRow += _rowPitch;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    uint8_t* _pRow;
+    uint32_t _column;
+
+    uint32_t _rowPitch;
+    uint32_t _nbOfBlocksPerRow;
+    uint32_t _bytesPerPixelBlock;
+};
+
 enum FormatFlags
 {
     FF_COLOR = 0x10,
@@ -54,7 +144,6 @@ enum CompressionFlags
 // Static Values
 HuffmanTree sHuffmanTreeDict;
 Format sFormats[9];
-bool sStaticValuesInitialized(false);
 
 void initializeStaticValues()
 {
@@ -63,30 +152,39 @@ void initializeStaticValues()
         Format& aDxt1Format = sFormats[0];
         aDxt1Format.flags = FF_COLOR | FF_ALPHA | FF_DEDUCEDALPHACOMP;
         aDxt1Format.pixelSizeInBits = 4;
+        aDxt1Format.blockFormat = BF_BC1;
 
         Format& aDxt2Format = sFormats[1];
         aDxt2Format.flags = FF_COLOR | FF_ALPHA | FF_PLAINCOMP;
         aDxt2Format.pixelSizeInBits = 8;
+        aDxt2Format.blockFormat = BF_BC2;
 
         sFormats[2] = sFormats[1];
         sFormats[3] = sFormats[1];
         sFormats[4] = sFormats[1];
 
+        sFormats[3].blockFormat = BF_BC3;
+        sFormats[4].blockFormat = BF_BC3;
+
         Format& aDxtAFormat = sFormats[5];
         aDxtAFormat.flags = FF_ALPHA | FF_PLAINCOMP;
         aDxtAFormat.pixelSizeInBits = 4;
+        aDxtAFormat.blockFormat = BF_BC4;
 
         Format& aDxtLFormat = sFormats[6];
         aDxtLFormat.flags = FF_COLOR;
         aDxtLFormat.pixelSizeInBits = 8;
+        aDxtLFormat.blockFormat = BF_NONE;
 
         Format& aDxtNFormat = sFormats[7];
         aDxtNFormat.flags = FF_BICOLORCOMP;
         aDxtNFormat.pixelSizeInBits = 8;
+        aDxtNFormat.blockFormat = BF_BC5;
 
         Format& a3dcxFormat = sFormats[8];
         a3dcxFormat.flags = FF_BICOLORCOMP;
         a3dcxFormat.pixelSizeInBits = 8;
+        a3dcxFormat.blockFormat = BF_BC5;
     }
 
     int16_t aWorkingBitTab[MaxCodeBitsLength];
@@ -120,6 +218,19 @@ void initializeStaticValues()
     return buildHuffmanTree(sHuffmanTreeDict, &aWorkingBitTab[0], &aWorkingCodeTab[0]);
 }
 
+class TextureStaticValuesInitializer
+{
+public:
+    TextureStaticValuesInitializer();
+};
+
+TextureStaticValuesInitializer::TextureStaticValuesInitializer()
+{
+    initializeStaticValues();
+}
+
+static TextureStaticValuesInitializer sTextureStaticValuesInitializer;
+
 Format deduceFormat(uint32_t iFourCC)
 {
     switch(iFourCC)
@@ -156,7 +267,113 @@ Format deduceFormat(uint32_t iFourCC)
     }
 }
 
-void decodeWhiteColor(State& ioState, std::vector<bool>& ioAlphaBitMap, std::vector<bool>& ioColorBitMap, const FullFormat& iFullFormat, uint8_t* ioOutputTab)
+void initializeFullFormat(uint32_t iFormatFourCc, uint16_t iWidth, uint16_t iHeight, FullFormat& oFullFormat)
+{
+    oFullFormat.format = deduceFormat(iFormatFourCc);
+    oFullFormat.width  = iWidth;
+    oFullFormat.height = iHeight;
+
+    oFullFormat.nbObPixelBlocks = ((oFullFormat.width + 3) / 4) * ((oFullFormat.height + 3) / 4);
+    oFullFormat.bytesPerPixelBlock = (oFullFormat.format.pixelSizeInBits * 4 * 4) / 8;
+    oFullFormat.hasTwoComponents =
+        ((oFullFormat.format.flags & (FF_PLAINCOMP | FF_COLOR | FF_ALPHA)) == (FF_PLAINCOMP | FF_COLOR | FF_ALPHA))
+        || (oFullFormat.format.flags & FF_BICOLORCOMP);
+
+    oFullFormat.bytesPerComponent = oFullFormat.bytesPerPixelBlock / (oFullFormat.hasTwoComponents ? 2 : 1);
+}
+
+void initializeState(uint32_t iInputSize, const uint8_t* iInputTab, State& oState)
+{
+    oState.input = reinterpret_cast<const uint32_t*>(iInputTab);
+    oState.inputSize = iInputSize / 4;
+    oState.inputPos = 0;
+
+    oState.inputBegin = 0;
+    oState.inputEnd = oState.inputSize;
+    oState.source = nullptr;
+
+    oState.head = 0;
+    oState.bits = 0;
+    oState.buffer = 0;
+
+    oState.isEmpty = false;
+}
+
+// Reads the ATEX header: magic, format, width and height
+void readHeader(State& ioState, uint32_t& oFormatFourCc, uint16_t& oWidth, uint16_t& oHeight)
+{
+    // Skipping header
+    needBits(ioState, 32);
+    dropBits(ioState, 32);
+
+    // Format
+    needBits(ioState, 32);
+    oFormatFourCc = readBits(ioState, 32);
+    dropBits(ioState, 32);
+
+    // Getting width/height
+    needBits(ioState, 32);
+    oWidth = readBits(ioState, 16);
+    dropBits(ioState, 16);
+    oHeight = readBits(ioState, 16);
+    dropBits(ioState, 16);
+}
+
+// Locates the mip levels following the ATEX header
+void parseMipLevels(uint32_t iInputSize, const uint8_t* iInputTab, uint16_t iWidth, uint16_t iHeight, std::vector<TextureMipLevel>& oMipLevels)
+{
+    const uint32_t aHeaderSize = 12;
+
+    oMipLevels.clear();
+
+    uint32_t anOffset = aHeaderSize;
+    uint16_t aWidth = iWidth;
+    uint16_t aHeight = iHeight;
+
+    while (anOffset + 8 <= iInputSize)
+    {
+        uint32_t aDataSize;
+        memcpy(&aDataSize, iInputTab + anOffset, sizeof(uint32_t));
+
+        TextureMipLevel aMipLevel;
+        aMipLevel.width = aWidth;
+        aMipLevel.height = aHeight;
+        aMipLevel.offset = anOffset;
+
+        if (aDataSize == 0 || aDataSize > iInputSize - anOffset - 4)
+        {
+            if (!oMipLevels.empty())
+            {
+                break;
+            }
+            // Inconsistent size for the top level: it spans the whole buffer, as before mip levels were parsed
+            aMipLevel.size = iInputSize - anOffset;
+        }
+        else
+        {
+            aMipLevel.size = 4 + aDataSize;
+        }
+
+        oMipLevels.push_back(aMipLevel);
+
+        if (aWidth == 1 && aHeight == 1)
+        {
+            break;
+        }
+
+        anOffset += (aMipLevel.size + 3) & ~3;
+        aWidth = std::max(aWidth >> 1, 1);
+        aHeight = std::max(aHeight >> 1, 1);
+    }
+
+    if (oMipLevels.empty())
+    {
+        throw exception::Exception("No mip level found.");
+    }
+}
+
+void decodeWhiteColor(State& ioState, std::vector<bool>& ioAlphaBitMap, std::vector<bool>& ioColorBitMap, const FullFormat& iFullFormat, const Surface& iSurface,
+                      BlockFills* ipBlockFills)
 {
     uint32_t aPixelBlockPos = 0;
 
@@ -176,7 +393,14 @@ void decodeWhiteColor(State& ioState, std::vector<bool>& ioAlphaBitMap, std::vec
             {
                 if (aValue)
                 {
-                    *reinterpret_cast<int64_t*>(&(ioOutputTab[iFullFormat.bytesPerPixelBlock * (aPixelBlockPos)])) = 0xFFFFFFFFFFFFFFFE;
+                    if (ipBlockFills != nullptr)
+                    {
+                        ipBlockFills->flagTab[aPixelBlockPos] |= BFF_WHITE;
+                    }
+                    else
+                    {
+                        *reinterpret_cast<int64_t*>(getPixelBlock(iSurface, iFullFormat, aPixelBlockPos)) = 0xFFFFFFFFFFFFFFFE;
+                    }
 
                     ioAlphaBitMap[aPixelBlockPos] = true;
                     ioColorBitMap[aPixelBlockPos] = true;
@@ -193,7 +417,8 @@ void decodeWhiteColor(State& ioState, std::vector<bool>& ioAlphaBitMap, std::vec
     }
 }
 
-void decodeConstantAlphaFrom4Bits(State& ioState, std::vector<bool>& ioAlphaBitMap, const FullFormat& iFullFormat, uint8_t* ioOutputTab)
+void decodeConstantAlphaFrom4Bits(State& ioState, std::vector<bool>& ioAlphaBitMap, const FullFormat& iFullFormat, const Surface& iSurface,
+                                  BlockFills* ipBlockFills)
 {
     needBits(ioState, 4);
     uint8_t aAlphaValueByte = readBits(ioState, 4);
@@ -207,6 +432,11 @@ void decodeConstantAlphaFrom4Bits(State& ioState, std::vector<bool>& ioAlphaBitM
     uint64_t aAlphaValue = aIntermediateDWord | (aIntermediateDWord << 32);
     uint64_t zero = 0;
 
+    if (ipBlockFills != nullptr)
+    {
+        ipBlockFills->alphaFrom4BitsValue = aAlphaValue;
+    }
+
     while (aPixelBlockPos < iFullFormat.nbObPixelBlocks)
     {
         // Reading next code
@@ -228,7 +458,14 @@ void decodeConstantAlphaFrom4Bits(State& ioState, std::vector<bool>& ioAlphaBitM
             {
                 if (aValue)
                 {
-                    memcpy(&(ioOutputTab[iFullFormat.bytesPerPixelBlock * (aPixelBlockPos)]), isNotNull ? &aAlphaValue : &zero, iFullFormat.bytesPerComponent);
+                    if (ipBlockFills != nullptr)
+                    {
+                        ipBlockFills->flagTab[aPixelBlockPos] |= BFF_ALPHA_FROM4BITS | (isNotNull ? 0 : BFF_NULL_ALPHA);
+                    }
+                    else
+                    {
+                        memcpy(getPixelBlock(iSurface, iFullFormat, aPixelBlockPos), isNotNull ? &aAlphaValue : &zero, iFullFormat.bytesPerComponent);
+                    }
                     ioAlphaBitMap[aPixelBlockPos] = true;
                 }
                 --aCode;
@@ -243,7 +480,8 @@ void decodeConstantAlphaFrom4Bits(State& ioState, std::vector<bool>& ioAlphaBitM
     }
 }
 
-void decodeConstantAlphaFrom8Bits(State& ioState, std::vector<bool>& ioAlphaBitMap, const FullFormat& iFullFormat, uint8_t* ioOutputTab)
+void decodeConstantAlphaFrom8Bits(State& ioState, std::vector<bool>& ioAlphaBitMap, const FullFormat& iFullFormat, const Surface& iSurface,
+                                  BlockFills* ipBlockFills)
 {
     needBits(ioState, 8);
     uint8_t aAlphaValueByte = readBits(ioState, 8);
@@ -254,6 +492,11 @@ void decodeConstantAlphaFrom8Bits(State& ioState, std::vector<bool>& ioAlphaBitM
     uint64_t aAlphaValue = aAlphaValueByte | (aAlphaValueByte << 8);
     uint64_t zero = 0;
 
+    if (ipBlockFills != nullptr)
+    {
+        ipBlockFills->alphaFrom8BitsValue = aAlphaValue;
+    }
+
     while (aPixelBlockPos < iFullFormat.nbObPixelBlocks)
     {
         // Reading next code
@@ -275,7 +518,14 @@ void decodeConstantAlphaFrom8Bits(State& ioState, std::vector<bool>& ioAlphaBitM
             {
                 if (aValue)
                 {
-                    memcpy(&(ioOutputTab[iFullFormat.bytesPerPixelBlock * (aPixelBlockPos)]), isNotNull ? &aAlphaValue : &zero, iFullFormat.bytesPerComponent);
+                    if (ipBlockFills != nullptr)
+                    {
+                        ipBlockFills->flagTab[aPixelBlockPos] |= BFF_ALPHA_FROM8BITS | (isNotNull ? 0 : BFF_NULL_ALPHA);
+                    }
+                    else
+                    {
+                        memcpy(getPixelBlock(iSurface, iFullFormat, aPixelBlockPos), isNotNull ? &aAlphaValue : &zero, iFullFormat.bytesPerComponent);
+                    }
                     ioAlphaBitMap[aPixelBlockPos] = true;
                 }
                 --aCode;
@@ -290,7 +540,7 @@ void decodeConstantAlphaFrom8Bits(State& ioState, std::vector<bool>& ioAlphaBitM
     }
 }
 
-void decodePlainColor(State& ioState, std::vector<bool>& ioColorBitMap, const FullFormat& iFullFormat, uint8_t* ioOutputTab)
+void decodePlainColor(State& ioState, std::vector<bool>& ioColorBitMap, const FullFormat& iFullFormat, const Surface& iSurface, BlockFills* ipBlockFills)
 {
     needBits(ioState, 24);
     uint16_t aBlue = readBits(ioState, 8);
@@ -507,6 +757,11 @@ void decodePlainColor(State& ioState, std::vector<bool>& ioColorBitMap, const Fu
     aTempValue = aTempValue | (aTempValue << 16);
     uint64_t aFinalValue = aValueColor1 | (aValueColor2 << 16) | (aTempValue << 32);
 
+    if (ipBlockFills != nullptr)
+    {
+        ipBlockFills->plainColorValue = aFinalValue;
+    }
+
     uint32_t aPixelBlockPos = 0;
 
     while (aPixelBlockPos < iFullFormat.nbObPixelBlocks)
@@ -525,8 +780,15 @@ void decodePlainColor(State& ioState, std::vector<bool>& ioColorBitMap, const Fu
             {
                 if (aValue)
                 {
-                    uint32_t aOffset = iFullFormat.bytesPerPixelBlock * (aPixelBlockPos) + (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
-                    memcpy(&(ioOutputTab[aOffset]), &aFinalValue, iFullFormat.bytesPerComponent);
+                    if (ipBlockFills != nullptr)
+                    {
+                        ipBlockFills->flagTab[aPixelBlockPos] |= BFF_PLAIN_COLOR;
+                    }
+                    else
+                    {
+                        uint32_t aOffset = (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
+                        memcpy(getPixelBlock(iSurface, iFullFormat, aPixelBlockPos) + aOffset, &aFinalValue, iFullFormat.bytesPerComponent);
+                    }
                     ioColorBitMap[aPixelBlockPos] = true;
                 }
                 --aCode;
@@ -541,11 +803,13 @@ void decodePlainColor(State& ioState, std::vector<bool>& ioColorBitMap, const Fu
     }
 }
 
-void inflateData(State& iState, const FullFormat& iFullFormat, uint32_t ioOutputSize, uint8_t* ioOutputTab)
+// Reads the header of the chunk and runs the passes writing constant values to the pixel blocks, ipBlockFills,
+// if any, records them instead of writing them to iSurface
+void inflateConstantPasses(State& iState, const FullFormat& iFullFormat, const Surface& iSurface, Scratch& ioScratch, BlockFills* ipBlockFills)
 {
     // Bitmaps
-    std::vector<bool> aColorBitmap;
-    std::vector<bool> aAlphaBitmap;
+    std::vector<bool>& aColorBitmap = ioScratch.colorBitmap;
+    std::vector<bool>& aAlphaBitmap = ioScratch.alphaBitmap;
 
     uint32_t aChunkStartPosition = iState.inputPos;
 
@@ -568,139 +832,318 @@ void inflateData(State& iState, const FullFormat& iFullFormat, uint32_t ioOutput
     aColorBitmap.assign(iFullFormat.nbObPixelBlocks, false);
     aAlphaBitmap.assign(iFullFormat.nbObPixelBlocks, false);
 
+    if (ipBlockFills != nullptr)
+    {
+        ipBlockFills->flagTab.assign(iFullFormat.nbObPixelBlocks, 0);
+    }
+
     if (aCompressionFlags & CF_DECODE_WHITE_COLOR)
     {
-        decodeWhiteColor(iState, aAlphaBitmap, aColorBitmap, iFullFormat, ioOutputTab);
+        decodeWhiteColor(iState, aAlphaBitmap, aColorBitmap, iFullFormat, iSurface, ipBlockFills);
     }
 
     if (aCompressionFlags & CF_DECODE_CONSTANT_ALPHA_FROM4BITS)
     {
-        decodeConstantAlphaFrom4Bits(iState, aAlphaBitmap, iFullFormat, ioOutputTab);
+        decodeConstantAlphaFrom4Bits(iState, aAlphaBitmap, iFullFormat, iSurface, ipBlockFills);
     }
 
     if (aCompressionFlags & CF_DECODE_CONSTANT_ALPHA_FROM8BITS)
     {
-        decodeConstantAlphaFrom8Bits(iState, aAlphaBitmap, iFullFormat, ioOutputTab);
+        decodeConstantAlphaFrom8Bits(iState, aAlphaBitmap, iFullFormat, iSurface, ipBlockFills);
     }
 
     if (aCompressionFlags & CF_DECODE_PLAIN_COLOR)
     {
-        decodePlainColor(iState, aColorBitmap, iFullFormat, ioOutputTab);
+        decodePlainColor(iState, aColorBitmap, iFullFormat, iSurface, ipBlockFills);
     }
 
-    uint32_t aLoopIndex;
-
     if (iState.bits >= 32)
     {
         --iState.inputPos;
     }
+}
+
+// Pass of inflateData reading words of the input into the pixel blocks its bitmap leaves unset
+struct WordPass
+{
+    const std::vector<bool>* pBitmap;
+    uint32_t offsetInBlock;
+    uint32_t nbOfWords;     // Per pixel block
+    uint32_t inputPos;      // Pixel mode: position of the words of the next row of pixel blocks
+};
+
+// Passes which follow inflateConstantPasses, in the order their words are stored
+void getWordPasses(const FullFormat& iFullFormat, const Scratch& iScratch, std::vector<WordPass>& oWordPassVect)
+{
+    oWordPassVect.clear();
+
+    WordPass aWordPass;
+    aWordPass.inputPos = 0;
 
     if ((((iFullFormat.format.flags) & FF_ALPHA) && !((iFullFormat.format.flags) & FF_DEDUCEDALPHACOMP)) || (iFullFormat.format.flags) & FF_BICOLORCOMP)
     {
-        for (aLoopIndex = 0; aLoopIndex < aAlphaBitmap.size() && iState.inputPos < iState.inputSize; ++aLoopIndex)
+        aWordPass.pBitmap = &iScratch.alphaBitmap;
+        aWordPass.offsetInBlock = 0;
+        aWordPass.nbOfWords = (iFullFormat.bytesPerComponent > 4) ? 2 : 1;
+        oWordPassVect.push_back(aWordPass);
+    }
+
+    if ((iFullFormat.format.flags) & FF_COLOR || (iFullFormat.format.flags) & FF_BICOLORCOMP)
+    {
+        uint32_t aColorOffset = (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
+
+        aWordPass.pBitmap = &iScratch.colorBitmap;
+        aWordPass.offsetInBlock = aColorOffset;
+        aWordPass.nbOfWords = 1;
+        oWordPassVect.push_back(aWordPass);
+
+        if (iFullFormat.bytesPerComponent > 4)
+        {
+            aWordPass.offsetInBlock = aColorOffset + 4;
+            oWordPassVect.push_back(aWordPass);
+        }
+    }
+}
+
+void inflateData(State& iState, const FullFormat& iFullFormat, const Surface& iSurface, Scratch& ioScratch)
+{
+    inflateConstantPasses(iState, iFullFormat, iSurface, ioScratch, nullptr);
+
+    std::vector<WordPass> aWordPassVect;
+    getWordPasses(iFullFormat, ioScratch, aWordPassVect);
+
+    for (auto itWordPass = aWordPassVect.begin(); itWordPass != aWordPassVect.end(); ++itWordPass)
+    {
+        const std::vector<bool>& aBitmap = *(itWordPass->pBitmap);
+
+        PixelBlockCursor aCursor(iSurface, iFullFormat, itWordPass->offsetInBlock);
+        for (uint32_t aLoopIndex = 0; aLoopIndex < aBitmap.size() && iState.inputPos < iState.inputSize; ++aLoopIndex)
         {
-            if (!aAlphaBitmap[aLoopIndex])
+            if (!aBitmap[aLoopIndex])
             {
-                (*reinterpret_cast<uint32_t*>(&(ioOutputTab[iFullFormat.bytesPerPixelBlock * aLoopIndex]))) = iState.input[iState.inputPos];
-                ++iState.inputPos;
-                if (iFullFormat.bytesPerComponent > 4)
+                for (uint32_t aWordIndex = 0; aWordIndex < itWordPass->nbOfWords; ++aWordIndex)
                 {
-                    (*reinterpret_cast<uint32_t*>(&(ioOutputTab[iFullFormat.bytesPerPixelBlock * aLoopIndex + 4]))) = iState.input[iState.inputPos];
+                    (*reinterpret_cast<uint32_t*>(aCursor.get() + 4 * aWordIndex)) = readInputWord(iState);
                     ++iState.inputPos;
                 }
             }
+            aCursor.next();
         }
     }
+}
 
-    if ((iFullFormat.format.flags) & FF_COLOR || (iFullFormat.format.flags) & FF_BICOLORCOMP)
+void inflateData(State& iState, const FullFormat& iFullFormat, const Surface& iSurface)
+{
+    Scratch aScratch;
+    inflateData(iState, iFullFormat, iSurface, aScratch);
+}
+
+Surface getPackedSurface(const FullFormat& iFullFormat, uint8_t* ioOutputTab)
+{
+    Surface aSurface;
+    aSurface.data = ioOutputTab;
+    aSurface.nbOfBlocksPerRow = (iFullFormat.width + 3) / 4;
+    aSurface.rowPitch = aSurface.nbOfBlocksPerRow * iFullFormat.bytesPerPixelBlock;
+    return aSurface;
+}
+
+// Writes the constant values recorded for a pixel block, in the order of the passes which recorded them
+void applyBlockFills(const BlockFills& iBlockFills, uint8_t iFlags, const FullFormat& iFullFormat, uint8_t* ioPixelBlock)
+{
+    if (iFlags & BFF_WHITE)
+    {
+        *reinterpret_cast<int64_t*>(ioPixelBlock) = 0xFFFFFFFFFFFFFFFE;
+    }
+
+    if (iFlags & (BFF_ALPHA_FROM4BITS | BFF_ALPHA_FROM8BITS))
+    {
+        uint64_t anAlphaValue = 0;
+        if (!(iFlags & BFF_NULL_ALPHA))
+        {
+            anAlphaValue = (iFlags & BFF_ALPHA_FROM4BITS) ? iBlockFills.alphaFrom4BitsValue : iBlockFills.alphaFrom8BitsValue;
+        }
+        memcpy(ioPixelBlock, &anAlphaValue, iFullFormat.bytesPerComponent);
+    }
+
+    if (iFlags & BFF_PLAIN_COLOR)
+    {
+        uint32_t aOffset = (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
+        memcpy(ioPixelBlock + aOffset, &iBlockFills.plainColorValue, iFullFormat.bytesPerComponent);
+    }
+}
+
+// Same as inflateData, but only one row of pixel blocks is held at once: the constant values are recorded per
+// pixel block, the position of the words of each pass is found from the bitmaps, then every row is assembled
+// from them and expanded into ioOutputTab. The input shall be fully in memory.
+void inflateDataToPixels(State& iState, const FullFormat& iFullFormat, uint8_t* ioOutputTab, uint32_t iOutputPitch, Scratch& ioScratch)
+{
+    if (iState.source != nullptr)
+    {
+        throw exception::Exception("Pixel output needs the whole input in memory.");
+    }
+
+    Surface aNullSurface;
+    aNullSurface.data = nullptr;
+    aNullSurface.rowPitch = 0;
+    aNullSurface.nbOfBlocksPerRow = (iFullFormat.width + 3) / 4;
+
+    BlockFills& aBlockFills = ioScratch.blockFills;
+    inflateConstantPasses(iState, iFullFormat, aNullSurface, ioScratch, &aBlockFills);
+
+    std::vector<WordPass> aWordPassVect;
+    getWordPasses(iFullFormat, ioScratch, aWordPassVect);
+
+    // Each pass reads a word per block its bitmap leaves unset, until the end of the input
+    uint32_t anInputPos = iState.inputPos;
+    for (auto itWordPass = aWordPassVect.begin(); itWordPass != aWordPassVect.end(); ++itWordPass)
+    {
+        itWordPass->inputPos = anInputPos;
+        if (anInputPos < iState.inputSize)
+        {
+            const std::vector<bool>& aBitmap = *(itWordPass->pBitmap);
+            uint32_t aNbOfUnsetBlocks = static_cast<uint32_t>(std::count(aBitmap.begin(), aBitmap.end(), false));
+            anInputPos += aNbOfUnsetBlocks * itWordPass->nbOfWords;
+        }
+    }
+
+    const uint32_t aNbOfBlocksPerRow = aNullSurface.nbOfBlocksPerRow;
+    const uint32_t aNbOfBlockRows = (iFullFormat.height + 3) / 4;
+
+    std::vector<uint8_t>& aBlockRowTab = ioScratch.blockRowTab;
+    aBlockRowTab.resize(aNbOfBlocksPerRow * iFullFormat.bytesPerPixelBlock);
+
+    for (uint32_t aBlockRow = 0; aBlockRow < aNbOfBlockRows; ++aBlockRow)
     {
-        for (aLoopIndex = 0; aLoopIndex < aColorBitmap.size() && iState.inputPos < iState.inputSize; ++aLoopIndex)
+        const uint32_t aFirstBlock = aBlockRow * aNbOfBlocksPerRow;
+
+        // Bytes written by none of the passes are left null
+        std::fill(aBlockRowTab.begin(), aBlockRowTab.end(), 0);
+
+        for (uint32_t aColumn = 0; aColumn < aNbOfBlocksPerRow; ++aColumn)
         {
-            if (!aColorBitmap[aLoopIndex])
+            uint8_t aFlags = aBlockFills.flagTab[aFirstBlock + aColumn];
+            if (aFlags != 0)
             {
-                uint32_t aOffset = iFullFormat.bytesPerPixelBlock * aLoopIndex + (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
-                (*reinterpret_cast<uint32_t*>(&(ioOutputTab[aOffset]))) = iState.input[iState.inputPos];
-                ++iState.inputPos;
+                applyBlockFills(aBlockFills, aFlags, iFullFormat, aBlockRowTab.data() + aColumn * iFullFormat.bytesPerPixelBlock);
             }
         }
-        if (iFullFormat.bytesPerComponent > 4)
+
+        for (auto itWordPass = aWordPassVect.begin(); itWordPass != aWordPassVect.end(); ++itWordPass)
         {
-            for (aLoopIndex = 0; aLoopIndex < aColorBitmap.size() && iState.inputPos < iState.inputSize; ++aLoopIndex)
+            const std::vector<bool>& aBitmap = *(itWordPass->pBitmap);
+            uint8_t* pPixelBlock = aBlockRowTab.data() + itWordPass->offsetInBlock;
+
+            iState.inputPos = itWordPass->inputPos;
+            for (uint32_t aColumn = 0; aColumn < aNbOfBlocksPerRow && iState.inputPos < iState.inputSize; ++aColumn)
             {
-                if (!aColorBitmap[aLoopIndex])
+                if (!aBitmap[aFirstBlock + aColumn])
                 {
-                    uint32_t aOffset = iFullFormat.bytesPerPixelBlock * aLoopIndex + 4 + (iFullFormat.hasTwoComponents ? iFullFormat.bytesPerComponent : 0);
-                    (*reinterpret_cast<uint32_t*>(&(ioOutputTab[aOffset]))) = iState.input[iState.inputPos];
-                    ++iState.inputPos;
+                    for (uint32_t aWordIndex = 0; aWordIndex < itWordPass->nbOfWords; ++aWordIndex)
+                    {
+                        (*reinterpret_cast<uint32_t*>(pPixelBlock + 4 * aWordIndex)) = readInputWord(iState);
+                        ++iState.inputPos;
+                    }
                 }
+                pPixelBlock += iFullFormat.bytesPerPixelBlock;
             }
+            itWordPass->inputPos = iState.inputPos;
         }
+
+        uint16_t aHeight = static_cast<uint16_t>(std::min<uint32_t>(4, iFullFormat.height - aBlockRow * 4));
+        decodeBlockRows(iFullFormat.format.blockFormat, iFullFormat.width, aHeight, 0, 1,
+                        aBlockRowTab.data(), ioOutputTab + static_cast<size_t>(aBlockRow) * 4 * iOutputPitch, iOutputPitch);
+    }
+
+    // Where inflateData stops, the end of the last pass
+    if (!aWordPassVect.empty())
+    {
+        iState.inputPos = std::min(aWordPassVect.back().inputPos, iState.inputSize);
     }
 }
+
+void inflateDataToPixels(State& iState, const FullFormat& iFullFormat, uint8_t* ioOutputTab, uint32_t iOutputPitch)
+{
+    Scratch aScratch;
+    inflateDataToPixels(iState, iFullFormat, ioOutputTab, iOutputPitch, aScratch);
 }
 
-GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+void inflateDataToSurface(State& iState, const FullFormat& iFullFormat, const TextureSurface& iSurface, TextureOutputFormat iOutputFormat)
 {
-    if (iInputTab == nullptr)
+    if (iSurface.data == nullptr)
     {
-        throw exception::Exception("Input buffer is null.");
+        throw exception::Exception("Surface data is null.");
     }
 
-    if (ioOutputTab != nullptr && ioOutputSize == 0)
-    {
-        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
-    }
+    uint32_t aNbOfBlocksPerRow = (iFullFormat.width + 3) / 4;
+    uint32_t aNbOfBlockRows = (iFullFormat.height + 3) / 4;
 
-    uint8_t* anOutputTab(nullptr);
-    bool isOutputTabOwned(true);
+    // Position of the first byte of the texture and extent of its rows in the surface
+    uint64_t aRowStart;
+    uint64_t aRowSize;
+    uint64_t aNbOfRows;
 
-    try
+    if (iOutputFormat == TOF_PIXELS)
     {
-        if (!texture::sStaticValuesInitialized)
+        uint32_t aPixelSize = getBlockFormatPixelSize(iFullFormat.format.blockFormat);
+
+        aRowStart = static_cast<uint64_t>(iSurface.blockOffsetX) * 4 * aPixelSize;
+        aRowSize = static_cast<uint64_t>(iFullFormat.width) * aPixelSize;
+        aNbOfRows = iFullFormat.height;
+
+        if (aNbOfRows != 0 && aRowStart + aRowSize > iSurface.rowPitch)
         {
-            texture::initializeStaticValues();
-            texture::sStaticValuesInitialized = true;
+            throw exception::Exception("Surface row pitch is too small.");
         }
 
-        // Initialize state
-        State aState;
-        aState.input = reinterpret_cast<const uint32_t*>(iInputTab);
-        aState.inputSize = iInputSize / 4;
-        aState.inputPos = 0;
-
-        aState.head = 0;
-        aState.bits = 0;
-        aState.buffer = 0;
+        uint64_t aStart = static_cast<uint64_t>(iSurface.blockOffsetY) * 4 * iSurface.rowPitch + aRowStart;
+        if (aNbOfRows != 0 && aStart + (aNbOfRows - 1) * iSurface.rowPitch + aRowSize > iSurface.size)
+        {
+            throw exception::Exception("Surface is too small.");
+        }
 
-        aState.isEmpty = false;
+        inflateDataToPixels(iState, iFullFormat, iSurface.data + aStart, iSurface.rowPitch);
+    }
+    else
+    {
+        aRowStart = static_cast<uint64_t>(iSurface.blockOffsetX) * iFullFormat.bytesPerPixelBlock;
+        aRowSize = static_cast<uint64_t>(aNbOfBlocksPerRow) * iFullFormat.bytesPerPixelBlock;
+        aNbOfRows = aNbOfBlockRows;
 
-        // Skipping header
-        needBits(aState, 32);
-        dropBits(aState, 32);
+        if (aNbOfRows != 0 && aRowStart + aRowSize > iSurface.rowPitch)
+        {
+            throw exception::Exception("Surface row pitch is too small.");
+        }
 
-        // Format
-        needBits(aState, 32);
-        uint32_t aFormatFourCc = readBits(aState, 32);
-        dropBits(aState, 32);
+        uint64_t aStart = static_cast<uint64_t>(iSurface.blockOffsetY) * iSurface.rowPitch + aRowStart;
+        if (aNbOfRows != 0 && aStart + (aNbOfRows - 1) * iSurface.rowPitch + aRowSize > iSurface.size)
+        {
+            throw exception::Exception("Surface is too small.");
+        }
 
-        texture::FullFormat aFullFormat;
+        Surface aSurface;
+        aSurface.data = iSurface.data + aStart;
+        aSurface.rowPitch = iSurface.rowPitch;
+        aSurface.nbOfBlocksPerRow = aNbOfBlocksPerRow;
 
-        aFullFormat.format = texture::deduceFormat(aFormatFourCc);
+        inflateData(iState, iFullFormat, aSurface);
+    }
+}
 
-        // Getting width/height
-        needBits(aState, 32);
-        aFullFormat.width = readBits(aState, 16);
-        dropBits(aState, 16);
-        aFullFormat.height = readBits(aState, 16);
-        dropBits(aState, 16);
+// Inflates the whole texture read by ioState into ioOutputTab, allocating it if needed
+uint8_t* inflateTexture(State& ioState, uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    uint8_t* anOutputTab(nullptr);
+    bool isOutputTabOwned(true);
 
-        aFullFormat.nbObPixelBlocks = ((aFullFormat.width + 3) / 4) * ((aFullFormat.height + 3) / 4);
-        aFullFormat.bytesPerPixelBlock = (aFullFormat.format.pixelSizeInBits * 4 * 4) / 8;
-        aFullFormat.hasTwoComponents =
-            ((aFullFormat.format.flags & (texture::FF_PLAINCOMP | texture::FF_COLOR | texture::FF_ALPHA)) == (texture::FF_PLAINCOMP | texture::FF_COLOR | texture::FF_ALPHA))
-            || (aFullFormat.format.flags & texture::FF_BICOLORCOMP);
+    try
+    {
+        uint32_t aFormatFourCc;
+        uint16_t aWidth;
+        uint16_t aHeight;
+        readHeader(ioState, aFormatFourCc, aWidth, aHeight);
 
-        aFullFormat.bytesPerComponent = aFullFormat.bytesPerPixelBlock / (aFullFormat.hasTwoComponents ? 2 : 1);
+        FullFormat aFullFormat;
+        initializeFullFormat(aFormatFourCc, aWidth, aHeight, aFullFormat);
 
         uint32_t anOutputSize = aFullFormat.bytesPerPixelBlock * aFullFormat.nbObPixelBlocks;
 
@@ -721,7 +1164,7 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffer(uint32_t
             anOutputTab = ioOutputTab;
         }
 
-        texture::inflateData(aState, aFullFormat, ioOutputSize, anOutputTab);
+        inflateData(ioState, aFullFormat, getPackedSurface(aFullFormat, anOutputTab));
 
         return anOutputTab;
     }
@@ -743,86 +1186,523 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffer(uint32_t
     }
 }
 
-GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBuffer(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
-        uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+// Feeds a State with the output of a DatFileInflater, only a window of it
+// being kept in memory
+class DatFileInputSource : public InputSource
 {
-    if (iInputTab == nullptr)
-    {
-        throw exception::Exception("Input buffer is null.");
-    }
+public:
+    DatFileInputSource(dat::DatFileInflater& ioInflater);
 
-    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    virtual void fetch(State& ioState);
+
+private:
+    static const uint32_t sWindowChunkSize = 65536;
+
+    dat::DatFileInflater& _inflater;
+    uint32_t _outputSize;
+
+    std::vector<uint8_t> _window;
+    uint32_t _windowBegin; // Position of the window in the inflated data
+    uint32_t _windowSize;  // Bytes already inflated in the window
+};
+
+DatFileInputSource::DatFileInputSource(dat::DatFileInflater& ioInflater) :
+    _inflater(ioInflater),
+    _outputSize(ioInflater.getOutputSize()),
+    _window(dat::sDatFileMaxWriteOffset + sWindowChunkSize),
+    _windowBegin(0),
+    _windowSize(0)
+{
+}
+
+void DatFileInputSource::fetch(State& ioState)
+{
+    uint64_t aNeededEnd = (static_cast<uint64_t>(ioState.inputPos) + 1) * 4;
+
+    if (static_cast<uint64_t>(ioState.inputPos) * 4 < _windowBegin)
     {
-        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+        throw exception::Exception("Tried to read a word which is not in the window anymore.");
     }
 
-    uint8_t* anOutputTab(nullptr);
-    bool isOutputTabOwned(true);
-
-    try
+    while (_windowBegin + _windowSize < aNeededEnd)
     {
-        if (!texture::sStaticValuesInitialized)
+        // Window is full, keeping only the history needed by the copies
+        if (_windowSize == _window.size())
         {
-            texture::initializeStaticValues();
-            texture::sStaticValuesInitialized = true;
+            uint32_t aDroppedSize = _windowSize - dat::sDatFileMaxWriteOffset;
+            memmove(_window.data(), _window.data() + aDroppedSize, dat::sDatFileMaxWriteOffset);
+            _windowBegin += aDroppedSize;
+            _windowSize = dat::sDatFileMaxWriteOffset;
         }
 
-        // Initialize format
-        texture::FullFormat aFullFormat;
+        uint32_t anOutputEnd = static_cast<uint32_t>(std::min<uint64_t>(_window.size(), _outputSize - _windowBegin));
+        uint32_t anOutputPos = _windowSize;
 
-        aFullFormat.format = texture::deduceFormat(iFormatFourCc);
-        aFullFormat.width  = iWidth;
-        aFullFormat.height = iHeight;
+        _inflater.inflate(_window.data(), anOutputPos, anOutputEnd);
 
-        aFullFormat.nbObPixelBlocks = ((aFullFormat.width + 3) / 4) * ((aFullFormat.height + 3) / 4);
-        aFullFormat.bytesPerPixelBlock = (aFullFormat.format.pixelSizeInBits * 4 * 4) / 8;
-        aFullFormat.hasTwoComponents =
-            ((aFullFormat.format.flags & (texture::FF_PLAINCOMP | texture::FF_COLOR | texture::FF_ALPHA)) == (texture::FF_PLAINCOMP | texture::FF_COLOR | texture::FF_ALPHA))
-            || (aFullFormat.format.flags & texture::FF_BICOLORCOMP);
+        if (anOutputPos == _windowSize)
+        {
+            throw exception::Exception("Reached end of the inflated data while trying to fetch a new word.");
+        }
+        _windowSize = anOutputPos;
+    }
 
-        aFullFormat.bytesPerComponent = aFullFormat.bytesPerPixelBlock / (aFullFormat.hasTwoComponents ? 2 : 1);
+    ioState.input = reinterpret_cast<const uint32_t*>(_window.data());
+    ioState.inputBegin = _windowBegin / 4;
+    ioState.inputEnd = (_windowBegin + _windowSize) / 4;
+}
 
-        // Initialize state
-        State aState;
-        aState.input = reinterpret_cast<const uint32_t*>(iInputTab);
-        aState.inputSize = iInputSize / 4;
-        aState.inputPos = 0;
+// Batch decoding
 
-        aState.head = 0;
-        aState.bits = 0;
-        aState.buffer = 0;
+// Alignment of the outputs in the batch arena
+const uint32_t sBatchOutputAlignment = 16;
+// Number of jobs a worker takes at once, textures of a batch are often tiny
+const uint32_t sBatchJobChunkSize = 8;
 
-        aState.isEmpty = false;
+struct BatchJobInfos
+{
+    FullFormat fullFormat;
+    uint64_t arenaOffset;
+    bool isValid;
+};
 
-        // Allocate output buffer
-        uint32_t anOutputSize = aFullFormat.bytesPerPixelBlock * aFullFormat.nbObPixelBlocks;
+uint32_t getJobOutputSize(const FullFormat& iFullFormat, TextureOutputFormat iOutputFormat)
+{
+    if (iOutputFormat == TOF_PIXELS)
+    {
+        return iFullFormat.width * iFullFormat.height * getBlockFormatPixelSize(iFullFormat.format.blockFormat);
+    }
+    return iFullFormat.bytesPerPixelBlock * iFullFormat.nbObPixelBlocks;
+}
 
-        if (ioOutputSize != 0 && ioOutputSize < anOutputSize)
-        {
-            throw exception::Exception("Output buffer is too small.");
-        }
+void decodeJob(TextureJob& ioJob, const FullFormat& iFullFormat, State& ioState, Scratch& ioScratch)
+{
+    try
+    {
+        uint32_t aFormatFourCc;
+        uint16_t aWidth;
+        uint16_t aHeight;
 
-        ioOutputSize = anOutputSize;
+        initializeState(ioJob.inputSize, ioJob.inputTab, ioState);
+        readHeader(ioState, aFormatFourCc, aWidth, aHeight);
 
-        if (ioOutputTab == nullptr)
+        if (ioJob.outputFormat == TOF_PIXELS)
         {
-            anOutputTab = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * anOutputSize));
+            inflateDataToPixels(ioState, iFullFormat, ioJob.outputTab, iFullFormat.width * getBlockFormatPixelSize(iFullFormat.format.blockFormat), ioScratch);
         }
         else
         {
-            isOutputTabOwned = false;
-            anOutputTab = ioOutputTab;
+            inflateData(ioState, iFullFormat, getPackedSurface(iFullFormat, ioJob.outputTab), ioScratch);
         }
 
-        texture::inflateData(aState, aFullFormat, ioOutputSize, anOutputTab);
-
-        return anOutputTab;
+        ioJob.isSuccessful = true;
     }
-    catch(exception::Exception& iException)
+    catch(std::exception& iException)
     {
-        if (isOutputTabOwned)
+        ioJob.errorMessage = iException.what();
+    }
+}
+
+void runBatchWorker(std::atomic<uint32_t>& ioNextJob, uint32_t iNbOfJobs, TextureJob* ioJobTab, const std::vector<BatchJobInfos>& iJobInfosVect)
+{
+    State aState;
+    Scratch aScratch;
+
+    while (true)
+    {
+        uint32_t aFirstJob = ioNextJob.fetch_add(sBatchJobChunkSize);
+        if (aFirstJob >= iNbOfJobs)
         {
-            free(anOutputTab);
+            return;
+        }
+
+        uint32_t aLastJob = std::min(aFirstJob + sBatchJobChunkSize, iNbOfJobs);
+        for (uint32_t aJobIndex = aFirstJob; aJobIndex < aLastJob; ++aJobIndex)
+        {
+            if (iJobInfosVect[aJobIndex].isValid)
+            {
+                decodeJob(ioJobTab[aJobIndex], iJobInfosVect[aJobIndex].fullFormat, aState, aScratch);
+            }
+        }
+    }
+}
+
+// Texture magics: ATEX, ATTX, ATEC, ATEP, ATEU, ATET
+bool isTextureMagic(uint32_t iMagic)
+{
+    switch (iMagic)
+    {
+    case 0x58455441:
+    case 0x58545441:
+    case 0x43455441:
+    case 0x50455441:
+    case 0x55455441:
+    case 0x54455441:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    // Initialize state
+    State aState;
+    texture::initializeState(iInputSize, iInputTab, aState);
+
+    return texture::inflateTexture(aState, ioOutputSize, ioOutputTab);
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBuffer(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    uint8_t* anOutputTab(nullptr);
+    bool isOutputTabOwned(true);
+
+    try
+    {
+        // Initialize format
+        texture::FullFormat aFullFormat;
+        texture::initializeFullFormat(iFormatFourCc, iWidth, iHeight, aFullFormat);
+
+        // Initialize state
+        State aState;
+        texture::initializeState(iInputSize, iInputTab, aState);
+
+        // Allocate output buffer
+        uint32_t anOutputSize = aFullFormat.bytesPerPixelBlock * aFullFormat.nbObPixelBlocks;
+
+        if (ioOutputSize != 0 && ioOutputSize < anOutputSize)
+        {
+            throw exception::Exception("Output buffer is too small.");
+        }
+
+        ioOutputSize = anOutputSize;
+
+        if (ioOutputTab == nullptr)
+        {
+            anOutputTab = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * anOutputSize));
+        }
+        else
+        {
+            isOutputTabOwned = false;
+            anOutputTab = ioOutputTab;
+        }
+
+        texture::inflateData(aState, aFullFormat, texture::getPackedSurface(aFullFormat, anOutputTab));
+
+        return anOutputTab;
+    }
+    catch(exception::Exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+    catch(std::exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+}
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getTexturePixelSize(uint32_t iFormatFourCc)
+{
+    return texture::getBlockFormatPixelSize(texture::deduceFormat(iFormatFourCc).blockFormat);
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBufferToPixels(uint32_t iInputSize, const uint8_t* iInputTab,  uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    uint8_t* anOutputTab(nullptr);
+    bool isOutputTabOwned(true);
+
+    try
+    {
+        // Initialize state
+        State aState;
+        texture::initializeState(iInputSize, iInputTab, aState);
+
+        uint32_t aFormatFourCc;
+        uint16_t aWidth;
+        uint16_t aHeight;
+        texture::readHeader(aState, aFormatFourCc, aWidth, aHeight);
+
+        texture::FullFormat aFullFormat;
+        texture::initializeFullFormat(aFormatFourCc, aWidth, aHeight, aFullFormat);
+
+        uint32_t anOutputSize = texture::getBlockFormatPixelSize(aFullFormat.format.blockFormat) * aFullFormat.width * aFullFormat.height;
+
+        if (ioOutputSize != 0 && ioOutputSize < anOutputSize)
+        {
+            throw exception::Exception("Output buffer is too small.");
+        }
+
+        ioOutputSize = anOutputSize;
+
+        if (ioOutputTab == nullptr)
+        {
+            anOutputTab = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * anOutputSize));
+        }
+        else
+        {
+            isOutputTabOwned = false;
+            anOutputTab = ioOutputTab;
+        }
+
+        texture::inflateDataToPixels(aState, aFullFormat, anOutputTab, aFullFormat.width * texture::getBlockFormatPixelSize(aFullFormat.format.blockFormat));
+
+        return anOutputTab;
+    }
+    catch(exception::Exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+    catch(std::exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBufferToPixels(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    uint8_t* anOutputTab(nullptr);
+    bool isOutputTabOwned(true);
+
+    try
+    {
+        // Initialize format
+        texture::FullFormat aFullFormat;
+        texture::initializeFullFormat(iFormatFourCc, iWidth, iHeight, aFullFormat);
+
+        // Initialize state
+        State aState;
+        texture::initializeState(iInputSize, iInputTab, aState);
+
+        // Allocate output buffer
+        uint32_t anOutputSize = texture::getBlockFormatPixelSize(aFullFormat.format.blockFormat) * aFullFormat.width * aFullFormat.height;
+
+        if (ioOutputSize != 0 && ioOutputSize < anOutputSize)
+        {
+            throw exception::Exception("Output buffer is too small.");
+        }
+
+        ioOutputSize = anOutputSize;
+
+        if (ioOutputTab == nullptr)
+        {
+            anOutputTab = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * anOutputSize));
+        }
+        else
+        {
+            isOutputTabOwned = false;
+            anOutputTab = ioOutputTab;
+        }
+
+        texture::inflateDataToPixels(aState, aFullFormat, anOutputTab, aFullFormat.width * texture::getBlockFormatPixelSize(aFullFormat.format.blockFormat));
+
+        return anOutputTab;
+    }
+    catch(exception::Exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+    catch(std::exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
+        }
+        throw iException; // Rethrow exception
+    }
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureFileBufferToSurface(uint32_t iInputSize, const uint8_t* iInputTab, const TextureSurface& iSurface, TextureOutputFormat iOutputFormat)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    // Initialize state
+    State aState;
+    texture::initializeState(iInputSize, iInputTab, aState);
+
+    uint32_t aFormatFourCc;
+    uint16_t aWidth;
+    uint16_t aHeight;
+    texture::readHeader(aState, aFormatFourCc, aWidth, aHeight);
+
+    texture::FullFormat aFullFormat;
+    texture::initializeFullFormat(aFormatFourCc, aWidth, aHeight, aFullFormat);
+
+    texture::inflateDataToSurface(aState, aFullFormat, iSurface, iOutputFormat);
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureBlockBufferToSurface(uint16_t iWidth, uint16_t iHeight, uint32_t iFormatFourCc, uint32_t iInputSize, const uint8_t* iInputTab,
+        const TextureSurface& iSurface, TextureOutputFormat iOutputFormat)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    // Initialize format
+    texture::FullFormat aFullFormat;
+    texture::initializeFullFormat(iFormatFourCc, iWidth, iHeight, aFullFormat);
+
+    // Initialize state
+    State aState;
+    texture::initializeState(iInputSize, iInputTab, aState);
+
+    texture::inflateDataToSurface(aState, aFullFormat, iSurface, iOutputFormat);
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY parseTextureFileBuffer(uint32_t iInputSize, const uint8_t* iInputTab, TextureInfos& oTextureInfos)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    State aState;
+    texture::initializeState(iInputSize, iInputTab, aState);
+
+    texture::readHeader(aState, oTextureInfos.formatFourCc, oTextureInfos.width, oTextureInfos.height);
+    texture::parseMipLevels(iInputSize, iInputTab, oTextureInfos.width, oTextureInfos.height, oTextureInfos.mipLevels);
+}
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY selectTextureMipLevel(const TextureInfos& iTextureInfos, uint16_t iMinWidth)
+{
+    for (uint32_t aMipLevel = static_cast<uint32_t>(iTextureInfos.mipLevels.size()); aMipLevel > 0; --aMipLevel)
+    {
+        if (iTextureInfos.mipLevels[aMipLevel - 1].width >= iMinWidth)
+        {
+            return aMipLevel - 1;
+        }
+    }
+    return 0;
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureMipLevelBuffer(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iMipLevel,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    TextureInfos aTextureInfos;
+    parseTextureFileBuffer(iInputSize, iInputTab, aTextureInfos);
+
+    if (iMipLevel >= aTextureInfos.mipLevels.size())
+    {
+        throw exception::Exception("Mip level not found.");
+    }
+
+    const TextureMipLevel& aMipLevel = aTextureInfos.mipLevels[iMipLevel];
+
+    uint8_t* anOutputTab(nullptr);
+    bool isOutputTabOwned(true);
+
+    try
+    {
+        texture::FullFormat aFullFormat;
+        texture::initializeFullFormat(aTextureInfos.formatFourCc, aMipLevel.width, aMipLevel.height, aFullFormat);
+
+        // The state keeps absolute positions so that the 64k words skipping stays aligned
+        State aState;
+        texture::initializeState(aMipLevel.offset + aMipLevel.size, iInputTab, aState);
+        aState.inputPos = aMipLevel.offset / 4;
+
+        uint32_t anOutputSize = aFullFormat.bytesPerPixelBlock * aFullFormat.nbObPixelBlocks;
+
+        if (ioOutputSize != 0 && ioOutputSize < anOutputSize)
+        {
+            throw exception::Exception("Output buffer is too small.");
+        }
+
+        ioOutputSize = anOutputSize;
+
+        if (ioOutputTab == nullptr)
+        {
+            anOutputTab = static_cast<uint8_t*>(malloc(sizeof(uint8_t) * anOutputSize));
+        }
+        else
+        {
+            isOutputTabOwned = false;
+            anOutputTab = ioOutputTab;
+        }
+
+        texture::inflateData(aState, aFullFormat, texture::getPackedSurface(aFullFormat, anOutputTab));
+
+        return anOutputTab;
+    }
+    catch(exception::Exception& iException)
+    {
+        if (isOutputTabOwned)
+        {
+            free(anOutputTab);
         }
         throw iException; // Rethrow exception
     }
@@ -836,5 +1716,193 @@ GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureBlockBuffer(uint16_t
     }
 }
 
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY inflateTextureMipLevelToSurface(uint32_t iInputSize, const uint8_t* iInputTab, uint32_t iMipLevel,
+        const TextureSurface& iSurface, TextureOutputFormat iOutputFormat)
+{
+    TextureInfos aTextureInfos;
+    parseTextureFileBuffer(iInputSize, iInputTab, aTextureInfos);
+
+    if (iMipLevel >= aTextureInfos.mipLevels.size())
+    {
+        throw exception::Exception("Mip level not found.");
+    }
+
+    const TextureMipLevel& aMipLevel = aTextureInfos.mipLevels[iMipLevel];
+
+    texture::FullFormat aFullFormat;
+    texture::initializeFullFormat(aTextureInfos.formatFourCc, aMipLevel.width, aMipLevel.height, aFullFormat);
+
+    // The state keeps absolute positions so that the 64k words skipping stays aligned
+    State aState;
+    texture::initializeState(aMipLevel.offset + aMipLevel.size, iInputTab, aState);
+    aState.inputPos = aMipLevel.offset / 4;
+
+    texture::inflateDataToSurface(aState, aFullFormat, iSurface, iOutputFormat);
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureDatFileBuffer(bool iIsCompressed, uint32_t iInputSize, const uint8_t* iInputTab,
+        uint32_t& ioOutputSize, uint8_t* ioOutputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (ioOutputTab != nullptr && ioOutputSize == 0)
+    {
+        throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+    }
+
+    if (!iIsCompressed)
+    {
+        State aState;
+        texture::initializeState(iInputSize, iInputTab, aState);
+
+        if (aState.inputSize == 0 || !texture::isTextureMagic(readInputWord(aState)))
+        {
+            throw exception::Exception("Not a texture.");
+        }
+
+        return texture::inflateTexture(aState, ioOutputSize, ioOutputTab);
+    }
+
+    dat::DatFileInflater anInflater(iInputSize, iInputTab);
+    texture::DatFileInputSource anInputSource(anInflater);
+
+    // The state addresses the inflated data, which is only available through the source
+    State aState;
+    texture::initializeState(0, nullptr, aState);
+    aState.inputSize = anInflater.getOutputSize() / 4;
+    aState.source = &anInputSource;
+
+    if (aState.inputSize == 0 || !texture::isTextureMagic(readInputWord(aState)))
+    {
+        throw exception::Exception("Not a texture.");
+    }
+
+    return texture::inflateTexture(aState, ioOutputSize, ioOutputTab);
+}
+
+GW2DATTOOLS_API uint8_t* GW2DATTOOLS_APIENTRY inflateTextureFileBuffers(uint32_t iNbOfJobs, TextureJob* ioJobTab, uint32_t iNbOfThreads)
+{
+    if (iNbOfJobs == 0)
+    {
+        return nullptr;
+    }
+
+    if (ioJobTab == nullptr)
+    {
+        throw exception::Exception("Job buffer is null.");
+    }
+
+    // Reading the headers, so that the outputs can be laid out before decoding
+    std::vector<texture::BatchJobInfos> aJobInfosVect(iNbOfJobs);
+    uint64_t anArenaSize = 0;
+
+    for (uint32_t aJobIndex = 0; aJobIndex < iNbOfJobs; ++aJobIndex)
+    {
+        TextureJob& aJob = ioJobTab[aJobIndex];
+        texture::BatchJobInfos& aJobInfos = aJobInfosVect[aJobIndex];
+
+        aJob.isSuccessful = false;
+        aJob.errorMessage.clear();
+        aJobInfos.isValid = false;
+
+        try
+        {
+            if (aJob.inputTab == nullptr)
+            {
+                throw exception::Exception("Input buffer is null.");
+            }
+
+            if (aJob.outputTab != nullptr && aJob.outputSize == 0)
+            {
+                throw exception::Exception("Output buffer is not null and outputSize is not defined.");
+            }
+
+            State aState;
+            texture::initializeState(aJob.inputSize, aJob.inputTab, aState);
+
+            uint32_t aFormatFourCc;
+            uint16_t aWidth;
+            uint16_t aHeight;
+            texture::readHeader(aState, aFormatFourCc, aWidth, aHeight);
+
+            texture::initializeFullFormat(aFormatFourCc, aWidth, aHeight, aJobInfos.fullFormat);
+
+            uint32_t anOutputSize = texture::getJobOutputSize(aJobInfos.fullFormat, aJob.outputFormat);
+
+            if (aJob.outputTab != nullptr && aJob.outputSize < anOutputSize)
+            {
+                throw exception::Exception("Output buffer is too small.");
+            }
+
+            if (aJob.outputTab == nullptr)
+            {
+                aJobInfos.arenaOffset = anArenaSize;
+                anArenaSize += (anOutputSize + texture::sBatchOutputAlignment - 1) & ~static_cast<uint64_t>(texture::sBatchOutputAlignment - 1);
+            }
+
+            aJob.outputSize = anOutputSize;
+            aJobInfos.isValid = true;
+        }
+        catch(std::exception& iException)
+        {
+            aJob.errorMessage = iException.what();
+        }
+    }
+
+    if (anArenaSize != static_cast<size_t>(anArenaSize))
+    {
+        throw exception::Exception("Batch outputs are too big.");
+    }
+
+    uint8_t* anArenaTab(nullptr);
+    if (anArenaSize != 0)
+    {
+        anArenaTab = static_cast<uint8_t*>(malloc(static_cast<size_t>(anArenaSize)));
+        if (anArenaTab == nullptr)
+        {
+            throw exception::Exception("Could not allocate the batch arena.");
+        }
+
+        for (uint32_t aJobIndex = 0; aJobIndex < iNbOfJobs; ++aJobIndex)
+        {
+            if (aJobInfosVect[aJobIndex].isValid && ioJobTab[aJobIndex].outputTab == nullptr)
+            {
+                ioJobTab[aJobIndex].outputTab = anArenaTab + aJobInfosVect[aJobIndex].arenaOffset;
+            }
+        }
+    }
+
+    uint32_t aNbOfThreads = (iNbOfThreads != 0) ? iNbOfThreads : std::thread::hardware_concurrency();
+    aNbOfThreads = std::max(1u, std::min(aNbOfThreads, (iNbOfJobs + texture::sBatchJobChunkSize - 1) / texture::sBatchJobChunkSize));
+
+    std::atomic<uint32_t> aNextJob(0);
+
+    // The calling thread is one of the workers
+    std::vector<std::thread> aThreadVect;
+    for (uint32_t aThreadIndex = 1; aThreadIndex < aNbOfThreads; ++aThreadIndex)
+    {
+        try
+        {
+            aThreadVect.push_back(std::thread(texture::runBatchWorker, std::ref(aNextJob), iNbOfJobs, ioJobTab, std::cref(aJobInfosVect)));
+        }
+        catch(std::exception&)
+        {
+            break; // The running workers take the remaining jobs
+        }
+    }
+
+    texture::runBatchWorker(aNextJob, iNbOfJobs, ioJobTab, aJobInfosVect);
+
+    for (auto it = aThreadVect.begin(); it != aThreadVect.end(); ++it)
+    {
+        it->join();
+    }
+
+    return anArenaTab;
+}
+
 }
 }
@@ -0,0 +1,297 @@
+#include "gw2DatTools/format/ANStructsSchema.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "gw2DatTools/exception/Exception.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+struct ValueTypeInfos
+{
+    const char* name;
+    SchemaValueType valueType;
+    uint32_t size;
+};
+
+static const ValueTypeInfos sValueTypeInfosTab[] =
+{
+    { "byte",      SVT_BYTE,      1 },
+    { "byte3",     SVT_BYTE3,     3 },
+    { "byte4",     SVT_BYTE4,     4 },
+    { "byte16",    SVT_BYTE16,    16 },
+    { "word",      SVT_WORD,      2 },
+    { "word3",     SVT_WORD3,     6 },
+    { "dword",     SVT_DWORD,     4 },
+    { "dword2",    SVT_DWORD2,    8 },
+    { "dword4",    SVT_DWORD4,    16 },
+    { "qword",     SVT_QWORD,     8 },
+    { "float",     SVT_FLOAT,     4 },
+    { "float2",    SVT_FLOAT2,    8 },
+    { "float3",    SVT_FLOAT3,    12 },
+    { "float4",    SVT_FLOAT4,    16 },
+    { "fileref",   SVT_FILEREF,   4 },
+    { "filename",  SVT_FILENAME,  4 },
+    { "wchar_ptr", SVT_WCHAR_PTR, 4 },
+    { "char_ptr",  SVT_CHAR_PTR,  4 }
+};
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY getSchemaValueSize(SchemaValueType iValueType)
+{
+    for (uint32_t anIndex = 0; anIndex < sizeof(sValueTypeInfosTab) / sizeof(sValueTypeInfosTab[0]); ++anIndex)
+    {
+        if (sValueTypeInfosTab[anIndex].valueType == iValueType)
+        {
+            return sValueTypeInfosTab[anIndex].size;
+        }
+    }
+    return 0;
+}
+
+// Size of the pointer part of the encodings
+uint32_t getEncodingSize(SchemaEncoding iEncoding)
+{
+    switch (iEncoding)
+    {
+    case SE_PTR:
+        return sizeof(uint32_t);
+    case SE_ARRAY_PTR:
+    case SE_PTR_ARRAY_PTR:
+        return 2 * sizeof(uint32_t);
+    default:
+        return 0;
+    }
+}
+
+bool startsWith(const std::string& iString, const char* iPrefix)
+{
+    return iString.compare(0, strlen(iPrefix), iPrefix) == 0;
+}
+
+std::string trim(const std::string& iString)
+{
+    size_t aBegin = iString.find_first_not_of(" \t\r");
+    if (aBegin == std::string::npos)
+    {
+        return std::string();
+    }
+    size_t anEnd = iString.find_last_not_of(" \t\r");
+    return iString.substr(aBegin, anEnd - aBegin + 1);
+}
+
+// Parses "[ENCODING_START ]type name[[count]][ ENCODING_END];"
+void parseField(const std::string& iLine, SchemaField& oField, std::string& oTypeName)
+{
+    if (iLine.empty() || iLine[iLine.size() - 1] != ';')
+    {
+        throw exception::Exception("Unexpected field in ANStructs.");
+    }
+
+    std::vector<std::string> aTokenVect;
+    size_t aPos = 0;
+    std::string aContent = iLine.substr(0, iLine.size() - 1);
+    while (aPos < aContent.size())
+    {
+        size_t anEnd = aContent.find(' ', aPos);
+        if (anEnd == std::string::npos)
+        {
+            anEnd = aContent.size();
+        }
+        if (anEnd > aPos)
+        {
+            aTokenVect.push_back(aContent.substr(aPos, anEnd - aPos));
+        }
+        aPos = anEnd + 1;
+    }
+
+    oField.encoding = SE_INLINE;
+    if (aTokenVect.size() == 4)
+    {
+        if (aTokenVect[0] == "TPTR_START")
+        {
+            oField.encoding = SE_PTR;
+        }
+        else if (aTokenVect[0] == "TSTRUCT_ARRAY_PTR_START")
+        {
+            oField.encoding = SE_ARRAY_PTR;
+        }
+        else if (aTokenVect[0] == "TSTRUCT_PTR_ARRAY_PTR_START")
+        {
+            oField.encoding = SE_PTR_ARRAY_PTR;
+        }
+        else
+        {
+            throw exception::Exception("Unexpected field in ANStructs.");
+        }
+        aTokenVect.erase(aTokenVect.begin());
+        aTokenVect.pop_back();
+    }
+
+    if (aTokenVect.size() != 2)
+    {
+        throw exception::Exception("Unexpected field in ANStructs.");
+    }
+
+    oTypeName = aTokenVect[0];
+    oField.name = aTokenVect[1];
+    oField.nbOfElements = 1;
+
+    size_t aBracketPos = oField.name.find('[');
+    if (aBracketPos != std::string::npos)
+    {
+        oField.nbOfElements = static_cast<uint32_t>(strtoul(oField.name.c_str() + aBracketPos + 1, nullptr, 10));
+        oField.name.resize(aBracketPos);
+    }
+
+    // Some names are qualified (ExtendedData.Type), dots are dropped as they separate the names of a field path
+    oField.name.erase(std::remove(oField.name.begin(), oField.name.end(), '.'), oField.name.end());
+}
+
+// Resolves the types of the fields of a struct and computes its layout
+void layoutStruct(SchemaStruct& ioStruct, const std::vector<std::string>& iTypeNameVect,
+                  const std::unordered_map<std::string, const SchemaStruct*>& iStructDict)
+{
+    ioStruct.isSized = true;
+    ioStruct.size = 0;
+
+    for (uint32_t aFieldIndex = 0; aFieldIndex < ioStruct.fields.size(); ++aFieldIndex)
+    {
+        SchemaField& aField = ioStruct.fields[aFieldIndex];
+        const std::string& aTypeName = iTypeNameVect[aFieldIndex];
+
+        aField.valueType = SVT_UNKNOWN;
+        aField.pStruct = nullptr;
+
+        uint32_t aValueSize = 0;
+        for (uint32_t anIndex = 0; anIndex < sizeof(sValueTypeInfosTab) / sizeof(sValueTypeInfosTab[0]); ++anIndex)
+        {
+            if (aTypeName == sValueTypeInfosTab[anIndex].name)
+            {
+                aField.valueType = sValueTypeInfosTab[anIndex].valueType;
+                aValueSize = sValueTypeInfosTab[anIndex].size;
+                break;
+            }
+        }
+
+        if (aField.valueType == SVT_UNKNOWN)
+        {
+            // Structs may be redefined, the latest definition is used
+            auto it = iStructDict.find(aTypeName);
+            if (it != iStructDict.end())
+            {
+                aField.valueType = SVT_STRUCT;
+                aField.pStruct = it->second;
+                aValueSize = it->second->isSized ? it->second->size : 0;
+            }
+        }
+
+        aField.isLocated = ioStruct.isSized;
+        aField.offset = ioStruct.isSized ? ioStruct.size : 0;
+
+        if (aField.encoding != SE_INLINE)
+        {
+            ioStruct.size += getEncodingSize(aField.encoding) * aField.nbOfElements;
+        }
+        else if (aValueSize != 0)
+        {
+            ioStruct.size += aValueSize * aField.nbOfElements;
+        }
+        else
+        {
+            ioStruct.isSized = false;
+        }
+    }
+
+    if (!ioStruct.isSized)
+    {
+        ioStruct.size = 0;
+    }
+}
+
+GW2DATTOOLS_API std::unique_ptr<ANStructsSchema> GW2DATTOOLS_APIENTRY parseANStructsSchema(const char* iPath)
+{
+    std::ifstream aStream(iPath);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open ANStructs.");
+    }
+
+    std::unique_ptr<ANStructsSchema> pSchema(new ANStructsSchema());
+
+    SchemaChunk* pChunk = nullptr;
+    SchemaVersion* pVersion = nullptr;
+    std::unordered_map<std::string, const SchemaStruct*> aStructDict;
+
+    std::unique_ptr<SchemaStruct> pStruct;
+    std::vector<std::string> aTypeNameVect;
+
+    std::string aLine;
+    while (std::getline(aStream, aLine))
+    {
+        aLine = trim(aLine);
+
+        if (startsWith(aLine, "Chunk: "))
+        {
+            pSchema->chunks.push_back(SchemaChunk());
+            pChunk = &pSchema->chunks.back();
+            pVersion = nullptr;
+
+            pChunk->name = aLine.substr(7, aLine.find(',') - 7);
+            pChunk->magic = 0;
+            memcpy(&pChunk->magic, pChunk->name.c_str(), std::min<size_t>(pChunk->name.size(), 4));
+        }
+        else if (startsWith(aLine, "=> Version: "))
+        {
+            if (pChunk == nullptr)
+            {
+                throw exception::Exception("Version outside of a chunk in ANStructs.");
+            }
+
+            pChunk->versions.push_back(SchemaVersion());
+            pVersion = &pChunk->versions.back();
+            pVersion->version = static_cast<uint32_t>(strtoul(aLine.c_str() + 12, nullptr, 10));
+            pVersion->pRoot = nullptr;
+
+            aStructDict.clear();
+        }
+        else if (startsWith(aLine, "typedef struct"))
+        {
+            if (pVersion == nullptr)
+            {
+                throw exception::Exception("Struct outside of a version in ANStructs.");
+            }
+
+            pStruct.reset(new SchemaStruct());
+            aTypeNameVect.clear();
+        }
+        else if (pStruct && startsWith(aLine, "}"))
+        {
+            pStruct->name = trim(aLine.substr(1, aLine.find('<') - 1));
+            layoutStruct(*pStruct, aTypeNameVect, aStructDict);
+
+            aStructDict[pStruct->name] = pStruct.get();
+            pVersion->pRoot = pStruct.get();
+            pVersion->structs.push_back(std::move(pStruct));
+        }
+        else if (pStruct && !aLine.empty() && aLine != "{")
+        {
+            SchemaField aField = SchemaField();
+            std::string aTypeName;
+            parseField(aLine, aField, aTypeName);
+
+            pStruct->fields.push_back(aField);
+            aTypeNameVect.push_back(aTypeName);
+        }
+    }
+
+    return pSchema;
+}
+
+}
+}
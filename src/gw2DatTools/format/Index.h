@@ -0,0 +1,56 @@
+#ifndef GW2DATTOOLS_FORMATS_INDEX_H
+#define GW2DATTOOLS_FORMATS_INDEX_H
+
+#include <cstdint>
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Index file written by ANDatInterface::saveIndex:
+//   IndexHeader
+//   IndexSectionHeader + nbOfEntries * entrySize bytes, nbOfSections times
+// Section entries follow the order of ANDatInterface::getFileRecordVect, except
+// for DEPS which holds the dependencies of every record, DEPC giving how many
+// of them each record has. RECS keeps the records themselves, so that the index
+// can be carried over to the next version of the archive.
+// Unknown sections are skipped, so that new ones can be added without
+// changing the version.
+
+const uint32_t sIndexVersion = 1;
+
+#pragma pack(push, 1)
+struct IndexHeader
+{
+    uint8_t  magic[4];      // "GW2I"
+    uint32_t version;
+    uint64_t datFileSize;   // Identity of the archive the index was built for
+    uint64_t recordsHash;
+    uint32_t nbOfRecords;
+    uint32_t nbOfSections;
+};
+
+struct IndexSectionHeader
+{
+    uint8_t  tag[4];
+    uint32_t entrySize;
+    uint32_t nbOfEntries;
+};
+
+struct IndexRecordEntry
+{
+    uint32_t archiveIndex;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t baseId;
+    uint32_t fileId;
+    uint32_t crc;
+    uint8_t  isCompressed;
+};
+#pragma pack(pop)
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMATS_INDEX_H
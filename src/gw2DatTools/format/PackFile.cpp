@@ -0,0 +1,157 @@
+#include "gw2DatTools/format/PackFile.h"
+
+#include <cstring>
+
+#include "gw2DatTools/exception/Exception.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+GW2DATTOOLS_API std::unique_ptr<PackFile> GW2DATTOOLS_APIENTRY parsePackFile(uint32_t iInputSize, const uint8_t* iInputTab)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    if (iInputSize < sizeof(PackFileHeader) || iInputTab[0] != 'P' || iInputTab[1] != 'F')
+    {
+        throw exception::Exception("Not a PackFile.");
+    }
+
+    std::unique_ptr<PackFile> pPackFile(new PackFile());
+    pPackFile->pHeader = reinterpret_cast<const PackFileHeader*>(iInputTab);
+
+    uint32_t aChunkPos = sizeof(PackFileHeader);
+
+    // Remaining bytes smaller than a chunk header are padding
+    while (iInputSize - aChunkPos >= sizeof(PackFileChunkHeader))
+    {
+        PackFileChunkHeader aChunkHeader;
+        memcpy(&aChunkHeader, iInputTab + aChunkPos, sizeof(aChunkHeader));
+
+        // chunkSize does not count the magic and itself
+        uint64_t aChunkEnd = static_cast<uint64_t>(aChunkPos) + 8 + aChunkHeader.chunkSize;
+        if (aChunkHeader.chunkSize < sizeof(PackFileChunkHeader) - 8 || aChunkEnd > iInputSize)
+        {
+            throw exception::Exception("Chunk exceeds the buffer.");
+        }
+
+        PackFileChunk aChunk;
+        memcpy(&aChunk.magic, aChunkHeader.magic, sizeof(aChunk.magic));
+        aChunk.version = aChunkHeader.version;
+        aChunk.pointerEncoding = PE_RELATIVE;
+        aChunk.pData = iInputTab + aChunkPos + sizeof(PackFileChunkHeader);
+        aChunk.pOffsetTable = nullptr;
+        aChunk.nbOfOffsets = 0;
+
+        uint32_t aDataEnd = aChunkHeader.chunkSize - (sizeof(PackFileChunkHeader) - 8);
+
+        if (aChunkHeader.offsetToOffsetTable != 0)
+        {
+            if (aDataEnd < sizeof(uint32_t) || aChunkHeader.offsetToOffsetTable > aDataEnd - sizeof(uint32_t))
+            {
+                throw exception::Exception("Offset table exceeds the chunk.");
+            }
+
+            aChunk.dataSize = aChunkHeader.offsetToOffsetTable;
+
+            memcpy(&aChunk.nbOfOffsets, aChunk.pData + aChunk.dataSize, sizeof(uint32_t));
+            aChunk.pOffsetTable = aChunk.pData + aChunk.dataSize + sizeof(uint32_t);
+
+            if (aChunk.nbOfOffsets > (aDataEnd - aChunk.dataSize - sizeof(uint32_t)) / sizeof(uint32_t))
+            {
+                throw exception::Exception("Offset table exceeds the chunk.");
+            }
+        }
+        else
+        {
+            aChunk.dataSize = aDataEnd;
+        }
+
+        pPackFile->chunks.push_back(aChunk);
+
+        aChunkPos = static_cast<uint32_t>(aChunkEnd);
+    }
+
+    return pPackFile;
+}
+
+GW2DATTOOLS_API std::unique_ptr<PackFile> GW2DATTOOLS_APIENTRY relocatePackFile(uint32_t iInputSize, uint8_t* ioInputTab, PointerEncoding iPointerEncoding)
+{
+    if (iPointerEncoding == PE_NATIVE && sizeof(void*) != sizeof(uint32_t))
+    {
+        throw exception::Exception("Native pointers do not fit in the chunks.");
+    }
+    if (iPointerEncoding == PE_RELATIVE)
+    {
+        throw exception::Exception("Pointers can only be relocated to base indexes or native pointers.");
+    }
+
+    auto pPackFile = parsePackFile(iInputSize, ioInputTab);
+
+    for (auto itChunk = pPackFile->chunks.begin(); itChunk != pPackFile->chunks.end(); ++itChunk)
+    {
+        // pData points into ioInputTab
+        uint8_t* pData = ioInputTab + (itChunk->pData - ioInputTab);
+
+        for (uint32_t anIndex = 0; anIndex < itChunk->nbOfOffsets; ++anIndex)
+        {
+            uint32_t aPointerPos;
+            memcpy(&aPointerPos, itChunk->pOffsetTable + anIndex * sizeof(uint32_t), sizeof(aPointerPos));
+            if (itChunk->dataSize < sizeof(uint32_t) || aPointerPos > itChunk->dataSize - sizeof(uint32_t))
+            {
+                throw exception::Exception("Pointer exceeds the chunk.");
+            }
+
+            int32_t aRelativeOffset;
+            memcpy(&aRelativeOffset, pData + aPointerPos, sizeof(aRelativeOffset));
+
+            uint32_t aValue;
+            if (aRelativeOffset == 0)
+            {
+                aValue = (iPointerEncoding == PE_BASE_INDEX) ? sNullBaseIndex : 0;
+            }
+            else
+            {
+                int64_t aTargetPos = static_cast<int64_t>(aPointerPos) + aRelativeOffset;
+                if (aTargetPos < 0 || aTargetPos > itChunk->dataSize)
+                {
+                    throw exception::Exception("Pointer exceeds the chunk.");
+                }
+
+                if (iPointerEncoding == PE_BASE_INDEX)
+                {
+                    aValue = static_cast<uint32_t>(aTargetPos);
+                }
+                else
+                {
+                    aValue = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pData + aTargetPos));
+                }
+            }
+
+            memcpy(pData + aPointerPos, &aValue, sizeof(aValue));
+        }
+
+        itChunk->pointerEncoding = iPointerEncoding;
+    }
+
+    return pPackFile;
+}
+
+GW2DATTOOLS_API const PackFileChunk* GW2DATTOOLS_APIENTRY findPackFileChunk(const PackFile& iPackFile, uint32_t iMagic)
+{
+    for (auto it = iPackFile.chunks.begin(); it != iPackFile.chunks.end(); ++it)
+    {
+        if (it->magic == iMagic)
+        {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
+}
+}
@@ -0,0 +1,96 @@
+#ifndef GW2DATTOOLS_FORMATS_SCHEMAWALK_H
+#define GW2DATTOOLS_FORMATS_SCHEMAWALK_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "gw2DatTools/format/ANStructsSchema.h"
+#include "gw2DatTools/format/StructView.h"
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Size of an element of the field, 0 for unsized structs
+inline uint32_t getFieldElementSize(const SchemaField& iField)
+{
+    if (iField.valueType == SVT_STRUCT)
+    {
+        return iField.pStruct->isSized ? iField.pStruct->size : 0;
+    }
+    return getSchemaValueSize(iField.valueType);
+}
+
+// Calls iVisitor(pElementPos) for every element of a located field of the struct at ipStructPos:
+// each of the nbOfElements inline values, or what the pointers lead to. Null pointers are skipped.
+// Fields holding several elements next to each other shall have a sized element.
+template <typename Visitor>
+void forEachFieldElement(const ChunkSpan& iSpan, const uint8_t* ipStructPos, const SchemaField& iField, Visitor iVisitor)
+{
+    uint32_t anElementSize = getFieldElementSize(iField);
+    const uint8_t* pFieldPos = ipStructPos + iField.offset;
+
+    for (uint32_t anElementIndex = 0; anElementIndex < iField.nbOfElements; ++anElementIndex)
+    {
+        switch (iField.encoding)
+        {
+        case SE_INLINE:
+            iVisitor(pFieldPos + anElementIndex * anElementSize);
+            break;
+
+        case SE_PTR:
+        {
+            const uint8_t* pTarget = iSpan.follow(pFieldPos + anElementIndex * sizeof(uint32_t));
+            if (pTarget != nullptr)
+            {
+                iVisitor(pTarget);
+            }
+            break;
+        }
+
+        case SE_ARRAY_PTR:
+        case SE_PTR_ARRAY_PTR:
+        {
+            const uint8_t* pArrayPos = pFieldPos + anElementIndex * 2 * sizeof(uint32_t);
+            iSpan.check(pArrayPos, 2 * sizeof(uint32_t));
+
+            uint32_t aCount;
+            memcpy(&aCount, pArrayPos, sizeof(aCount));
+
+            const uint8_t* pTarget = iSpan.follow(pArrayPos + sizeof(uint32_t));
+            if (pTarget == nullptr)
+            {
+                break;
+            }
+
+            if (iField.encoding == SE_ARRAY_PTR)
+            {
+                iSpan.check(pTarget, static_cast<uint64_t>(aCount) * anElementSize);
+                for (uint32_t anIndex = 0; anIndex < aCount; ++anIndex)
+                {
+                    iVisitor(pTarget + anIndex * anElementSize);
+                }
+            }
+            else
+            {
+                iSpan.check(pTarget, static_cast<uint64_t>(aCount) * sizeof(uint32_t));
+                for (uint32_t anIndex = 0; anIndex < aCount; ++anIndex)
+                {
+                    const uint8_t* pElement = iSpan.follow(pTarget + anIndex * sizeof(uint32_t));
+                    if (pElement != nullptr)
+                    {
+                        iVisitor(pElement);
+                    }
+                }
+            }
+            break;
+        }
+        }
+    }
+}
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMATS_SCHEMAWALK_H
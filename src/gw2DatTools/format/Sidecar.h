@@ -0,0 +1,43 @@
+#ifndef GW2DATTOOLS_FORMATS_SIDECAR_H
+#define GW2DATTOOLS_FORMATS_SIDECAR_H
+
+#include <cstdint>
+
+namespace gw2dt
+{
+namespace format
+{
+
+// Sidecar file written by ANDatInterface::saveSidecar:
+//   SidecarHeader
+//   SidecarEntry, nbOfEntries times, sorted by fileId
+//   Inflated content of the compressed records, each one starting on a multiple of alignment
+// The archive it was written for is identified as in IndexHeader. Entries and contents
+// are aligned so that the file can be mapped and its records read in place.
+
+const uint32_t sSidecarVersion = 1;
+const uint32_t sSidecarAlignment = 64;
+
+#pragma pack(push, 1)
+struct SidecarHeader
+{
+    uint8_t  magic[4];      // "GW2S"
+    uint32_t version;
+    uint64_t datFileSize;
+    uint64_t recordsHash;
+    uint32_t nbOfEntries;
+    uint32_t alignment;
+};
+
+struct SidecarEntry
+{
+    uint32_t fileId;
+    uint32_t size;          // Inflated
+    uint64_t offset;        // From the start of the file
+};
+#pragma pack(pop)
+
+}
+}
+
+#endif // GW2DATTOOLS_FORMATS_SIDECAR_H
@@ -0,0 +1,410 @@
+#include "gw2DatTools/interface/ANDatCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+#include "gw2DatTools/exception/Exception.h"
+#include "gw2DatTools/compression/inflateDatFileBuffer.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+class ANDatCacheImpl : public ANDatCache
+{
+public:
+    ANDatCacheImpl(ANDatInterface& iANDatInterface, uint64_t iBudgetBytes);
+    virtual ~ANDatCacheImpl();
+
+    virtual Buffer getBuffer(const ANDatInterface::FileRecord& iFileRecord);
+    virtual Buffer getInflatedBuffer(const ANDatInterface::FileRecord& iFileRecord);
+
+    virtual void prefetch(const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect);
+
+    virtual void invalidate(const std::vector<uint32_t>& iFileIdVect);
+
+    virtual void clear();
+
+    virtual Stats getStats() const;
+
+private:
+    static const uint32_t sNbOfShards = 16;
+
+    enum Tier
+    {
+        T_RAW = 0,
+        T_INFLATED = 1
+    };
+
+    // Location and CRC of the record rather than its fileId: the same fileId is held
+    // by several archives of an overlay, and a reload may move or rewrite a record.
+    struct Key
+    {
+        uint64_t offset;
+        uint32_t archiveIndex;
+        uint32_t size;
+        uint32_t crc;
+        uint32_t tier;
+
+        bool operator==(const Key& iOther) const;
+        bool operator<(const Key& iOther) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& iKey) const;
+    };
+
+    typedef std::set<std::pair<double, Key>> PriorityQueue;
+
+    struct Entry
+    {
+        uint32_t fileId;                   // For invalidate
+        Buffer buffer;
+        double cost;                       // Microseconds needed to get the buffer back
+        PriorityQueue::iterator itPriority;
+    };
+
+    // Greedy-Dual-Size: an entry is worth inflation + cost / size, the cheapest
+    // one is evicted and the inflation is raised to its value, so that entries
+    // which are not accessed anymore age.
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> entryDict;
+        PriorityQueue priorityQueue;
+        double inflation;
+        uint64_t usedBytes;
+    };
+
+    static Key makeKey(const ANDatInterface::FileRecord& iFileRecord, Tier iTier);
+    Shard& getShard(uint32_t iFileId);
+
+    Buffer find(const ANDatInterface::FileRecord& iFileRecord, Tier iTier);
+    void insert(const ANDatInterface::FileRecord& iFileRecord, Tier iTier, const Buffer& iBuffer, double iCost);
+
+    ANDatInterface& _ANDatInterface;
+
+    uint64_t _budgetBytes;
+    uint64_t _shardBudgetBytes;
+    Shard _shardTab[sNbOfShards];
+
+    std::atomic<uint64_t> _rawHits;
+    std::atomic<uint64_t> _rawMisses;
+    std::atomic<uint64_t> _inflatedHits;
+    std::atomic<uint64_t> _inflatedMisses;
+    std::atomic<uint64_t> _evictions;
+};
+
+// Elapsed time since iStart in microseconds, at least 1 so that every entry has a cost
+double getElapsedMicroseconds(const std::chrono::steady_clock::time_point& iStart)
+{
+    auto aDuration = std::chrono::steady_clock::now() - iStart;
+    return std::max(1.0, std::chrono::duration<double, std::micro>(aDuration).count());
+}
+
+ANDatCacheImpl::ANDatCacheImpl(ANDatInterface& iANDatInterface, uint64_t iBudgetBytes) :
+    _ANDatInterface(iANDatInterface),
+    _budgetBytes(iBudgetBytes),
+    _shardBudgetBytes(iBudgetBytes / sNbOfShards),
+    _rawHits(0),
+    _rawMisses(0),
+    _inflatedHits(0),
+    _inflatedMisses(0),
+    _evictions(0)
+{
+    for (uint32_t aShardIndex = 0; aShardIndex < sNbOfShards; ++aShardIndex)
+    {
+        _shardTab[aShardIndex].inflation = 0.0;
+        _shardTab[aShardIndex].usedBytes = 0;
+    }
+}
+
+ANDatCacheImpl::~ANDatCacheImpl()
+{
+}
+
+bool ANDatCacheImpl::Key::operator==(const Key& iOther) const
+{
+    return offset == iOther.offset && archiveIndex == iOther.archiveIndex && size == iOther.size
+        && crc == iOther.crc && tier == iOther.tier;
+}
+
+bool ANDatCacheImpl::Key::operator<(const Key& iOther) const
+{
+    return std::tie(offset, archiveIndex, size, crc, tier) < std::tie(iOther.offset, iOther.archiveIndex, iOther.size, iOther.crc, iOther.tier);
+}
+
+size_t ANDatCacheImpl::KeyHash::operator()(const Key& iKey) const
+{
+    // Offsets are unique within an archive, the other fields only tell apart stale entries
+    uint64_t aHash = iKey.offset ^ (static_cast<uint64_t>(iKey.archiveIndex) << 48);
+    aHash = (aHash ^ iKey.crc ^ (static_cast<uint64_t>(iKey.size) << 32)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>((aHash >> 32) ^ aHash ^ iKey.tier);
+}
+
+ANDatCacheImpl::Key ANDatCacheImpl::makeKey(const ANDatInterface::FileRecord& iFileRecord, Tier iTier)
+{
+    Key aKey;
+    aKey.offset = iFileRecord.offset;
+    aKey.archiveIndex = iFileRecord.archiveIndex;
+    aKey.size = iFileRecord.size;
+    aKey.crc = iFileRecord.crc;
+    aKey.tier = iTier;
+    return aKey;
+}
+
+ANDatCacheImpl::Shard& ANDatCacheImpl::getShard(uint32_t iFileId)
+{
+    // FileIds are mostly contiguous, mixing them so that neighbours land in different shards.
+    // All the entries of a fileId land in the same shard, whatever their archive.
+    return _shardTab[((iFileId * 2654435761u) >> 16) % sNbOfShards];
+}
+
+ANDatCache::Buffer ANDatCacheImpl::find(const ANDatInterface::FileRecord& iFileRecord, Tier iTier)
+{
+    Shard& aShard = getShard(iFileRecord.fileId);
+    std::lock_guard<std::mutex> aLock(aShard.mutex);
+
+    auto it = aShard.entryDict.find(makeKey(iFileRecord, iTier));
+    if (it == aShard.entryDict.end())
+    {
+        return Buffer();
+    }
+
+    // Refreshing the value of the entry
+    Entry& anEntry = it->second;
+    aShard.priorityQueue.erase(anEntry.itPriority);
+    double aPriority = aShard.inflation + anEntry.cost / std::max<size_t>(anEntry.buffer->size(), 1);
+    anEntry.itPriority = aShard.priorityQueue.insert(std::make_pair(aPriority, it->first)).first;
+
+    return anEntry.buffer;
+}
+
+void ANDatCacheImpl::insert(const ANDatInterface::FileRecord& iFileRecord, Tier iTier, const Buffer& iBuffer, double iCost)
+{
+    uint64_t aSize = iBuffer->size();
+    if (aSize > _shardBudgetBytes)
+    {
+        return;
+    }
+
+    Shard& aShard = getShard(iFileRecord.fileId);
+    std::lock_guard<std::mutex> aLock(aShard.mutex);
+
+    Key aKey = makeKey(iFileRecord, iTier);
+    if (aShard.entryDict.find(aKey) != aShard.entryDict.end())
+    {
+        return; // Another thread was faster
+    }
+
+    // Making room
+    while (aShard.usedBytes + aSize > _shardBudgetBytes)
+    {
+        auto itVictim = aShard.priorityQueue.begin();
+        aShard.inflation = itVictim->first;
+
+        auto itEntry = aShard.entryDict.find(itVictim->second);
+        aShard.usedBytes -= itEntry->second.buffer->size();
+        aShard.entryDict.erase(itEntry);
+        aShard.priorityQueue.erase(itVictim);
+
+        ++_evictions;
+    }
+
+    Entry& anEntry = aShard.entryDict[aKey];
+    anEntry.fileId = iFileRecord.fileId;
+    anEntry.buffer = iBuffer;
+    anEntry.cost = iCost;
+
+    double aPriority = aShard.inflation + iCost / std::max<uint64_t>(aSize, 1);
+    anEntry.itPriority = aShard.priorityQueue.insert(std::make_pair(aPriority, aKey)).first;
+
+    aShard.usedBytes += aSize;
+}
+
+ANDatCache::Buffer ANDatCacheImpl::getBuffer(const ANDatInterface::FileRecord& iFileRecord)
+{
+    Buffer aBuffer = find(iFileRecord, T_RAW);
+    if (aBuffer)
+    {
+        ++_rawHits;
+        return aBuffer;
+    }
+    ++_rawMisses;
+
+    auto aStart = std::chrono::steady_clock::now();
+
+    std::shared_ptr<std::vector<uint8_t>> pBuffer(new std::vector<uint8_t>(iFileRecord.size));
+    uint32_t aSize = iFileRecord.size;
+    _ANDatInterface.getBuffer(iFileRecord, aSize, pBuffer->data());
+    pBuffer->resize(aSize);
+
+    aBuffer = pBuffer;
+    insert(iFileRecord, T_RAW, aBuffer, getElapsedMicroseconds(aStart));
+
+    return aBuffer;
+}
+
+ANDatCache::Buffer ANDatCacheImpl::getInflatedBuffer(const ANDatInterface::FileRecord& iFileRecord)
+{
+    if (!iFileRecord.isCompressed)
+    {
+        return getBuffer(iFileRecord);
+    }
+
+    Buffer aBuffer = find(iFileRecord, T_INFLATED);
+    if (aBuffer)
+    {
+        ++_inflatedHits;
+        return aBuffer;
+    }
+    ++_inflatedMisses;
+
+    // Read as is from the sidecar, the raw tier is not needed
+    if (_ANDatInterface.isInSidecar(iFileRecord))
+    {
+        auto aStart = std::chrono::steady_clock::now();
+
+        std::shared_ptr<std::vector<uint8_t>> pBuffer(new std::vector<uint8_t>());
+        _ANDatInterface.getInflatedBuffer(iFileRecord, *pBuffer);
+
+        aBuffer = pBuffer;
+        insert(iFileRecord, T_INFLATED, aBuffer, getElapsedMicroseconds(aStart));
+
+        return aBuffer;
+    }
+
+    Buffer aRawBuffer = getBuffer(iFileRecord);
+
+    auto aStart = std::chrono::steady_clock::now();
+
+    // Size of the uncompressed data is the second uint32 of the header
+    if (aRawBuffer->size() < 2 * sizeof(uint32_t))
+    {
+        throw exception::Exception("Compressed buffer is too small.");
+    }
+
+    uint32_t anOutputSize;
+    memcpy(&anOutputSize, aRawBuffer->data() + sizeof(uint32_t), sizeof(uint32_t));
+
+    std::shared_ptr<std::vector<uint8_t>> pBuffer(new std::vector<uint8_t>(anOutputSize));
+    if (anOutputSize != 0)
+    {
+        compression::inflateDatFileBuffer(static_cast<uint32_t>(aRawBuffer->size()), aRawBuffer->data(), anOutputSize, pBuffer->data());
+    }
+    pBuffer->resize(anOutputSize);
+
+    aBuffer = pBuffer;
+    insert(iFileRecord, T_INFLATED, aBuffer, getElapsedMicroseconds(aStart));
+
+    return aBuffer;
+}
+
+void ANDatCacheImpl::prefetch(const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect)
+{
+    // Not counted in the stats, as nobody asked for the records yet
+    for (auto it = iFileRecordPtrVect.begin(); it != iFileRecordPtrVect.end(); ++it)
+    {
+        const ANDatInterface::FileRecord& aFileRecord = **it;
+        if (find(aFileRecord, T_RAW))
+        {
+            continue;
+        }
+
+        auto aStart = std::chrono::steady_clock::now();
+
+        std::shared_ptr<std::vector<uint8_t>> pBuffer(new std::vector<uint8_t>(aFileRecord.size));
+        uint32_t aSize = aFileRecord.size;
+        _ANDatInterface.getBuffer(aFileRecord, aSize, pBuffer->data());
+        pBuffer->resize(aSize);
+
+        insert(aFileRecord, T_RAW, pBuffer, getElapsedMicroseconds(aStart));
+    }
+}
+
+void ANDatCacheImpl::invalidate(const std::vector<uint32_t>& iFileIdVect)
+{
+    // Entries are keyed on location, grouping the fileIds by shard and sweeping each shard once
+    std::vector<std::set<uint32_t>> aFileIdSetVect(sNbOfShards);
+    for (auto itFileId = iFileIdVect.begin(); itFileId != iFileIdVect.end(); ++itFileId)
+    {
+        aFileIdSetVect[&getShard(*itFileId) - _shardTab].insert(*itFileId);
+    }
+
+    for (uint32_t aShardIndex = 0; aShardIndex < sNbOfShards; ++aShardIndex)
+    {
+        const std::set<uint32_t>& aFileIdSet = aFileIdSetVect[aShardIndex];
+        if (aFileIdSet.empty())
+        {
+            continue;
+        }
+
+        Shard& aShard = _shardTab[aShardIndex];
+        std::lock_guard<std::mutex> aLock(aShard.mutex);
+
+        for (auto it = aShard.entryDict.begin(); it != aShard.entryDict.end();)
+        {
+            if (aFileIdSet.find(it->second.fileId) != aFileIdSet.end())
+            {
+                aShard.usedBytes -= it->second.buffer->size();
+                aShard.priorityQueue.erase(it->second.itPriority);
+                it = aShard.entryDict.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+}
+
+void ANDatCacheImpl::clear()
+{
+    for (uint32_t aShardIndex = 0; aShardIndex < sNbOfShards; ++aShardIndex)
+    {
+        Shard& aShard = _shardTab[aShardIndex];
+        std::lock_guard<std::mutex> aLock(aShard.mutex);
+
+        aShard.entryDict.clear();
+        aShard.priorityQueue.clear();
+        aShard.inflation = 0.0;
+        aShard.usedBytes = 0;
+    }
+}
+
+ANDatCache::Stats ANDatCacheImpl::getStats() const
+{
+    Stats aStats;
+    aStats.rawHits = _rawHits;
+    aStats.rawMisses = _rawMisses;
+    aStats.inflatedHits = _inflatedHits;
+    aStats.inflatedMisses = _inflatedMisses;
+    aStats.evictions = _evictions;
+    aStats.budgetBytes = _budgetBytes;
+
+    aStats.usedBytes = 0;
+    for (uint32_t aShardIndex = 0; aShardIndex < sNbOfShards; ++aShardIndex)
+    {
+        const Shard& aShard = _shardTab[aShardIndex];
+        std::lock_guard<std::mutex> aLock(aShard.mutex);
+        aStats.usedBytes += aShard.usedBytes;
+    }
+
+    return aStats;
+}
+
+GW2DATTOOLS_API std::unique_ptr<ANDatCache> GW2DATTOOLS_APIENTRY createANDatCache(ANDatInterface& iANDatInterface, uint64_t iBudgetBytes)
+{
+    return std::unique_ptr<ANDatCache>(new ANDatCacheImpl(iANDatInterface, iBudgetBytes));
+}
+
+}
+}
@@ -1,127 +1,1734 @@
 #include "gw2DatTools/interface/ANDatInterface.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "gw2DatTools/exception/Exception.h"
+#include "gw2DatTools/compression/inflateDatFileBuffer.h"
+#include "gw2DatTools/interface/ArchiveDiff.h"
 
 #include "../format/ANDat.h"
 #include "../format/Mft.h"
 #include "../format/Mapping.h"
+#include "../format/Index.h"
+#include "../format/Sidecar.h"
 #include "../format/Utils.h"
+#include "FileReferenceFinder.h"
+#include "RecordScanner.h"
 
 namespace gw2dt
 {
 namespace interface
 {
 
+// One archive of a snapshot
+struct ANDatArchive
+{
+    // Opens the archive and reads its header and MFT, throws if they cannot be read
+    void open(const char* iDatPath);
+    // True if both were read from the same version of the archive
+    bool isSameVersion(const ANDatArchive& iArchive) const;
+    // Reads the mapping and builds the records of the archive
+    void computeFileRecords(uint32_t iArchiveIndex, std::vector<ANDatInterface::FileRecord>& oFileRecordVect);
+    // Reads iSize bytes at iOffset, returns false if they cannot be read. Can be called from any thread.
+    bool read(uint64_t iOffset, uint32_t iSize, uint8_t* oTab);
+
+    // Shared by every reader of the archive, getBuffer and the passes computing the data of the records
+    // included, whatever the snapshot they read: each seek and read is done under streamMutex.
+    std::ifstream datStream;
+    std::mutex streamMutex;
+    uint64_t datFileSize;
+
+    // Raw data structures
+    std::unique_ptr<format::ANDat> pANDat;
+    std::unique_ptr<format::Mft> pMft;
+    std::unique_ptr<format::Mapping> pMapping;
+};
+
+// Sidecar written for one version of the archives, see ANDatInterface::saveSidecar
+struct ANDatSidecar
+{
+    // Returns false if the file is missing, broken, or was not written for the archives iIndexHeader was filled for
+    bool open(const char* iSidecarPath, const format::IndexHeader& iIndexHeader);
+    // nullptr if the sidecar does not hold the file
+    const format::SidecarEntry* findEntry(uint32_t iFileId) const;
+    // Reads the content of the entry, returns false if it cannot be read. Can be called from any thread.
+    bool read(const format::SidecarEntry& iEntry, std::vector<uint8_t>& oBuffer);
+
+    std::ifstream sidecarStream;
+    std::mutex streamMutex;
+    std::vector<format::SidecarEntry> entryVect;    // Sorted by fileId
+};
+
+// Dependencies of record i are dependencyVect[dependencyOffsetVect[i] .. dependencyOffsetVect[i + 1]),
+// as indexes in the records. Both are empty until the dependencies are computed.
+struct ANDatDependencyGraph
+{
+    std::vector<uint32_t> dependencyOffsetVect;
+    std::vector<uint32_t> dependencyVect;
+};
+
+// Indexes of the records by id, they do not depend on the computed data of the records
+struct ANDatIdDicts
+{
+    std::unordered_map<uint32_t, uint32_t> fileIdDict;
+    std::unordered_map<uint32_t, uint32_t> baseIdDict;
+};
+
+// Records of one version of the archives. Once published, a snapshot does not change anymore but for its attached
+// sidecar: the computed data of the records is changed in a copy of it, which is published in turn. A copy shares
+// the data structures of its snapshot, and only replaces those it changes: the records, whose computed data is
+// set in a copy of them, or the dependency graph, which is built again as a whole.
+struct ANDatSnapshot
+{
+    // Opens the archives, by decreasing priority, throws if one of them cannot be read
+    void open(const std::vector<std::string>& iDatPathVect);
+    // Reads the mappings and builds the records, a fileId is served by the first archive holding it
+    void computeInternalData();
+    // Shares the data structures of iSnapshot, nothing is copied
+    void copyInternalData(const ANDatSnapshot& iSnapshot);
+
+    const std::vector<ANDatInterface::FileRecord>& getFileRecordVect() const;
+    // Records whose computed data is to be changed, they are copied first if they are shared with another snapshot
+    std::vector<ANDatInterface::FileRecord>& changeFileRecordVect();
+
+    // True if both snapshots were read from the same versions of the archives
+    bool isSameVersion(const ANDatSnapshot& iSnapshot) const;
+
+    void fillIndexHeader(format::IndexHeader& oIndexHeader) const;
+
+    bool hasRecord(const ANDatInterface::FileRecord& iFileRecord) const;
+    // Index of the record in the records, it may also come from one of the previous snapshots this one
+    // is a copy of. Throws if it is none of them.
+    uint32_t getRecordIndex(const ANDatInterface::FileRecord& iFileRecord) const;
+    // Index of the record with the given file or base id, the number of records if there is none
+    uint32_t findRecordIndex(uint32_t iId) const;
+
+    // Archive holding the record
+    ANDatArchive& getArchive(const ANDatInterface::FileRecord& iFileRecord);
+    // Entry of the record in the attached sidecar, nullptr if there is none or it does not hold the record
+    const format::SidecarEntry* findSidecarEntry(const ANDatInterface::FileRecord& iFileRecord) const;
+
+    // Shared with the copies of the snapshot
+    std::vector<std::shared_ptr<ANDatArchive>> archiveVect;
+
+    // Helper data structures, shared with every copy of the snapshot
+    std::shared_ptr<const ANDatIdDicts> pIdDicts;
+
+    // Computed data structures, shared with the copies of the snapshot until they are replaced
+    std::shared_ptr<std::vector<ANDatInterface::FileRecord>> pFileRecordVect;
+    bool isFileRecordVectShared;
+    std::shared_ptr<const ANDatDependencyGraph> pDependencyGraph;
+
+    // Snapshot this one replaced, until it is released
+    std::atomic<ANDatSnapshot*> pPreviousSnapshot;
+
+    // Attached sidecar, read without lock. Sidecars are owned by sidecarVect, the attached one last.
+    std::atomic<ANDatSidecar*> pSidecar;
+    std::vector<std::shared_ptr<ANDatSidecar>> sidecarVect;
+};
+
 class ANDatInterfaceImpl : public ANDatInterface
 {
-public:
-    ANDatInterfaceImpl(const char* iDatPath, std::unique_ptr<format::Mft>& ipMft, std::unique_ptr<format::Mapping>& ipMapping);
-    virtual ~ANDatInterfaceImpl();
+public:
+    explicit ANDatInterfaceImpl(const std::vector<std::string>& iDatPathVect);
+    virtual ~ANDatInterfaceImpl();
+
+    virtual void getBuffer(const ANDatInterface::FileRecord& iFileRecord, uint32_t& ioOutputSize, uint8_t* ioBuffer);
+
+    virtual const FileRecord& getFileRecordForFileId(const uint32_t& iFileId) const;
+    virtual const FileRecord& getFileRecordForBaseId(const uint32_t& iBaseId) const;
+
+    virtual const std::vector<FileRecord>& getFileRecordVect() const;
+
+    virtual void computeUncompressedSizes();
+
+    virtual void classifyFileRecords(uint32_t iNbOfThreads);
+    virtual void classifyFileRecords(const std::vector<const FileRecord*>& iFileRecordPtrVect, uint32_t iNbOfThreads);
+
+    virtual void computeDependencies(const format::ANStructsSchema& iSchema, uint32_t iNbOfThreads);
+    virtual void computeDependencies(const format::ANStructsSchema& iSchema, const std::vector<const FileRecord*>& iFileRecordPtrVect,
+                                     uint32_t iNbOfThreads);
+    virtual std::vector<const FileRecord*> getDependencies(const FileRecord& iFileRecord) const;
+    virtual std::vector<const FileRecord*> getDependencyClosure(const FileRecord& iFileRecord) const;
+
+    virtual void saveIndex(const char* iIndexPath) const;
+    virtual bool loadIndex(const char* iIndexPath);
+    virtual bool loadPreviousIndex(const char* iIndexPath, ArchiveDiff& oArchiveDiff);
+
+    virtual void saveSidecar(const char* iSidecarPath, uint32_t iNbOfThreads);
+    virtual bool attachSidecar(const char* iSidecarPath);
+    virtual bool isInSidecar(const FileRecord& iFileRecord) const;
+    virtual void getInflatedBuffer(const FileRecord& iFileRecord, std::vector<uint8_t>& oBuffer);
+
+    virtual bool reload(ArchiveDiff& oArchiveDiff);
+    virtual void startAutoReload(uint32_t iPeriodMs, const ReloadCallback& iCallback);
+    virtual void stopAutoReload();
+    virtual void releaseRetiredSnapshots();
+
+private:
+    // Maximum span read at once when gathering the headers of neighbouring records
+    static const uint32_t sHeaderReadWindowSize = 1024 * 1024;
+    // Number of records read before their classification is dispatched to the threads
+    static const uint32_t sClassificationBatchSize = 4096;
+
+    // Read side of the snapshot swap: the read is counted in the current epoch before the snapshot is
+    // loaded, so that a retired snapshot is only freed once the reads which may have loaded it are over.
+    // Readers never wait.
+    class ReadSection
+    {
+    public:
+        explicit ReadSection(const ANDatInterfaceImpl& iANDatInterface);
+        ~ReadSection();
+
+        ANDatSnapshot& getSnapshot() const;
+        // Snapshot holding the record, the published one if none does
+        ANDatSnapshot& getSnapshot(const FileRecord& iFileRecord) const;
+
+    private:
+        std::atomic<uint32_t>& _nbOfReaders;
+        ANDatSnapshot* _pSnapshot;
+    };
+
+    // Waits for the reads which may have loaded a snapshot published before the call
+    void waitForReaders();
+
+    // Both called with _updateMutex locked. The computed data of the records is changed in a copy of the
+    // published snapshot, readers pick it once it is published and the published one is retired.
+    std::unique_ptr<ANDatSnapshot> copyPublishedSnapshot() const;
+    void publishSnapshot(std::unique_ptr<ANDatSnapshot> ipSnapshot);
+
+    // Classifies the records, empty ones are not in the vector
+    void classifyRecords(ANDatSnapshot& ioSnapshot, std::vector<FileRecord*>& ioFileRecordPtrVect, uint32_t iNbOfThreads);
+
+    // Computes the dependencies of the records of iRecordIndexVect again, keeping those of the others
+    void updateDependencies(ANDatSnapshot& ioSnapshot, const format::ANStructsSchema& iSchema, const std::vector<uint32_t>& iRecordIndexVect,
+                            uint32_t iNbOfThreads);
+
+    void runAutoReload(uint32_t iPeriodMs, ReloadCallback iCallback);
+
+    std::vector<std::string> _datPathVect;   // By decreasing priority
+    std::string _sidecarPath;                // Attached again to the new versions, empty if none
+
+    // Published snapshot, read without lock
+    std::atomic<ANDatSnapshot*> _pSnapshot;
+    mutable std::atomic<uint32_t> _readEpoch;
+    mutable std::atomic<uint32_t> _nbOfReadersTab[2];   // Per parity of the epoch
+
+    // Serializes the functions modifying the snapshots, which are owned by _snapshotVect, the published one last
+    std::mutex _updateMutex;
+    std::vector<std::unique_ptr<ANDatSnapshot>> _snapshotVect;
+
+    std::thread _autoReloadThread;
+    std::mutex _autoReloadMutex;
+    std::condition_variable _autoReloadCondition;
+    bool _isAutoReloadStopping;
+};
+
+ANDatInterfaceImpl::ReadSection::ReadSection(const ANDatInterfaceImpl& iANDatInterface) :
+    _nbOfReaders(iANDatInterface._nbOfReadersTab[iANDatInterface._readEpoch.load() & 1])
+{
+    ++_nbOfReaders;
+    _pSnapshot = iANDatInterface._pSnapshot.load();
+}
+
+ANDatInterfaceImpl::ReadSection::~ReadSection()
+{
+    --_nbOfReaders;
+}
+
+ANDatSnapshot& ANDatInterfaceImpl::ReadSection::getSnapshot() const
+{
+    return *_pSnapshot;
+}
+
+ANDatSnapshot& ANDatInterfaceImpl::ReadSection::getSnapshot(const FileRecord& iFileRecord) const
+{
+    // Records returned before a new version was published are read from the version they come from
+    for (ANDatSnapshot* pSnapshot = _pSnapshot; pSnapshot != nullptr; pSnapshot = pSnapshot->pPreviousSnapshot)
+    {
+        if (pSnapshot->hasRecord(iFileRecord))
+        {
+            return *pSnapshot;
+        }
+    }
+    return *_pSnapshot;
+}
+
+ANDatInterfaceImpl::ANDatInterfaceImpl(const std::vector<std::string>& iDatPathVect) :
+    _datPathVect(iDatPathVect),
+    _pSnapshot(nullptr),
+    _readEpoch(0),
+    _isAutoReloadStopping(false)
+{
+    _nbOfReadersTab[0] = 0;
+    _nbOfReadersTab[1] = 0;
+
+    std::unique_ptr<ANDatSnapshot> pSnapshot(new ANDatSnapshot());
+    pSnapshot->pPreviousSnapshot = nullptr;
+    pSnapshot->pSidecar = nullptr;
+    pSnapshot->open(iDatPathVect);
+    pSnapshot->computeInternalData();
+
+    _pSnapshot = pSnapshot.get();
+    _snapshotVect.push_back(std::move(pSnapshot));
+}
+
+ANDatInterfaceImpl::~ANDatInterfaceImpl()
+{
+    stopAutoReload();
+}
+
+void ANDatInterfaceImpl::waitForReaders()
+{
+    // A reader may have picked the epoch before an earlier flip, both parities are drained in turn
+    for (uint32_t aPass = 0; aPass < 2; ++aPass)
+    {
+        uint32_t anEpoch = _readEpoch++;
+        while (_nbOfReadersTab[anEpoch & 1] != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+std::unique_ptr<ANDatSnapshot> ANDatInterfaceImpl::copyPublishedSnapshot() const
+{
+    std::unique_ptr<ANDatSnapshot> pSnapshot(new ANDatSnapshot());
+    pSnapshot->pPreviousSnapshot = _pSnapshot.load();
+    pSnapshot->pSidecar = nullptr;
+    pSnapshot->copyInternalData(*_pSnapshot);
+    return pSnapshot;
+}
+
+void ANDatInterfaceImpl::publishSnapshot(std::unique_ptr<ANDatSnapshot> ipSnapshot)
+{
+    // Readers pick the new snapshot from now on, the current one is retired
+    _pSnapshot = ipSnapshot.get();
+    _snapshotVect.push_back(std::move(ipSnapshot));
+}
+
+void ANDatInterfaceImpl::getBuffer(const ANDatInterface::FileRecord& iFileRecord, uint32_t& ioOutputSize, uint8_t* ioBuffer)
+{
+    ReadSection aReadSection(*this);
+    ANDatSnapshot& aSnapshot = aReadSection.getSnapshot(iFileRecord);
+
+    ioOutputSize = std::min(ioOutputSize, iFileRecord.size);
+    aSnapshot.getArchive(iFileRecord).read(iFileRecord.offset, ioOutputSize, ioBuffer);
+}
+
+const ANDatInterface::FileRecord& ANDatInterfaceImpl::getFileRecordForFileId(const uint32_t& iFileId) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot();
+
+    auto it = aSnapshot.pIdDicts->fileIdDict.find(iFileId);
+    if (it != aSnapshot.pIdDicts->fileIdDict.end())
+    {
+        return aSnapshot.getFileRecordVect()[it->second];
+    }
+    else
+    {
+        throw exception::Exception("FileId not found.");
+    }
+}
+
+const ANDatInterface::FileRecord& ANDatInterfaceImpl::getFileRecordForBaseId(const uint32_t& iBaseId) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot();
+
+    auto it = aSnapshot.pIdDicts->baseIdDict.find(iBaseId);
+    if (it != aSnapshot.pIdDicts->baseIdDict.end())
+    {
+        return aSnapshot.getFileRecordVect()[it->second];
+    }
+    else
+    {
+        throw exception::Exception("BaseId not found.");
+    }
+}
+
+const std::vector<ANDatInterface::FileRecord>& ANDatInterfaceImpl::getFileRecordVect() const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot();
+
+    return aSnapshot.getFileRecordVect();
+}
+
+void ANDatInterfaceImpl::computeUncompressedSizes()
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+    ANDatSnapshot& aSnapshot = *pSnapshot;
+    std::vector<FileRecord>& aFileRecordVect = aSnapshot.changeFileRecordVect();
+
+    const uint32_t aHeaderSize = 2 * sizeof(uint32_t);
+
+    // Visiting the records in offset order, so that the disk is read forward only
+    std::vector<FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(aFileRecordVect.size());
+
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (it->isCompressed && it->size >= aHeaderSize)
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+    }
+
+    std::sort(aFileRecordPtrVect.begin(), aFileRecordPtrVect.end(),
+        [](const FileRecord* ipLeft, const FileRecord* ipRight) { return isStoredBefore(*ipLeft, *ipRight); });
+
+    std::vector<uint8_t> aWindow;
+
+    auto itFirst = aFileRecordPtrVect.begin();
+    while (itFirst != aFileRecordPtrVect.end())
+    {
+        // Gathering the records whose header lies in the same window of the same archive
+        uint64_t aWindowStart = (*itFirst)->offset;
+        auto itLast = itFirst + 1;
+        while (itLast != aFileRecordPtrVect.end() && (*itLast)->archiveIndex == (*itFirst)->archiveIndex
+            && (*itLast)->offset + aHeaderSize <= aWindowStart + sHeaderReadWindowSize)
+        {
+            ++itLast;
+        }
+
+        uint32_t aWindowSize = static_cast<uint32_t>((*(itLast - 1))->offset + aHeaderSize - aWindowStart);
+        aWindow.resize(aWindowSize);
+
+        if (!aSnapshot.getArchive(**itFirst).read(aWindowStart, aWindowSize, aWindow.data()))
+        {
+            throw exception::Exception("Could not read the header of a record.");
+        }
+
+        for (auto it = itFirst; it != itLast; ++it)
+        {
+            // Size of the uncompressed data is the second uint32 of the header
+            memcpy(&(*it)->uncompressedSize, aWindow.data() + ((*it)->offset - aWindowStart) + sizeof(uint32_t), sizeof(uint32_t));
+        }
+
+        itFirst = itLast;
+    }
+
+    publishSnapshot(std::move(pSnapshot));
+}
+
+// Number of inflated bytes looked at to classify a record
+const uint32_t sClassificationPrefixSize = 64;
+// Compressed bytes read to get them, the whole record is read if it is not enough
+const uint32_t sClassificationInputSize = 4096;
+const uint32_t sClassificationJobChunkSize = 64;
+
+struct ClassificationJob
+{
+    ANDatInterface::FileRecord* pFileRecord;
+    uint32_t inputOffset;   // Position of the input in the batch buffer
+    uint32_t inputSize;
+    bool isTruncated;       // The input did not hold enough of the compressed stream
+};
+
+void classifyPrefix(const uint8_t* iPrefixTab, uint32_t iPrefixSize, ANDatInterface::FileRecord& ioFileRecord)
+{
+    ioFileRecord.fileType = ANDatInterface::FT_OTHER;
+    ioFileRecord.packFileType = 0;
+
+    if (iPrefixSize < 4)
+    {
+        return;
+    }
+
+    uint32_t aMagic;
+    memcpy(&aMagic, iPrefixTab, sizeof(aMagic));
+
+    switch (aMagic)
+    {
+    case 0x58455441: // ATEX
+    case 0x58545441: // ATTX
+    case 0x43455441: // ATEC
+    case 0x50455441: // ATEP
+    case 0x55455441: // ATEU
+    case 0x54455441: // ATET
+        ioFileRecord.fileType = ANDatInterface::FT_TEXTURE;
+        return;
+
+    case 0x5367674F: // OggS
+        ioFileRecord.fileType = ANDatInterface::FT_SOUND;
+        return;
+
+    case 0x73727473: // strs
+        ioFileRecord.fileType = ANDatInterface::FT_STRINGS;
+        return;
+
+    default:
+        break;
+    }
+
+    if (iPrefixTab[0] == 'P' && iPrefixTab[1] == 'F')
+    {
+        ioFileRecord.fileType = ANDatInterface::FT_PACKFILE;
+        if (iPrefixSize >= 12)
+        {
+            memcpy(&ioFileRecord.packFileType, iPrefixTab + 8, sizeof(ioFileRecord.packFileType));
+        }
+    }
+    else if ((iPrefixTab[0] == 'I' && iPrefixTab[1] == 'D' && iPrefixTab[2] == '3')
+            || (iPrefixTab[0] == 0xFF && (iPrefixTab[1] & 0xE0) == 0xE0))
+    {
+        ioFileRecord.fileType = ANDatInterface::FT_SOUND;
+    }
+}
+
+// Returns false if the input was too short to inflate the prefix
+bool classifyInput(const uint8_t* iInputTab, uint32_t iInputSize, ANDatInterface::FileRecord& ioFileRecord)
+{
+    if (!ioFileRecord.isCompressed)
+    {
+        classifyPrefix(iInputTab, iInputSize, ioFileRecord);
+        return true;
+    }
+
+    if (iInputSize < 2 * sizeof(uint32_t))
+    {
+        ioFileRecord.fileType = ANDatInterface::FT_UNKNOWN;
+        return true;
+    }
+
+    // Size of the uncompressed data is the second uint32 of the header
+    memcpy(&ioFileRecord.uncompressedSize, iInputTab + sizeof(uint32_t), sizeof(uint32_t));
+
+    uint8_t aPrefixTab[sClassificationPrefixSize];
+    uint32_t aPrefixSize = std::min(sClassificationPrefixSize, ioFileRecord.uncompressedSize);
+
+    if (aPrefixSize == 0)
+    {
+        classifyPrefix(nullptr, 0, ioFileRecord);
+        return true;
+    }
+
+    try
+    {
+        compression::inflateDatFileBuffer(iInputSize, iInputTab, aPrefixSize, aPrefixTab);
+    }
+    catch(std::exception&)
+    {
+        if (iInputSize < ioFileRecord.size)
+        {
+            return false;
+        }
+        ioFileRecord.fileType = ANDatInterface::FT_UNKNOWN;
+        return true;
+    }
+
+    classifyPrefix(aPrefixTab, aPrefixSize, ioFileRecord);
+    return true;
+}
+
+void runClassificationWorker(std::atomic<uint32_t>& ioNextJob, std::vector<ClassificationJob>& ioJobVect, const std::vector<uint8_t>& iInputBuffer)
+{
+    uint32_t aNbOfJobs = static_cast<uint32_t>(ioJobVect.size());
+
+    while (true)
+    {
+        uint32_t aFirstJob = ioNextJob.fetch_add(sClassificationJobChunkSize);
+        if (aFirstJob >= aNbOfJobs)
+        {
+            return;
+        }
+
+        uint32_t aLastJob = std::min(aFirstJob + sClassificationJobChunkSize, aNbOfJobs);
+        for (uint32_t aJobIndex = aFirstJob; aJobIndex < aLastJob; ++aJobIndex)
+        {
+            ClassificationJob& aJob = ioJobVect[aJobIndex];
+            aJob.isTruncated = !classifyInput(iInputBuffer.data() + aJob.inputOffset, aJob.inputSize, *aJob.pFileRecord);
+        }
+    }
+}
+
+void ANDatInterfaceImpl::classifyFileRecords(uint32_t iNbOfThreads)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+    ANDatSnapshot& aSnapshot = *pSnapshot;
+    std::vector<FileRecord>& aFileRecordVect = aSnapshot.changeFileRecordVect();
+
+    std::vector<FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(aFileRecordVect.size());
+
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (it->size != 0)
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+        else
+        {
+            it->fileType = FT_OTHER;
+            it->packFileType = 0;
+        }
+    }
+
+    classifyRecords(aSnapshot, aFileRecordPtrVect, iNbOfThreads);
+    publishSnapshot(std::move(pSnapshot));
+}
+
+void ANDatInterfaceImpl::classifyFileRecords(const std::vector<const FileRecord*>& iFileRecordPtrVect, uint32_t iNbOfThreads)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+    ANDatSnapshot& aSnapshot = *pSnapshot;
+    std::vector<FileRecord>& aFileRecordVect = aSnapshot.changeFileRecordVect();
+
+    std::vector<FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(iFileRecordPtrVect.size());
+
+    for (auto it = iFileRecordPtrVect.begin(); it != iFileRecordPtrVect.end(); ++it)
+    {
+        FileRecord& aFileRecord = aFileRecordVect[aSnapshot.getRecordIndex(**it)];
+        if (aFileRecord.size != 0)
+        {
+            aFileRecordPtrVect.push_back(&aFileRecord);
+        }
+        else
+        {
+            aFileRecord.fileType = FT_OTHER;
+            aFileRecord.packFileType = 0;
+        }
+    }
+
+    classifyRecords(aSnapshot, aFileRecordPtrVect, iNbOfThreads);
+    publishSnapshot(std::move(pSnapshot));
+}
+
+void ANDatInterfaceImpl::classifyRecords(ANDatSnapshot& ioSnapshot, std::vector<FileRecord*>& ioFileRecordPtrVect, uint32_t iNbOfThreads)
+{
+    // Visiting the records in offset order, so that the disk is read forward only
+    std::sort(ioFileRecordPtrVect.begin(), ioFileRecordPtrVect.end(),
+        [](const FileRecord* ipLeft, const FileRecord* ipRight) { return isStoredBefore(*ipLeft, *ipRight); });
+
+    uint32_t aNbOfThreads = (iNbOfThreads != 0) ? iNbOfThreads : std::thread::hardware_concurrency();
+    aNbOfThreads = std::max(1u, aNbOfThreads);
+
+    std::vector<ClassificationJob> aJobVect;
+    std::vector<uint8_t> anInputBuffer;
+
+    for (uint32_t aFirstRecord = 0; aFirstRecord < ioFileRecordPtrVect.size(); aFirstRecord += sClassificationBatchSize)
+    {
+        uint32_t aLastRecord = std::min<uint32_t>(aFirstRecord + sClassificationBatchSize, static_cast<uint32_t>(ioFileRecordPtrVect.size()));
+
+        // Reading the beginning of the records from this thread
+        aJobVect.resize(aLastRecord - aFirstRecord);
+        anInputBuffer.resize(aJobVect.size() * std::max(sClassificationInputSize, sClassificationPrefixSize));
+
+        uint32_t anInputOffset = 0;
+        for (uint32_t aRecordIndex = aFirstRecord; aRecordIndex < aLastRecord; ++aRecordIndex)
+        {
+            ClassificationJob& aJob = aJobVect[aRecordIndex - aFirstRecord];
+            aJob.pFileRecord = ioFileRecordPtrVect[aRecordIndex];
+            aJob.inputOffset = anInputOffset;
+            aJob.isTruncated = false;
+
+            if (aJob.pFileRecord->isCompressed)
+            {
+                // The bit reader works on whole uint32
+                aJob.inputSize = std::min(aJob.pFileRecord->size, sClassificationInputSize) & ~3u;
+            }
+            else
+            {
+                aJob.inputSize = std::min(aJob.pFileRecord->size, sClassificationPrefixSize);
+            }
+
+            if (!ioSnapshot.getArchive(*aJob.pFileRecord).read(aJob.pFileRecord->offset, aJob.inputSize, &anInputBuffer[anInputOffset]))
+            {
+                throw exception::Exception("Could not read the beginning of a record.");
+            }
+
+            anInputOffset += aJob.inputSize;
+        }
+
+        // Classifying them
+        std::atomic<uint32_t> aNextJob(0);
+
+        uint32_t aNbOfBatchThreads = std::min(aNbOfThreads, (static_cast<uint32_t>(aJobVect.size()) + sClassificationJobChunkSize - 1) / sClassificationJobChunkSize);
+
+        // The calling thread is one of the workers
+        std::vector<std::thread> aThreadVect;
+        for (uint32_t aThreadIndex = 1; aThreadIndex < aNbOfBatchThreads; ++aThreadIndex)
+        {
+            try
+            {
+                aThreadVect.push_back(std::thread(runClassificationWorker, std::ref(aNextJob), std::ref(aJobVect), std::cref(anInputBuffer)));
+            }
+            catch(std::exception&)
+            {
+                break; // The running workers take the remaining jobs
+            }
+        }
+
+        runClassificationWorker(aNextJob, aJobVect, anInputBuffer);
+
+        for (auto it = aThreadVect.begin(); it != aThreadVect.end(); ++it)
+        {
+            it->join();
+        }
+
+        // Records whose trees did not fit in the input are classified from their whole content
+        std::vector<uint8_t> aRecordBuffer;
+        for (auto it = aJobVect.begin(); it != aJobVect.end(); ++it)
+        {
+            if (!it->isTruncated)
+            {
+                continue;
+            }
+
+            FileRecord& aFileRecord = *(it->pFileRecord);
+            aRecordBuffer.resize(aFileRecord.size);
+
+            if (!ioSnapshot.getArchive(aFileRecord).read(aFileRecord.offset, aFileRecord.size, aRecordBuffer.data()))
+            {
+                throw exception::Exception("Could not read a record.");
+            }
+
+            classifyInput(aRecordBuffer.data(), aFileRecord.size & ~3u, aFileRecord);
+        }
+    }
+}
+
+bool ANDatSnapshot::hasRecord(const ANDatInterface::FileRecord& iFileRecord) const
+{
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = *pFileRecordVect;
+    return !aFileRecordVect.empty() && &iFileRecord >= aFileRecordVect.data() && &iFileRecord < aFileRecordVect.data() + aFileRecordVect.size();
+}
+
+uint32_t ANDatSnapshot::getRecordIndex(const ANDatInterface::FileRecord& iFileRecord) const
+{
+    // A copy shares the archives of its snapshot and keeps the order of its records, even once it copied them
+    for (const ANDatSnapshot* pSnapshot = this; pSnapshot != nullptr && pSnapshot->archiveVect == archiveVect; pSnapshot = pSnapshot->pPreviousSnapshot)
+    {
+        if (pSnapshot->hasRecord(iFileRecord))
+        {
+            return static_cast<uint32_t>(&iFileRecord - pSnapshot->pFileRecordVect->data());
+        }
+    }
+    throw exception::Exception("FileRecord does not belong to the archive.");
+}
+
+uint32_t ANDatSnapshot::findRecordIndex(uint32_t iId) const
+{
+    auto it = pIdDicts->fileIdDict.find(iId);
+    if (it == pIdDicts->fileIdDict.end())
+    {
+        it = pIdDicts->baseIdDict.find(iId);
+        if (it == pIdDicts->baseIdDict.end())
+        {
+            return static_cast<uint32_t>(pFileRecordVect->size());
+        }
+    }
+    return it->second;
+}
+
+void ANDatInterfaceImpl::computeDependencies(const format::ANStructsSchema& iSchema, uint32_t iNbOfThreads)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+    ANDatSnapshot& aSnapshot = *pSnapshot;
+
+    // Dropping the previous graph, so that updateDependencies does not copy it for nothing
+    aSnapshot.pDependencyGraph.reset(new ANDatDependencyGraph());
+
+    std::vector<uint32_t> aRecordIndexVect(aSnapshot.getFileRecordVect().size());
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aRecordIndexVect.size(); ++aRecordIndex)
+    {
+        aRecordIndexVect[aRecordIndex] = aRecordIndex;
+    }
+
+    updateDependencies(aSnapshot, iSchema, aRecordIndexVect, iNbOfThreads);
+    publishSnapshot(std::move(pSnapshot));
+}
+
+void ANDatInterfaceImpl::computeDependencies(const format::ANStructsSchema& iSchema, const std::vector<const FileRecord*>& iFileRecordPtrVect,
+                                             uint32_t iNbOfThreads)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+    ANDatSnapshot& aSnapshot = *pSnapshot;
+
+    std::vector<uint32_t> aRecordIndexVect;
+    aRecordIndexVect.reserve(iFileRecordPtrVect.size());
+    for (auto it = iFileRecordPtrVect.begin(); it != iFileRecordPtrVect.end(); ++it)
+    {
+        aRecordIndexVect.push_back(aSnapshot.getRecordIndex(**it));
+    }
+
+    updateDependencies(aSnapshot, iSchema, aRecordIndexVect, iNbOfThreads);
+    publishSnapshot(std::move(pSnapshot));
+}
+
+void ANDatInterfaceImpl::updateDependencies(ANDatSnapshot& ioSnapshot, const format::ANStructsSchema& iSchema, const std::vector<uint32_t>& iRecordIndexVect,
+                                            uint32_t iNbOfThreads)
+{
+    FileReferenceFinder aFinder(iSchema);
+
+    const std::vector<FileRecord>& aFileRecordVect = ioSnapshot.getFileRecordVect();
+    const uint32_t aNbOfRecords = static_cast<uint32_t>(aFileRecordVect.size());
+    std::vector<std::vector<uint32_t>> aDependencyVects(aNbOfRecords);
+
+    // Keeping the dependencies of the other records
+    const ANDatDependencyGraph& aPreviousGraph = *ioSnapshot.pDependencyGraph;
+    if (!aPreviousGraph.dependencyOffsetVect.empty())
+    {
+        for (uint32_t aRecordIndex = 0; aRecordIndex < aNbOfRecords; ++aRecordIndex)
+        {
+            aDependencyVects[aRecordIndex].assign(aPreviousGraph.dependencyVect.begin() + aPreviousGraph.dependencyOffsetVect[aRecordIndex],
+                                                  aPreviousGraph.dependencyVect.begin() + aPreviousGraph.dependencyOffsetVect[aRecordIndex + 1]);
+        }
+    }
+
+    std::vector<const FileRecord*> aFileRecordPtrVect;
+    for (auto it = iRecordIndexVect.begin(); it != iRecordIndexVect.end(); ++it)
+    {
+        aDependencyVects[*it].clear();
+        if (isPackFileCandidate(aFileRecordVect[*it], 0))
+        {
+            aFileRecordPtrVect.push_back(&aFileRecordVect[*it]);
+        }
+    }
+
+    // Referenced ids per scanned record
+    std::vector<std::vector<uint32_t>> aFileIdVects(aFileRecordPtrVect.size());
+
+    scanPackFiles(*this, aFileRecordPtrVect, iNbOfThreads,
+        [&aFinder, &aFileIdVects](uint32_t iRecordIndex, const format::PackFile& iPackFile)
+        {
+            try
+            {
+                aFinder.findReferences(iPackFile, aFileIdVects[iRecordIndex]);
+            }
+            catch(std::exception&)
+            {
+                aFileIdVects[iRecordIndex].clear(); // References of a broken record are not kept
+            }
+        });
+
+    // Resolving the ids, references to missing files and to the record itself are dropped
+    for (uint32_t aScanIndex = 0; aScanIndex < aFileRecordPtrVect.size(); ++aScanIndex)
+    {
+        uint32_t aRecordIndex = ioSnapshot.getRecordIndex(*aFileRecordPtrVect[aScanIndex]);
+        std::vector<uint32_t>& aDependencyVect = aDependencyVects[aRecordIndex];
+
+        for (auto it = aFileIdVects[aScanIndex].begin(); it != aFileIdVects[aScanIndex].end(); ++it)
+        {
+            uint32_t aDependencyIndex = ioSnapshot.findRecordIndex(*it);
+            if (aDependencyIndex != aNbOfRecords && aDependencyIndex != aRecordIndex)
+            {
+                aDependencyVect.push_back(aDependencyIndex);
+            }
+        }
+
+        std::sort(aDependencyVect.begin(), aDependencyVect.end());
+        aDependencyVect.erase(std::unique(aDependencyVect.begin(), aDependencyVect.end()), aDependencyVect.end());
+
+        aFileIdVects[aScanIndex].clear();
+        aFileIdVects[aScanIndex].shrink_to_fit();
+    }
+
+    std::shared_ptr<ANDatDependencyGraph> pDependencyGraph(new ANDatDependencyGraph());
+    pDependencyGraph->dependencyOffsetVect.reserve(aNbOfRecords + 1);
+    pDependencyGraph->dependencyOffsetVect.push_back(0);
+
+    for (auto it = aDependencyVects.begin(); it != aDependencyVects.end(); ++it)
+    {
+        pDependencyGraph->dependencyVect.insert(pDependencyGraph->dependencyVect.end(), it->begin(), it->end());
+        pDependencyGraph->dependencyOffsetVect.push_back(static_cast<uint32_t>(pDependencyGraph->dependencyVect.size()));
+    }
+
+    ioSnapshot.pDependencyGraph = pDependencyGraph;
+}
+
+std::vector<const ANDatInterface::FileRecord*> ANDatInterfaceImpl::getDependencies(const FileRecord& iFileRecord) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot(iFileRecord);
+
+    const ANDatDependencyGraph& aGraph = *aSnapshot.pDependencyGraph;
+    uint32_t aRecordIndex = aSnapshot.getRecordIndex(iFileRecord);
+
+    std::vector<const FileRecord*> aFileRecordPtrVect;
+    if (aGraph.dependencyOffsetVect.empty())
+    {
+        return aFileRecordPtrVect;
+    }
+
+    for (uint32_t anEdgeIndex = aGraph.dependencyOffsetVect[aRecordIndex]; anEdgeIndex < aGraph.dependencyOffsetVect[aRecordIndex + 1]; ++anEdgeIndex)
+    {
+        aFileRecordPtrVect.push_back(&aSnapshot.getFileRecordVect()[aGraph.dependencyVect[anEdgeIndex]]);
+    }
+    return aFileRecordPtrVect;
+}
+
+std::vector<const ANDatInterface::FileRecord*> ANDatInterfaceImpl::getDependencyClosure(const FileRecord& iFileRecord) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot(iFileRecord);
+
+    const std::vector<FileRecord>& aFileRecordVect = aSnapshot.getFileRecordVect();
+    const ANDatDependencyGraph& aGraph = *aSnapshot.pDependencyGraph;
+    uint32_t aRootIndex = aSnapshot.getRecordIndex(iFileRecord);
+
+    std::vector<uint32_t> aClosureVect(1, aRootIndex);
+    if (!aGraph.dependencyOffsetVect.empty())
+    {
+        std::vector<bool> isVisitedVect(aFileRecordVect.size(), false);
+        isVisitedVect[aRootIndex] = true;
+
+        // Breadth first, aClosureVect is the queue
+        for (size_t aQueueIndex = 0; aQueueIndex < aClosureVect.size(); ++aQueueIndex)
+        {
+            uint32_t aRecordIndex = aClosureVect[aQueueIndex];
+            for (uint32_t anEdgeIndex = aGraph.dependencyOffsetVect[aRecordIndex]; anEdgeIndex < aGraph.dependencyOffsetVect[aRecordIndex + 1]; ++anEdgeIndex)
+            {
+                uint32_t aDependencyIndex = aGraph.dependencyVect[anEdgeIndex];
+                if (!isVisitedVect[aDependencyIndex])
+                {
+                    isVisitedVect[aDependencyIndex] = true;
+                    aClosureVect.push_back(aDependencyIndex);
+                }
+            }
+        }
+    }
+
+    std::vector<const FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(aClosureVect.size());
+    for (auto it = aClosureVect.begin(); it != aClosureVect.end(); ++it)
+    {
+        aFileRecordPtrVect.push_back(&aFileRecordVect[*it]);
+    }
+
+    std::sort(aFileRecordPtrVect.begin(), aFileRecordPtrVect.end(),
+        [](const FileRecord* ipLeft, const FileRecord* ipRight) { return isStoredBefore(*ipLeft, *ipRight); });
+
+    return aFileRecordPtrVect;
+}
+
+void ANDatSnapshot::fillIndexHeader(format::IndexHeader& oIndexHeader) const
+{
+    memcpy(oIndexHeader.magic, "GW2I", 4);
+    oIndexHeader.version = format::sIndexVersion;
+    oIndexHeader.datFileSize = 0;
+    for (auto it = archiveVect.begin(); it != archiveVect.end(); ++it)
+    {
+        oIndexHeader.datFileSize += (*it)->datFileSize;
+    }
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = *pFileRecordVect;
+    oIndexHeader.nbOfRecords = static_cast<uint32_t>(aFileRecordVect.size());
+    oIndexHeader.nbOfSections = 0;
+
+    // FNV-1a of the location and ids of the records, the archive only counts for overlays
+    // so that the hash of a single archive does not change
+    uint64_t aHash = 14695981039346656037ULL;
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        const uint64_t aValueTab[] = { it->offset, it->size, it->baseId, it->fileId, it->archiveIndex };
+        const uint32_t aNbOfValues = (it->archiveIndex != 0) ? 5 : 4;
+        for (uint32_t aValueIndex = 0; aValueIndex < aNbOfValues; ++aValueIndex)
+        {
+            aHash ^= aValueTab[aValueIndex];
+            aHash *= 1099511628211ULL;
+        }
+    }
+    oIndexHeader.recordsHash = aHash;
+}
+
+template <typename ValueType>
+void writeIndexSection(std::ostream& iStream, const char* iTag, const std::vector<ValueType>& iValueVect)
+{
+    format::IndexSectionHeader aSectionHeader;
+    memcpy(aSectionHeader.tag, iTag, 4);
+    aSectionHeader.entrySize = sizeof(ValueType);
+    aSectionHeader.nbOfEntries = static_cast<uint32_t>(iValueVect.size());
+    iStream.write(reinterpret_cast<const char*>(&aSectionHeader), sizeof(aSectionHeader));
+
+    iStream.write(reinterpret_cast<const char*>(iValueVect.data()), sizeof(ValueType) * iValueVect.size());
+}
+
+template <typename FieldType>
+void writeIndexSection(std::ostream& iStream, const char* iTag, const std::vector<ANDatInterface::FileRecord>& iFileRecordVect,
+                       FieldType ANDatInterface::FileRecord::* iField)
+{
+    std::vector<FieldType> aValueVect;
+    aValueVect.reserve(iFileRecordVect.size());
+    for (auto it = iFileRecordVect.begin(); it != iFileRecordVect.end(); ++it)
+    {
+        aValueVect.push_back((*it).*iField);
+    }
+    writeIndexSection(iStream, iTag, aValueVect);
+}
+
+// Returns false if the section does not match the field
+template <typename FieldType>
+bool readIndexSection(std::istream& iStream, const format::IndexSectionHeader& iSectionHeader, const char* iTag,
+                      std::vector<ANDatInterface::FileRecord>& ioFileRecordVect, FieldType ANDatInterface::FileRecord::* iField)
+{
+    if (memcmp(iSectionHeader.tag, iTag, 4) != 0
+            || iSectionHeader.entrySize != sizeof(FieldType)
+            || iSectionHeader.nbOfEntries != ioFileRecordVect.size())
+    {
+        return false;
+    }
+
+    std::vector<FieldType> aValueVect(iSectionHeader.nbOfEntries);
+    format::readStructVect(iStream, aValueVect);
+
+    for (uint32_t anIndex = 0; anIndex < aValueVect.size(); ++anIndex)
+    {
+        ioFileRecordVect[anIndex].*iField = aValueVect[anIndex];
+    }
+    return true;
+}
+
+// Returns false if the section does not match, the section may hold any number of entries
+template <typename ValueType>
+bool readIndexSection(std::istream& iStream, const format::IndexSectionHeader& iSectionHeader, const char* iTag,
+                      std::vector<ValueType>& oValueVect)
+{
+    if (memcmp(iSectionHeader.tag, iTag, 4) != 0 || iSectionHeader.entrySize != sizeof(ValueType))
+    {
+        return false;
+    }
+
+    oValueVect.resize(iSectionHeader.nbOfEntries);
+    format::readStructVect(iStream, oValueVect);
+    return true;
+}
+
+void ANDatInterfaceImpl::saveIndex(const char* iIndexPath) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot();
+    const std::vector<FileRecord>& aFileRecordVect = aSnapshot.getFileRecordVect();
+    const ANDatDependencyGraph& aGraph = *aSnapshot.pDependencyGraph;
+
+    std::ofstream aStream(iIndexPath, std::ios::binary);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open the index file.");
+    }
+
+    format::IndexHeader anIndexHeader;
+    aSnapshot.fillIndexHeader(anIndexHeader);
+    anIndexHeader.nbOfSections = aGraph.dependencyOffsetVect.empty() ? 4 : 6;
+    aStream.write(reinterpret_cast<const char*>(&anIndexHeader), sizeof(anIndexHeader));
+
+    std::vector<format::IndexRecordEntry> aRecordEntryVect(aFileRecordVect.size());
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aRecordEntryVect.size(); ++aRecordIndex)
+    {
+        const FileRecord& aFileRecord = aFileRecordVect[aRecordIndex];
+        format::IndexRecordEntry& aRecordEntry = aRecordEntryVect[aRecordIndex];
+
+        aRecordEntry.archiveIndex = aFileRecord.archiveIndex;
+        aRecordEntry.offset = aFileRecord.offset;
+        aRecordEntry.size = aFileRecord.size;
+        aRecordEntry.baseId = aFileRecord.baseId;
+        aRecordEntry.fileId = aFileRecord.fileId;
+        aRecordEntry.crc = aFileRecord.crc;
+        aRecordEntry.isCompressed = aFileRecord.isCompressed ? 1 : 0;
+    }
+
+    writeIndexSection(aStream, "RECS", aRecordEntryVect);
+    writeIndexSection(aStream, "USIZ", aFileRecordVect, &FileRecord::uncompressedSize);
+    writeIndexSection(aStream, "FTYP", aFileRecordVect, &FileRecord::fileType);
+    writeIndexSection(aStream, "PFTY", aFileRecordVect, &FileRecord::packFileType);
+
+    if (!aGraph.dependencyOffsetVect.empty())
+    {
+        // Number of dependencies per record, then the dependencies of all the records
+        std::vector<uint32_t> aDependencyCountVect(aFileRecordVect.size());
+        for (uint32_t aRecordIndex = 0; aRecordIndex < aDependencyCountVect.size(); ++aRecordIndex)
+        {
+            aDependencyCountVect[aRecordIndex] = aGraph.dependencyOffsetVect[aRecordIndex + 1] - aGraph.dependencyOffsetVect[aRecordIndex];
+        }
+
+        writeIndexSection(aStream, "DEPC", aDependencyCountVect);
+        writeIndexSection(aStream, "DEPS", aGraph.dependencyVect);
+    }
+
+    if (!aStream)
+    {
+        throw exception::Exception("Could not write the index file.");
+    }
+}
+
+// Reads the sections following the header of an index. ioFileRecordVect holds as many records as the index,
+// the dependency graph is left empty if the index has none.
+// Returns false if the index is truncated or inconsistent.
+bool readIndexSections(std::istream& iStream, uint32_t iNbOfSections, std::vector<ANDatInterface::FileRecord>& ioFileRecordVect,
+                       bool& oHasRecords, std::vector<uint32_t>& oDependencyOffsetVect, std::vector<uint32_t>& oDependencyVect)
+{
+    std::vector<format::IndexRecordEntry> aRecordEntryVect;
+    std::vector<uint32_t> aDependencyCountVect;
+    bool hasDependencies = false;
+
+    oHasRecords = false;
+    oDependencyOffsetVect.clear();
+    oDependencyVect.clear();
+
+    for (uint32_t aSectionIndex = 0; aSectionIndex < iNbOfSections; ++aSectionIndex)
+    {
+        format::IndexSectionHeader aSectionHeader;
+        format::readStructs(iStream, aSectionHeader);
+        if (!iStream)
+        {
+            return false;
+        }
+
+        if (readIndexSection(iStream, aSectionHeader, "RECS", aRecordEntryVect))
+        {
+            oHasRecords = true;
+        }
+        else if (readIndexSection(iStream, aSectionHeader, "DEPC", aDependencyCountVect)
+                || readIndexSection(iStream, aSectionHeader, "DEPS", oDependencyVect))
+        {
+            hasDependencies = true;
+        }
+        else if (!readIndexSection(iStream, aSectionHeader, "USIZ", ioFileRecordVect, &ANDatInterface::FileRecord::uncompressedSize)
+                && !readIndexSection(iStream, aSectionHeader, "FTYP", ioFileRecordVect, &ANDatInterface::FileRecord::fileType)
+                && !readIndexSection(iStream, aSectionHeader, "PFTY", ioFileRecordVect, &ANDatInterface::FileRecord::packFileType))
+        {
+            iStream.seekg(static_cast<uint64_t>(aSectionHeader.entrySize) * aSectionHeader.nbOfEntries, std::ios::cur);
+        }
+
+        if (!iStream)
+        {
+            return false;
+        }
+    }
+
+    if (oHasRecords)
+    {
+        if (aRecordEntryVect.size() != ioFileRecordVect.size())
+        {
+            return false;
+        }
+
+        for (uint32_t aRecordIndex = 0; aRecordIndex < aRecordEntryVect.size(); ++aRecordIndex)
+        {
+            const format::IndexRecordEntry& aRecordEntry = aRecordEntryVect[aRecordIndex];
+            ANDatInterface::FileRecord& aFileRecord = ioFileRecordVect[aRecordIndex];
+
+            aFileRecord.archiveIndex = aRecordEntry.archiveIndex;
+            aFileRecord.offset = aRecordEntry.offset;
+            aFileRecord.size = aRecordEntry.size;
+            aFileRecord.baseId = aRecordEntry.baseId;
+            aFileRecord.fileId = aRecordEntry.fileId;
+            aFileRecord.crc = aRecordEntry.crc;
+            aFileRecord.isCompressed = (aRecordEntry.isCompressed != 0);
+        }
+    }
+
+    if (hasDependencies)
+    {
+        if (aDependencyCountVect.size() != ioFileRecordVect.size())
+        {
+            return false;
+        }
+
+        oDependencyOffsetVect.assign(1, 0);
+        oDependencyOffsetVect.reserve(aDependencyCountVect.size() + 1);
+        for (auto it = aDependencyCountVect.begin(); it != aDependencyCountVect.end(); ++it)
+        {
+            oDependencyOffsetVect.push_back(oDependencyOffsetVect.back() + *it);
+            if (oDependencyOffsetVect.back() < *it)
+            {
+                return false;
+            }
+        }
+
+        const size_t aNbOfRecords = ioFileRecordVect.size();
+        if (oDependencyOffsetVect.back() != oDependencyVect.size()
+                || std::any_of(oDependencyVect.begin(), oDependencyVect.end(), [aNbOfRecords](uint32_t iIndex) { return iIndex >= aNbOfRecords; }))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ANDatInterfaceImpl::loadIndex(const char* iIndexPath)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    const ANDatSnapshot& aCurrentSnapshot = *_pSnapshot;
+
+    std::ifstream aStream(iIndexPath, std::ios::binary);
+    if (!aStream)
+    {
+        return false;
+    }
+
+    format::IndexHeader anExpectedIndexHeader;
+    aCurrentSnapshot.fillIndexHeader(anExpectedIndexHeader);
+
+    format::IndexHeader anIndexHeader;
+    format::readStructs(aStream, anIndexHeader);
+
+    if (!aStream
+            || memcmp(anIndexHeader.magic, anExpectedIndexHeader.magic, 4) != 0
+            || anIndexHeader.version != anExpectedIndexHeader.version
+            || anIndexHeader.datFileSize != anExpectedIndexHeader.datFileSize
+            || anIndexHeader.recordsHash != anExpectedIndexHeader.recordsHash
+            || anIndexHeader.nbOfRecords != anExpectedIndexHeader.nbOfRecords)
+    {
+        return false;
+    }
+
+    // Sections are applied to a copy, a truncated index leaves the published records untouched
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
+
+    bool hasRecords;
+    std::vector<uint32_t> aDependencyOffsetVect;
+    std::vector<uint32_t> aDependencyVect;
+
+    if (!readIndexSections(aStream, anIndexHeader.nbOfSections, pSnapshot->changeFileRecordVect(), hasRecords, aDependencyOffsetVect, aDependencyVect))
+    {
+        return false;
+    }
+
+    if (!aDependencyOffsetVect.empty())
+    {
+        std::shared_ptr<ANDatDependencyGraph> pDependencyGraph(new ANDatDependencyGraph());
+        pDependencyGraph->dependencyOffsetVect.swap(aDependencyOffsetVect);
+        pDependencyGraph->dependencyVect.swap(aDependencyVect);
+        pSnapshot->pDependencyGraph = pDependencyGraph;
+    }
+
+    publishSnapshot(std::move(pSnapshot));
+    return true;
+}
+
+// Record without counterpart in the previous version of the archive
+const uint32_t sNoRecordIndex = 0xFFFFFFFF;
+
+// Copies the computed data of the records of the previous version whose content did not change, and resolves
+// their dependencies again by fileId. The dependencies of the other records are left empty.
+void carryOverComputedData(const std::vector<ANDatInterface::FileRecord>& iOldFileRecordVect, const std::vector<uint32_t>& iOldDependencyOffsetVect,
+                           const std::vector<uint32_t>& iOldDependencyVect, ANDatSnapshot& ioSnapshot)
+{
+    std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioSnapshot.changeFileRecordVect();
+    const ANDatIdDicts& anIdDicts = *ioSnapshot.pIdDicts;
+
+    const uint32_t aNbOfRecords = static_cast<uint32_t>(aFileRecordVect.size());
+    std::vector<uint32_t> anOldRecordIndexVect(aNbOfRecords, sNoRecordIndex);
+
+    for (uint32_t anOldRecordIndex = 0; anOldRecordIndex < iOldFileRecordVect.size(); ++anOldRecordIndex)
+    {
+        const ANDatInterface::FileRecord& anOldFileRecord = iOldFileRecordVect[anOldRecordIndex];
+
+        auto it = anIdDicts.fileIdDict.find(anOldFileRecord.fileId);
+        if (it == anIdDicts.fileIdDict.end() || !isSameContent(anOldFileRecord, aFileRecordVect[it->second]))
+        {
+            continue;
+        }
+
+        ANDatInterface::FileRecord& aFileRecord = aFileRecordVect[it->second];
+        aFileRecord.uncompressedSize = anOldFileRecord.uncompressedSize;
+        aFileRecord.fileType = anOldFileRecord.fileType;
+        aFileRecord.packFileType = anOldFileRecord.packFileType;
+
+        anOldRecordIndexVect[it->second] = anOldRecordIndex;
+    }
+
+    // Dependencies are resolved again by fileId, those of the other records are left empty
+    if (!iOldDependencyOffsetVect.empty())
+    {
+        std::shared_ptr<ANDatDependencyGraph> pDependencyGraph(new ANDatDependencyGraph());
+        std::vector<uint32_t>& aDependencyOffsetVect = pDependencyGraph->dependencyOffsetVect;
+        std::vector<uint32_t>& aDependencyVect = pDependencyGraph->dependencyVect;
+
+        aDependencyOffsetVect.reserve(aNbOfRecords + 1);
+        aDependencyOffsetVect.push_back(0);
+
+        for (uint32_t aRecordIndex = 0; aRecordIndex < aNbOfRecords; ++aRecordIndex)
+        {
+            uint32_t anOldRecordIndex = anOldRecordIndexVect[aRecordIndex];
+            if (anOldRecordIndex != sNoRecordIndex)
+            {
+                size_t aFirstEdge = aDependencyVect.size();
+                for (uint32_t anEdgeIndex = iOldDependencyOffsetVect[anOldRecordIndex]; anEdgeIndex < iOldDependencyOffsetVect[anOldRecordIndex + 1]; ++anEdgeIndex)
+                {
+                    auto it = anIdDicts.fileIdDict.find(iOldFileRecordVect[iOldDependencyVect[anEdgeIndex]].fileId);
+                    if (it != anIdDicts.fileIdDict.end())
+                    {
+                        aDependencyVect.push_back(it->second);
+                    }
+                }
+                std::sort(aDependencyVect.begin() + aFirstEdge, aDependencyVect.end());
+            }
+            aDependencyOffsetVect.push_back(static_cast<uint32_t>(aDependencyVect.size()));
+        }
+
+        ioSnapshot.pDependencyGraph = pDependencyGraph;
+    }
+}
+
+bool ANDatInterfaceImpl::loadPreviousIndex(const char* iIndexPath, ArchiveDiff& oArchiveDiff)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
 
-    virtual void getBuffer(const ANDatInterface::FileRecord& iFileRecord, uint32_t& ioOutputSize, uint8_t* ioBuffer);
+    std::ifstream aStream(iIndexPath, std::ios::binary);
+    if (!aStream)
+    {
+        return false;
+    }
 
-    virtual const FileRecord& getFileRecordForFileId(const uint32_t& iFileId) const;
-    virtual const FileRecord& getFileRecordForBaseId(const uint32_t& iBaseId) const;
+    format::IndexHeader anIndexHeader;
+    format::readStructs(aStream, anIndexHeader);
 
-    virtual const std::vector<FileRecord>& getFileRecordVect() const;
+    if (!aStream
+            || memcmp(anIndexHeader.magic, "GW2I", 4) != 0
+            || anIndexHeader.version != format::sIndexVersion)
+    {
+        return false;
+    }
 
-    void computeInternalData();
+    // Records of the previous version, as they were when the index was saved
+    std::vector<FileRecord> anOldFileRecordVect(anIndexHeader.nbOfRecords);
 
-private:
-    std::ifstream _datStream;
+    bool hasRecords;
+    std::vector<uint32_t> anOldDependencyOffsetVect;
+    std::vector<uint32_t> anOldDependencyVect;
 
-    // Helper data structures
-    std::unordered_map<uint32_t, FileRecord*> _fileIdDict;
-    std::unordered_map<uint32_t, FileRecord*> _baseIdDict;
+    if (!readIndexSections(aStream, anIndexHeader.nbOfSections, anOldFileRecordVect, hasRecords, anOldDependencyOffsetVect, anOldDependencyVect)
+            || !hasRecords)
+    {
+        return false;
+    }
 
-    // Computed data structures
-    std::vector<FileRecord> _fileRecordVect;
+    std::unique_ptr<ANDatSnapshot> pSnapshot = copyPublishedSnapshot();
 
-    // Raw data structures
-    std::unique_ptr<format::Mft> _pMft;
-    std::unique_ptr<format::Mapping> _pMapping;
-};
+    oArchiveDiff = diffFileRecords(anOldFileRecordVect, pSnapshot->getFileRecordVect());
 
-ANDatInterfaceImpl::ANDatInterfaceImpl(const char* iDatPath, std::unique_ptr<format::Mft>& ipMft, std::unique_ptr<format::Mapping>& ipMapping) :
-    _datStream(iDatPath, std::ios::binary),
-    _pMft(std::move(ipMft)),
-    _pMapping(std::move(ipMapping))
+    carryOverComputedData(anOldFileRecordVect, anOldDependencyOffsetVect, anOldDependencyVect, *pSnapshot);
+
+    publishSnapshot(std::move(pSnapshot));
+    return true;
+}
+
+uint64_t alignSidecarOffset(uint64_t iOffset)
 {
+    return (iOffset + format::sSidecarAlignment - 1) & ~static_cast<uint64_t>(format::sSidecarAlignment - 1);
 }
 
-ANDatInterfaceImpl::~ANDatInterfaceImpl()
+void ANDatInterfaceImpl::saveSidecar(const char* iSidecarPath, uint32_t iNbOfThreads)
 {
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot();
+
+    std::ofstream aStream(iSidecarPath, std::ios::binary);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open the sidecar file.");
+    }
+
+    // Only compressed records are worth it, and only those found by their fileId
+    const std::vector<FileRecord>& aFileRecordVect = aSnapshot.getFileRecordVect();
+
+    std::vector<const FileRecord*> aFileRecordPtrVect;
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aFileRecordVect.size(); ++aRecordIndex)
+    {
+        const FileRecord& aFileRecord = aFileRecordVect[aRecordIndex];
+        if (!aFileRecord.isCompressed || aFileRecord.size == 0)
+        {
+            continue;
+        }
+
+        auto itFileIdDict = aSnapshot.pIdDicts->fileIdDict.find(aFileRecord.fileId);
+        if (itFileIdDict != aSnapshot.pIdDicts->fileIdDict.end() && itFileIdDict->second == aRecordIndex)
+        {
+            aFileRecordPtrVect.push_back(&aFileRecord);
+        }
+    }
+
+    format::IndexHeader anIndexHeader;
+    aSnapshot.fillIndexHeader(anIndexHeader);
+
+    format::SidecarHeader aSidecarHeader;
+    memcpy(aSidecarHeader.magic, "GW2S", 4);
+    aSidecarHeader.version = format::sSidecarVersion;
+    aSidecarHeader.datFileSize = anIndexHeader.datFileSize;
+    aSidecarHeader.recordsHash = anIndexHeader.recordsHash;
+    aSidecarHeader.nbOfEntries = 0;
+    aSidecarHeader.alignment = format::sSidecarAlignment;
+
+    // Room for an entry per record, the contents follow in the order they are inflated.
+    // The header and the entries are written last, once the contents are known.
+    const std::vector<char> aPadding(format::sSidecarAlignment, 0);
+    uint64_t aNextOffset = alignSidecarOffset(sizeof(format::SidecarHeader) + aFileRecordPtrVect.size() * sizeof(format::SidecarEntry));
+    for (uint64_t anOffset = 0; anOffset < aNextOffset; anOffset += format::sSidecarAlignment)
+    {
+        aStream.write(aPadding.data(), format::sSidecarAlignment);
+    }
+
+    std::vector<format::SidecarEntry> anEntryVect;
+    std::mutex aStreamMutex;
+
+    scanRecords(*this, aFileRecordPtrVect, iNbOfThreads, true,
+        [&aFileRecordPtrVect, &aStream, &aPadding, &aNextOffset, &anEntryVect, &aStreamMutex](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+        {
+            std::lock_guard<std::mutex> aLock(aStreamMutex);
+
+            format::SidecarEntry anEntry;
+            anEntry.fileId = aFileRecordPtrVect[iRecordIndex]->fileId;
+            anEntry.size = iSize;
+            anEntry.offset = aNextOffset;
+
+            aNextOffset = alignSidecarOffset(anEntry.offset + iSize);
+            aStream.write(reinterpret_cast<const char*>(iTab), iSize);
+            aStream.write(aPadding.data(), aNextOffset - anEntry.offset - iSize);
+
+            anEntryVect.push_back(anEntry);
+        });
+
+    std::sort(anEntryVect.begin(), anEntryVect.end(),
+        [](const format::SidecarEntry& iLeft, const format::SidecarEntry& iRight) { return iLeft.fileId < iRight.fileId; });
+
+    aSidecarHeader.nbOfEntries = static_cast<uint32_t>(anEntryVect.size());
+
+    aStream.seekp(0);
+    aStream.write(reinterpret_cast<const char*>(&aSidecarHeader), sizeof(aSidecarHeader));
+    aStream.write(reinterpret_cast<const char*>(anEntryVect.data()), anEntryVect.size() * sizeof(format::SidecarEntry));
+
+    if (!aStream)
+    {
+        throw exception::Exception("Could not write the sidecar file.");
+    }
 }
 
-void ANDatInterfaceImpl::getBuffer(const ANDatInterface::FileRecord& iFileRecord, uint32_t& ioOutputSize, uint8_t* ioBuffer)
+// Returns false if the sidecar does not match the snapshot, which is left as is
+bool attachSidecarToSnapshot(const char* iSidecarPath, ANDatSnapshot& ioSnapshot)
 {
-    _datStream.seekg(iFileRecord.offset);
-    ioOutputSize = std::min(ioOutputSize, iFileRecord.size);
-    format::readStructs(_datStream, *ioBuffer, ioOutputSize);
+    format::IndexHeader anIndexHeader;
+    ioSnapshot.fillIndexHeader(anIndexHeader);
+
+    std::unique_ptr<ANDatSidecar> pSidecar(new ANDatSidecar());
+    if (!pSidecar->open(iSidecarPath, anIndexHeader))
+    {
+        return false;
+    }
+
+    // Readers pick the new sidecar from now on, the previous one stays alive with the snapshot
+    ioSnapshot.pSidecar = pSidecar.get();
+    ioSnapshot.sidecarVect.push_back(std::move(pSidecar));
+    return true;
 }
 
-const ANDatInterface::FileRecord& ANDatInterfaceImpl::getFileRecordForFileId(const uint32_t& iFileId) const
+bool ANDatInterfaceImpl::attachSidecar(const char* iSidecarPath)
 {
-    auto it = _fileIdDict.find(iFileId);
-    if (it != _fileIdDict.end())
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+
+    if (!attachSidecarToSnapshot(iSidecarPath, *_pSnapshot))
     {
-        if (it->second != nullptr)
-        {
-            return *(it->second);
-        }
-        else
+        return false;
+    }
+
+    _sidecarPath = iSidecarPath;
+    return true;
+}
+
+bool ANDatInterfaceImpl::isInSidecar(const FileRecord& iFileRecord) const
+{
+    ReadSection aReadSection(*this);
+    const ANDatSnapshot& aSnapshot = aReadSection.getSnapshot(iFileRecord);
+
+    return aSnapshot.findSidecarEntry(iFileRecord) != nullptr;
+}
+
+void ANDatInterfaceImpl::getInflatedBuffer(const FileRecord& iFileRecord, std::vector<uint8_t>& oBuffer)
+{
+    ReadSection aReadSection(*this);
+    ANDatSnapshot& aSnapshot = aReadSection.getSnapshot(iFileRecord);
+
+    const format::SidecarEntry* pSidecarEntry = aSnapshot.findSidecarEntry(iFileRecord);
+    if (pSidecarEntry != nullptr)
+    {
+        if (!aSnapshot.pSidecar.load()->read(*pSidecarEntry, oBuffer))
         {
-            throw exception::Exception("FileId found, but null entry.");
+            throw exception::Exception("Could not read a record from the sidecar.");
         }
+        return;
     }
-    else
+
+    std::vector<uint8_t> aRawBuffer(iFileRecord.size);
+    if (!aSnapshot.getArchive(iFileRecord).read(iFileRecord.offset, iFileRecord.size, aRawBuffer.data()))
     {
-        throw exception::Exception("FileId not found.");
+        throw exception::Exception("Could not read a record.");
+    }
+
+    if (!iFileRecord.isCompressed)
+    {
+        oBuffer.swap(aRawBuffer);
+        return;
+    }
+
+    // Size of the uncompressed data is the second uint32 of the header
+    if (aRawBuffer.size() < 2 * sizeof(uint32_t))
+    {
+        throw exception::Exception("Compressed buffer is too small.");
+    }
+
+    uint32_t anOutputSize;
+    memcpy(&anOutputSize, aRawBuffer.data() + sizeof(uint32_t), sizeof(uint32_t));
+
+    oBuffer.resize(anOutputSize);
+    if (anOutputSize != 0)
+    {
+        compression::inflateDatFileBuffer(static_cast<uint32_t>(aRawBuffer.size()), aRawBuffer.data(), anOutputSize, oBuffer.data());
     }
+    oBuffer.resize(anOutputSize);
 }
 
-const ANDatInterface::FileRecord& ANDatInterfaceImpl::getFileRecordForBaseId(const uint32_t& iBaseId) const
+bool ANDatInterfaceImpl::reload(ArchiveDiff& oArchiveDiff)
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    const ANDatSnapshot& aCurrentSnapshot = *_pSnapshot;
+
+    std::unique_ptr<ANDatSnapshot> pSnapshot(new ANDatSnapshot());
+    pSnapshot->pPreviousSnapshot = _pSnapshot.load();
+    pSnapshot->pSidecar = nullptr;
+    pSnapshot->open(_datPathVect);
+    if (pSnapshot->isSameVersion(aCurrentSnapshot))
+    {
+        return false;
+    }
+
+    pSnapshot->computeInternalData();
+
+    // The archive may have been written while it was read
+    ANDatSnapshot aCheckSnapshot;
+    aCheckSnapshot.pPreviousSnapshot = nullptr;
+    aCheckSnapshot.pSidecar = nullptr;
+    aCheckSnapshot.open(_datPathVect);
+    if (!aCheckSnapshot.isSameVersion(*pSnapshot))
+    {
+        throw exception::Exception("Dat file changed while being reloaded.");
+    }
+
+    const ANDatDependencyGraph& aCurrentGraph = *aCurrentSnapshot.pDependencyGraph;
+    oArchiveDiff = diffFileRecords(aCurrentSnapshot.getFileRecordVect(), pSnapshot->getFileRecordVect());
+    carryOverComputedData(aCurrentSnapshot.getFileRecordVect(), aCurrentGraph.dependencyOffsetVect, aCurrentGraph.dependencyVect, *pSnapshot);
+
+    // Kept only if it was written for the new version
+    if (!_sidecarPath.empty())
+    {
+        attachSidecarToSnapshot(_sidecarPath.c_str(), *pSnapshot);
+    }
+
+    publishSnapshot(std::move(pSnapshot));
+    return true;
+}
+
+void ANDatInterfaceImpl::startAutoReload(uint32_t iPeriodMs, const ReloadCallback& iCallback)
+{
+    stopAutoReload();
+
+    _isAutoReloadStopping = false;
+    _autoReloadThread = std::thread(&ANDatInterfaceImpl::runAutoReload, this, iPeriodMs, iCallback);
+}
+
+void ANDatInterfaceImpl::stopAutoReload()
+{
+    if (!_autoReloadThread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> aLock(_autoReloadMutex);
+        _isAutoReloadStopping = true;
+    }
+    _autoReloadCondition.notify_all();
+
+    _autoReloadThread.join();
+}
+
+void ANDatInterfaceImpl::runAutoReload(uint32_t iPeriodMs, ReloadCallback iCallback)
 {
-    auto it = _baseIdDict.find(iBaseId);
-    if (it != _baseIdDict.end())
+    std::unique_lock<std::mutex> aLock(_autoReloadMutex);
+    while (!_autoReloadCondition.wait_for(aLock, std::chrono::milliseconds(iPeriodMs), [this]() { return _isAutoReloadStopping; }))
     {
-        if (it->second != nullptr)
+        aLock.unlock();
+
+        ArchiveDiff anArchiveDiff;
+        bool isReloaded = false;
+        try
         {
-            return *(it->second);
+            isReloaded = reload(anArchiveDiff);
         }
-        else
+        catch(std::exception&)
         {
-            throw exception::Exception("BaseId found, but null entry.");
+            // Being patched, tried again at the next period
         }
+
+        if (isReloaded && iCallback)
+        {
+            iCallback(anArchiveDiff);
+        }
+
+        aLock.lock();
     }
-    else
+}
+
+void ANDatInterfaceImpl::releaseRetiredSnapshots()
+{
+    std::lock_guard<std::mutex> aLock(_updateMutex);
+    if (_snapshotVect.size() < 2)
     {
-        throw exception::Exception("BaseId not found.");
+        return;
     }
+
+    // Readers can still reach the retired snapshots until the chain is cut and the reads in progress are over
+    _pSnapshot.load()->pPreviousSnapshot = nullptr;
+    waitForReaders();
+    _snapshotVect.erase(_snapshotVect.begin(), _snapshotVect.end() - 1);
 }
 
-const std::vector<ANDatInterface::FileRecord>& ANDatInterfaceImpl::getFileRecordVect() const
+bool ANDatSidecar::open(const char* iSidecarPath, const format::IndexHeader& iIndexHeader)
+{
+    sidecarStream.open(iSidecarPath, std::ios::binary);
+    if (!sidecarStream)
+    {
+        return false;
+    }
+
+    sidecarStream.seekg(0, std::ios::end);
+    uint64_t aSidecarSize = sidecarStream.tellg();
+    sidecarStream.seekg(0);
+
+    format::SidecarHeader aSidecarHeader;
+    format::readStructs(sidecarStream, aSidecarHeader);
+
+    if (!sidecarStream
+            || memcmp(aSidecarHeader.magic, "GW2S", 4) != 0
+            || aSidecarHeader.version != format::sSidecarVersion
+            || aSidecarHeader.alignment != format::sSidecarAlignment
+            || aSidecarHeader.datFileSize != iIndexHeader.datFileSize
+            || aSidecarHeader.recordsHash != iIndexHeader.recordsHash
+            || aSidecarHeader.nbOfEntries > (aSidecarSize - sizeof(aSidecarHeader)) / sizeof(format::SidecarEntry))
+    {
+        return false;
+    }
+
+    entryVect.resize(aSidecarHeader.nbOfEntries);
+    format::readStructVect(sidecarStream, entryVect);
+    if (!sidecarStream)
+    {
+        return false;
+    }
+
+    // A truncated file is not used at all
+    for (auto it = entryVect.begin(); it != entryVect.end(); ++it)
+    {
+        if ((it != entryVect.begin() && (it - 1)->fileId >= it->fileId) || it->offset > aSidecarSize || it->size > aSidecarSize - it->offset)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const format::SidecarEntry* ANDatSidecar::findEntry(uint32_t iFileId) const
+{
+    auto it = std::lower_bound(entryVect.begin(), entryVect.end(), iFileId,
+        [](const format::SidecarEntry& iEntry, uint32_t iId) { return iEntry.fileId < iId; });
+    if (it == entryVect.end() || it->fileId != iFileId)
+    {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+bool ANDatSidecar::read(const format::SidecarEntry& iEntry, std::vector<uint8_t>& oBuffer)
+{
+    oBuffer.resize(iEntry.size);
+
+    std::lock_guard<std::mutex> aLock(streamMutex);
+
+    sidecarStream.clear();
+    sidecarStream.seekg(iEntry.offset);
+    format::readStructVect(sidecarStream, oBuffer);
+
+    return !sidecarStream.fail();
+}
+
+void ANDatArchive::open(const char* iDatPath)
+{
+    datStream.open(iDatPath, std::ios::binary);
+    if (!datStream)
+    {
+        throw exception::Exception("Could not open the dat file.");
+    }
+
+    datStream.seekg(0, std::ios::end);
+    datFileSize = datStream.tellg();
+
+    pANDat = format::parseANDat(datStream, 0, 0);
+    pMft = format::parseMft(datStream, pANDat->header.mftOffset, pANDat->header.mftSize);
+
+    if (!datStream || pMft->entries.size() < 2)
+    {
+        throw exception::Exception("Could not read the MFT.");
+    }
+}
+
+bool ANDatArchive::read(uint64_t iOffset, uint32_t iSize, uint8_t* oTab)
+{
+    if (iSize == 0)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> aLock(streamMutex);
+
+    // A failed read leaves the stream in error, it must not fail the next ones
+    datStream.clear();
+    datStream.seekg(iOffset);
+    format::readStructs(datStream, *oTab, iSize);
+
+    return !datStream.fail();
+}
+
+bool ANDatArchive::isSameVersion(const ANDatArchive& iArchive) const
 {
-    return _fileRecordVect;
+    return datFileSize == iArchive.datFileSize
+        && memcmp(&pANDat->header, &iArchive.pANDat->header, sizeof(format::ANDatHeader)) == 0
+        && pMft->entries.size() == iArchive.pMft->entries.size()
+        && memcmp(pMft->entries.data(), iArchive.pMft->entries.data(), pMft->entries.size() * sizeof(format::MftEntry)) == 0;
 }
 
-void ANDatInterfaceImpl::computeInternalData()
+void ANDatArchive::computeFileRecords(uint32_t iArchiveIndex, std::vector<ANDatInterface::FileRecord>& oFileRecordVect)
 {
-    _fileIdDict.clear();
-    _baseIdDict.clear();
-    _fileRecordVect.clear();
+    pMapping = format::parseMapping(datStream, pMft->entries[1].offset, pMft->entries[1].size);
+    if (!datStream)
+    {
+        throw exception::Exception("Could not read the mapping.");
+    }
 
-    _fileRecordVect.resize(_pMapping->entries.size());
+    oFileRecordVect.resize(pMapping->entries.size());
 
-    std::unordered_map<uint32_t, FileRecord*> aMftIndexDictHelper;
-    aMftIndexDictHelper.rehash(_pMapping->entries.size());
+    std::unordered_map<uint32_t, ANDatInterface::FileRecord*> aMftIndexDictHelper;
+    aMftIndexDictHelper.rehash(pMapping->entries.size());
 
     uint32_t aCurrentIndex(0);
 
-    for (auto itMapping = _pMapping->entries.begin(); itMapping != _pMapping->entries.end(); ++itMapping)
+    for (auto itMapping = pMapping->entries.begin(); itMapping != pMapping->entries.end(); ++itMapping)
     {
         if (itMapping->mftIndex == 0 && itMapping->id == 0)
         {
@@ -132,7 +1739,7 @@ void ANDatInterfaceImpl::computeInternalData()
             auto itMftDict = aMftIndexDictHelper.find(itMapping->mftIndex);
             if (itMftDict != aMftIndexDictHelper.end())
             {
-                FileRecord* pFileRecord = itMftDict->second;
+                ANDatInterface::FileRecord* pFileRecord = itMftDict->second;
 
                 if (itMapping->id < pFileRecord->fileId)
                 {
@@ -146,10 +1753,16 @@ void ANDatInterfaceImpl::computeInternalData()
             }
             else
             {
-                FileRecord& aFileRecord = _fileRecordVect[aCurrentIndex];
+                if (itMapping->mftIndex == 0 || itMapping->mftIndex > pMft->entries.size())
+                {
+                    throw exception::Exception("Mapping refers to a missing MFT entry.");
+                }
+
+                ANDatInterface::FileRecord& aFileRecord = oFileRecordVect[aCurrentIndex];
                 ++aCurrentIndex;
-                format::MftEntry& aMftEntry = _pMft->entries[itMapping->mftIndex - 1];
+                format::MftEntry& aMftEntry = pMft->entries[itMapping->mftIndex - 1];
 
+                aFileRecord.archiveIndex = iArchiveIndex;
                 aFileRecord.offset = aMftEntry.offset;
                 aFileRecord.size = aMftEntry.size;
 
@@ -157,6 +1770,11 @@ void ANDatInterfaceImpl::computeInternalData()
                 aFileRecord.fileId = itMapping->id;
 
                 aFileRecord.isCompressed = (aMftEntry.compressionFlag != 0);
+                aFileRecord.crc = aMftEntry.crc;
+                aFileRecord.uncompressedSize = aFileRecord.isCompressed ? 0 : aFileRecord.size;
+
+                aFileRecord.fileType = ANDatInterface::FT_UNKNOWN;
+                aFileRecord.packFileType = 0;
 
                 aMftIndexDictHelper.insert(std::make_pair(itMapping->mftIndex, &aFileRecord));
             }
@@ -164,35 +1782,163 @@ void ANDatInterfaceImpl::computeInternalData()
     }
 
     // Dropping the unecessary entries
-    _fileRecordVect.resize(aCurrentIndex);
+    oFileRecordVect.resize(aCurrentIndex);
+}
+
+void ANDatSnapshot::open(const std::vector<std::string>& iDatPathVect)
+{
+    if (iDatPathVect.empty())
+    {
+        throw exception::Exception("No dat file to open.");
+    }
 
-    // Reserving space for dicts
-    _fileIdDict.rehash(_fileRecordVect.size());
-    _baseIdDict.rehash(_fileRecordVect.size());
+    archiveVect.clear();
+    for (auto it = iDatPathVect.begin(); it != iDatPathVect.end(); ++it)
+    {
+        archiveVect.push_back(std::shared_ptr<ANDatArchive>(new ANDatArchive()));
+        archiveVect.back()->open(it->c_str());
+    }
+}
 
-    for (auto itFileRecord = _fileRecordVect.begin(); itFileRecord != _fileRecordVect.end(); ++itFileRecord)
+bool ANDatSnapshot::isSameVersion(const ANDatSnapshot& iSnapshot) const
+{
+    if (archiveVect.size() != iSnapshot.archiveVect.size())
     {
-        _fileIdDict.insert(std::make_pair(itFileRecord->fileId, &(*itFileRecord)));
+        return false;
+    }
 
-        if (itFileRecord->baseId != 0)
+    for (uint32_t anArchiveIndex = 0; anArchiveIndex < archiveVect.size(); ++anArchiveIndex)
+    {
+        if (!archiveVect[anArchiveIndex]->isSameVersion(*iSnapshot.archiveVect[anArchiveIndex]))
         {
-            _baseIdDict.insert(std::make_pair(itFileRecord->baseId, &(*itFileRecord)));
+            return false;
         }
     }
+    return true;
 }
 
-GW2DATTOOLS_API std::unique_ptr<ANDatInterface> GW2DATTOOLS_APIENTRY createANDatInterface(const char* iDatPath)
+ANDatArchive& ANDatSnapshot::getArchive(const ANDatInterface::FileRecord& iFileRecord)
+{
+    if (iFileRecord.archiveIndex >= archiveVect.size())
+    {
+        throw exception::Exception("FileRecord refers to a missing archive.");
+    }
+    return *archiveVect[iFileRecord.archiveIndex];
+}
+
+const format::SidecarEntry* ANDatSnapshot::findSidecarEntry(const ANDatInterface::FileRecord& iFileRecord) const
+{
+    const ANDatSidecar* pAttachedSidecar = pSidecar;
+    if (pAttachedSidecar == nullptr)
+    {
+        return nullptr;
+    }
+
+    // The sidecar is keyed by fileId, it only holds the record found by it.
+    // Records are compared by location rather than address, so that a copy of the record is served from it too.
+    auto it = pIdDicts->fileIdDict.find(iFileRecord.fileId);
+    if (it == pIdDicts->fileIdDict.end())
+    {
+        return nullptr;
+    }
+
+    const ANDatInterface::FileRecord& aFoundFileRecord = (*pFileRecordVect)[it->second];
+    if (aFoundFileRecord.archiveIndex != iFileRecord.archiveIndex
+            || aFoundFileRecord.offset != iFileRecord.offset
+            || aFoundFileRecord.size != iFileRecord.size)
+    {
+        return nullptr;
+    }
+    return pAttachedSidecar->findEntry(iFileRecord.fileId);
+}
+
+void ANDatSnapshot::computeInternalData()
+{
+    std::vector<std::vector<ANDatInterface::FileRecord>> anArchiveRecordVects(archiveVect.size());
+
+    size_t aNbOfRecords = 0;
+    for (uint32_t anArchiveIndex = 0; anArchiveIndex < archiveVect.size(); ++anArchiveIndex)
+    {
+        archiveVect[anArchiveIndex]->computeFileRecords(anArchiveIndex, anArchiveRecordVects[anArchiveIndex]);
+        aNbOfRecords += anArchiveRecordVects[anArchiveIndex].size();
+    }
+
+    std::shared_ptr<std::vector<ANDatInterface::FileRecord>> pNewFileRecordVect(new std::vector<ANDatInterface::FileRecord>());
+    std::shared_ptr<ANDatIdDicts> pNewIdDicts(new ANDatIdDicts());
+
+    std::vector<ANDatInterface::FileRecord>& aFileRecordVect = *pNewFileRecordVect;
+    ANDatIdDicts& anIdDicts = *pNewIdDicts;
+
+    aFileRecordVect.reserve(aNbOfRecords);
+    anIdDicts.fileIdDict.rehash(aNbOfRecords);
+    anIdDicts.baseIdDict.rehash(aNbOfRecords);
+
+    // Archives by decreasing priority, records overridden by a previous archive are dropped
+    for (auto itArchive = anArchiveRecordVects.begin(); itArchive != anArchiveRecordVects.end(); ++itArchive)
+    {
+        for (auto itFileRecord = itArchive->begin(); itFileRecord != itArchive->end(); ++itFileRecord)
+        {
+            auto itFileIdDict = anIdDicts.fileIdDict.find(itFileRecord->fileId);
+            if (itFileIdDict != anIdDicts.fileIdDict.end() && aFileRecordVect[itFileIdDict->second].archiveIndex != itFileRecord->archiveIndex)
+            {
+                continue;
+            }
+
+            uint32_t aRecordIndex = static_cast<uint32_t>(aFileRecordVect.size());
+            aFileRecordVect.push_back(*itFileRecord);
+
+            anIdDicts.fileIdDict.insert(std::make_pair(itFileRecord->fileId, aRecordIndex));
+
+            if (itFileRecord->baseId != 0)
+            {
+                anIdDicts.baseIdDict.insert(std::make_pair(itFileRecord->baseId, aRecordIndex));
+            }
+        }
+    }
+
+    pFileRecordVect = pNewFileRecordVect;
+    isFileRecordVectShared = false;
+    pIdDicts = pNewIdDicts;
+    pDependencyGraph.reset(new ANDatDependencyGraph());
+}
+
+void ANDatSnapshot::copyInternalData(const ANDatSnapshot& iSnapshot)
+{
+    archiveVect = iSnapshot.archiveVect;
+
+    pIdDicts = iSnapshot.pIdDicts;
+    pFileRecordVect = iSnapshot.pFileRecordVect;
+    isFileRecordVectShared = true;
+    pDependencyGraph = iSnapshot.pDependencyGraph;
+
+    sidecarVect = iSnapshot.sidecarVect;
+    pSidecar = iSnapshot.pSidecar.load();
+}
+
+const std::vector<ANDatInterface::FileRecord>& ANDatSnapshot::getFileRecordVect() const
 {
-    std::ifstream aDatStream(iDatPath, std::ios::binary);
-    auto pANDat = format::parseANDat(aDatStream, 0, 0);
+    return *pFileRecordVect;
+}
 
-    auto pMft = format::parseMft(aDatStream, pANDat->header.mftOffset, pANDat->header.mftSize);
-    auto pMapping = format::parseMapping(aDatStream, pMft->entries[1].offset, pMft->entries[1].size);
+std::vector<ANDatInterface::FileRecord>& ANDatSnapshot::changeFileRecordVect()
+{
+    // The records of the published snapshots are left as they are, the ids still give the same indexes
+    if (isFileRecordVectShared)
+    {
+        pFileRecordVect.reset(new std::vector<ANDatInterface::FileRecord>(*pFileRecordVect));
+        isFileRecordVectShared = false;
+    }
+    return *pFileRecordVect;
+}
 
-    auto pANDatInterfaceImpl = std::unique_ptr<ANDatInterfaceImpl>(new ANDatInterfaceImpl(iDatPath, pMft, pMapping));
-    pANDatInterfaceImpl->computeInternalData();
+GW2DATTOOLS_API std::unique_ptr<ANDatInterface> GW2DATTOOLS_APIENTRY createANDatInterface(const char* iDatPath)
+{
+    return std::unique_ptr<ANDatInterface>(new ANDatInterfaceImpl(std::vector<std::string>(1, iDatPath)));
+}
 
-    return std::move(pANDatInterfaceImpl);
+GW2DATTOOLS_API std::unique_ptr<ANDatInterface> GW2DATTOOLS_APIENTRY createOverlayANDatInterface(const std::vector<std::string>& iDatPathVect)
+{
+    return std::unique_ptr<ANDatInterface>(new ANDatInterfaceImpl(iDatPathVect));
 }
 
 }
@@ -0,0 +1,87 @@
+#include "gw2DatTools/interface/ArchiveDiff.h"
+
+#include <algorithm>
+
+#include "../utils/Crc32c.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY isSameContent(const ANDatInterface::FileRecord& iOldFileRecord, const ANDatInterface::FileRecord& iNewFileRecord)
+{
+    if (iOldFileRecord.archiveIndex != iNewFileRecord.archiveIndex
+        || iOldFileRecord.size != iNewFileRecord.size || iOldFileRecord.isCompressed != iNewFileRecord.isCompressed)
+    {
+        return false;
+    }
+
+    // The CRC of a compressed record of a single block is always the residue, it tells nothing about the content.
+    // Such a record may have been rewritten in place with the same size, it is deemed changed.
+    auto isContentCrc = [](uint32_t iCrc) { return iCrc != 0 && iCrc != utils::sCrc32cResidue; };
+
+    return isContentCrc(iOldFileRecord.crc) && iOldFileRecord.crc == iNewFileRecord.crc;
+}
+
+std::vector<const ANDatInterface::FileRecord*> sortByFileId(const std::vector<ANDatInterface::FileRecord>& iFileRecordVect)
+{
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(iFileRecordVect.size());
+    for (auto it = iFileRecordVect.begin(); it != iFileRecordVect.end(); ++it)
+    {
+        aFileRecordPtrVect.push_back(&(*it));
+    }
+
+    std::sort(aFileRecordPtrVect.begin(), aFileRecordPtrVect.end(),
+        [](const ANDatInterface::FileRecord* ipLeft, const ANDatInterface::FileRecord* ipRight) { return ipLeft->fileId < ipRight->fileId; });
+    return aFileRecordPtrVect;
+}
+
+GW2DATTOOLS_API ArchiveDiff GW2DATTOOLS_APIENTRY diffFileRecords(const std::vector<ANDatInterface::FileRecord>& iOldFileRecordVect,
+                                                                 const std::vector<ANDatInterface::FileRecord>& iNewFileRecordVect)
+{
+    // Walking both versions by increasing fileId
+    std::vector<const ANDatInterface::FileRecord*> anOldFileRecordPtrVect = sortByFileId(iOldFileRecordVect);
+    std::vector<const ANDatInterface::FileRecord*> aNewFileRecordPtrVect = sortByFileId(iNewFileRecordVect);
+
+    ArchiveDiff anArchiveDiff;
+
+    auto itOld = anOldFileRecordPtrVect.begin();
+    auto itNew = aNewFileRecordPtrVect.begin();
+    while (itOld != anOldFileRecordPtrVect.end() || itNew != aNewFileRecordPtrVect.end())
+    {
+        if (itNew == aNewFileRecordPtrVect.end() || (itOld != anOldFileRecordPtrVect.end() && (*itOld)->fileId < (*itNew)->fileId))
+        {
+            anArchiveDiff.removedFileIdVect.push_back((*itOld)->fileId);
+            ++itOld;
+        }
+        else if (itOld == anOldFileRecordPtrVect.end() || (*itNew)->fileId < (*itOld)->fileId)
+        {
+            anArchiveDiff.addedFileIdVect.push_back((*itNew)->fileId);
+            ++itNew;
+        }
+        else
+        {
+            const ANDatInterface::FileRecord& anOldFileRecord = **itOld;
+            const ANDatInterface::FileRecord& aNewFileRecord = **itNew;
+
+            if (!isSameContent(anOldFileRecord, aNewFileRecord))
+            {
+                anArchiveDiff.changedFileIdVect.push_back(aNewFileRecord.fileId);
+            }
+            else if (anOldFileRecord.offset != aNewFileRecord.offset || anOldFileRecord.baseId != aNewFileRecord.baseId)
+            {
+                anArchiveDiff.remappedFileIdVect.push_back(aNewFileRecord.fileId);
+            }
+
+            ++itOld;
+            ++itNew;
+        }
+    }
+
+    return anArchiveDiff;
+}
+
+}
+}
@@ -0,0 +1,264 @@
+#include "gw2DatTools/interface/ArchiveExport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "RecordScanner.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+const uint32_t sExportContainerVersion = 1;
+
+// Compressed bytes scanned at once, records inflated ahead of a missing one wait at most for the end of the chunk
+const uint64_t sExportChunkInputSize = 64 * 1024 * 1024;
+// Output is written by blocks of at least this size
+const uint64_t sExportWriteSize = 8 * 1024 * 1024;
+
+// Writes the records of a chunk in storage order, whatever the order the threads inflate them in.
+// The next record to write goes straight to the output buffer, those inflated ahead of it wait in their slot.
+class ExportWriter
+{
+public:
+    ExportWriter(std::ostream& ioStream, uint64_t iOffset);
+
+    void startChunk(const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect);
+    // Called by the decoding threads, iRecordIndex is the index of the record in the chunk
+    void push(uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab);
+    // Writes the records left in the slots, those which were never pushed could not be inflated
+    void finishChunk();
+    // Writes the output buffer, returns the offset following the contents
+    uint64_t finish();
+
+    const std::vector<ExportContainerEntry>& getEntryVect() const;
+
+private:
+    enum SlotState
+    {
+        SS_PENDING,
+        SS_READY,
+        SS_WRITTEN
+    };
+
+    // Both called with _reorderMutex locked
+    void append(uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab);
+    void writeOutputBuffer(std::unique_lock<std::mutex>& ioReorderLock);
+
+    std::ostream& _stream;
+    uint64_t _offset;
+
+    // Guards everything but the stream and _writeBuffer
+    std::mutex _reorderMutex;
+    const std::vector<const ANDatInterface::FileRecord*>* _pFileRecordPtrVect;
+    std::vector<std::vector<uint8_t>> _slotVect;
+    std::vector<SlotState> _slotStateVect;
+    uint32_t _nextRecordIndex;
+    std::vector<uint8_t> _outputBuffer;
+    std::vector<ExportContainerEntry> _entryVect;
+
+    // Taken before _reorderMutex is released, so that blocks are written in order
+    std::mutex _writeMutex;
+    std::vector<uint8_t> _writeBuffer;
+};
+
+ExportWriter::ExportWriter(std::ostream& ioStream, uint64_t iOffset) :
+    _stream(ioStream),
+    _offset(iOffset),
+    _pFileRecordPtrVect(nullptr),
+    _nextRecordIndex(0)
+{
+    _outputBuffer.reserve(static_cast<size_t>(2 * sExportWriteSize));
+}
+
+void ExportWriter::startChunk(const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect)
+{
+    std::lock_guard<std::mutex> aLock(_reorderMutex);
+
+    _pFileRecordPtrVect = &iFileRecordPtrVect;
+    _slotVect.assign(iFileRecordPtrVect.size(), std::vector<uint8_t>());
+    _slotStateVect.assign(iFileRecordPtrVect.size(), SS_PENDING);
+    _nextRecordIndex = 0;
+}
+
+void ExportWriter::push(uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+{
+    std::unique_lock<std::mutex> aLock(_reorderMutex);
+
+    if (iRecordIndex != _nextRecordIndex)
+    {
+        _slotVect[iRecordIndex].assign(iTab, iTab + iSize);
+        _slotStateVect[iRecordIndex] = SS_READY;
+        return;
+    }
+
+    append(iRecordIndex, iSize, iTab);
+
+    // Records which were waiting for this one
+    while (_nextRecordIndex < _slotStateVect.size() && _slotStateVect[_nextRecordIndex] == SS_READY)
+    {
+        std::vector<uint8_t> aContent;
+        aContent.swap(_slotVect[_nextRecordIndex]);
+        append(_nextRecordIndex, static_cast<uint32_t>(aContent.size()), aContent.data());
+    }
+
+    if (_outputBuffer.size() >= sExportWriteSize)
+    {
+        writeOutputBuffer(aLock);
+    }
+}
+
+void ExportWriter::finishChunk()
+{
+    std::unique_lock<std::mutex> aLock(_reorderMutex);
+
+    for (; _nextRecordIndex < _slotStateVect.size(); ++_nextRecordIndex)
+    {
+        if (_slotStateVect[_nextRecordIndex] == SS_READY)
+        {
+            std::vector<uint8_t> aContent;
+            aContent.swap(_slotVect[_nextRecordIndex]);
+            append(_nextRecordIndex, static_cast<uint32_t>(aContent.size()), aContent.data());
+            --_nextRecordIndex;
+        }
+    }
+
+    if (_outputBuffer.size() >= sExportWriteSize)
+    {
+        writeOutputBuffer(aLock);
+    }
+}
+
+uint64_t ExportWriter::finish()
+{
+    std::unique_lock<std::mutex> aLock(_reorderMutex);
+    writeOutputBuffer(aLock);
+
+    std::lock_guard<std::mutex> aWriteLock(_writeMutex);
+    return _offset;
+}
+
+const std::vector<ExportContainerEntry>& ExportWriter::getEntryVect() const
+{
+    return _entryVect;
+}
+
+void ExportWriter::append(uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+{
+    const ANDatInterface::FileRecord& aFileRecord = *(*_pFileRecordPtrVect)[iRecordIndex];
+
+    ExportContainerEntry anEntry;
+    anEntry.fileId = aFileRecord.fileId;
+    anEntry.baseId = aFileRecord.baseId;
+    anEntry.size = iSize;
+    anEntry.offset = _offset;
+    _entryVect.push_back(anEntry);
+
+    _outputBuffer.insert(_outputBuffer.end(), iTab, iTab + iSize);
+    _offset += iSize;
+
+    _slotStateVect[iRecordIndex] = SS_WRITTEN;
+    ++_nextRecordIndex;
+}
+
+void ExportWriter::writeOutputBuffer(std::unique_lock<std::mutex>& ioReorderLock)
+{
+    // Waits for the previous block, then lets the threads fill the output buffer again while this one is written
+    std::lock_guard<std::mutex> aWriteLock(_writeMutex);
+    _writeBuffer.swap(_outputBuffer);
+    _outputBuffer.clear();
+    ioReorderLock.unlock();
+
+    _stream.write(reinterpret_cast<const char*>(_writeBuffer.data()), _writeBuffer.size());
+}
+
+GW2DATTOOLS_API uint32_t GW2DATTOOLS_APIENTRY exportArchive(ANDatInterface& ioANDatInterface, const char* iContainerPath, uint32_t iNbOfThreads)
+{
+    std::ofstream aStream(iContainerPath, std::ios::binary);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open the container file.");
+    }
+
+    // The container is indexed by fileId, only the record found by it is exported
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (it->size != 0 && &ioANDatInterface.getFileRecordForFileId(it->fileId) == &(*it))
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+    }
+
+    std::sort(aFileRecordPtrVect.begin(), aFileRecordPtrVect.end(),
+        [](const ANDatInterface::FileRecord* ipLeft, const ANDatInterface::FileRecord* ipRight) { return isStoredBefore(*ipLeft, *ipRight); });
+
+    // Header is written again once the index is known
+    ExportContainerHeader aHeader;
+    memcpy(aHeader.magic, "GW2X", 4);
+    aHeader.version = sExportContainerVersion;
+    aHeader.nbOfEntries = 0;
+    aHeader.indexOffset = 0;
+    aStream.write(reinterpret_cast<const char*>(&aHeader), sizeof(aHeader));
+
+    ExportWriter aWriter(aStream, sizeof(aHeader));
+    std::vector<const ANDatInterface::FileRecord*> aChunkVect;
+
+    auto itFirst = aFileRecordPtrVect.begin();
+    while (itFirst != aFileRecordPtrVect.end())
+    {
+        uint64_t anInputSize = 0;
+        auto itLast = itFirst;
+        while (itLast != aFileRecordPtrVect.end() && (itLast == itFirst || anInputSize + (*itLast)->size <= sExportChunkInputSize))
+        {
+            anInputSize += (*itLast)->size;
+            ++itLast;
+        }
+
+        aChunkVect.assign(itFirst, itLast);
+        aWriter.startChunk(aChunkVect);
+
+        scanRecords(ioANDatInterface, aChunkVect, iNbOfThreads, true,
+            [&aWriter](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+            {
+                aWriter.push(iRecordIndex, iSize, iTab);
+            });
+
+        aWriter.finishChunk();
+
+        if (!aStream)
+        {
+            throw exception::Exception("Could not write the container file.");
+        }
+
+        itFirst = itLast;
+    }
+
+    std::vector<ExportContainerEntry> anEntryVect(aWriter.getEntryVect());
+    std::sort(anEntryVect.begin(), anEntryVect.end(),
+        [](const ExportContainerEntry& iLeft, const ExportContainerEntry& iRight) { return iLeft.fileId < iRight.fileId; });
+
+    aHeader.nbOfEntries = static_cast<uint32_t>(anEntryVect.size());
+    aHeader.indexOffset = aWriter.finish();
+
+    aStream.write(reinterpret_cast<const char*>(anEntryVect.data()), anEntryVect.size() * sizeof(ExportContainerEntry));
+    aStream.seekp(0);
+    aStream.write(reinterpret_cast<const char*>(&aHeader), sizeof(aHeader));
+
+    if (!aStream)
+    {
+        throw exception::Exception("Could not write the container file.");
+    }
+
+    return aHeader.nbOfEntries;
+}
+
+}
+}
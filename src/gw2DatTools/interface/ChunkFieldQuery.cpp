@@ -0,0 +1,299 @@
+#include "gw2DatTools/interface/ChunkFieldQuery.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "gw2DatTools/exception/Exception.h"
+#include "gw2DatTools/format/PackFile.h"
+#include "gw2DatTools/format/StructView.h"
+
+#include "../format/SchemaWalk.h"
+#include "RecordScanner.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+const uint32_t sChunkFieldColumnFileVersion = 1;
+
+// Query resolved against the schema
+struct ResolvedQuery
+{
+    uint32_t packFileType;
+    uint32_t chunkMagic;
+    uint32_t chunkVersion;
+    std::vector<const format::SchemaField*> fieldPath;
+    uint32_t valueSize;
+};
+
+// Returns false if the path does not lead to a value of iRoot
+bool resolveFieldPath(const format::SchemaStruct& iRoot, const std::string& iFieldPath, std::vector<const format::SchemaField*>& oFieldPath)
+{
+    oFieldPath.clear();
+
+    const format::SchemaStruct* pStruct = &iRoot;
+    size_t aPos = 0;
+
+    while (aPos <= iFieldPath.size())
+    {
+        if (pStruct == nullptr)
+        {
+            return false; // Going through a value
+        }
+
+        size_t anEnd = iFieldPath.find('.', aPos);
+        if (anEnd == std::string::npos)
+        {
+            anEnd = iFieldPath.size();
+        }
+        std::string aName = iFieldPath.substr(aPos, anEnd - aPos);
+
+        auto itField = std::find_if(pStruct->fields.begin(), pStruct->fields.end(),
+            [&aName](const format::SchemaField& iField) { return iField.name == aName; });
+
+        if (itField == pStruct->fields.end() || !itField->isLocated)
+        {
+            return false;
+        }
+
+        // Elements laid next to each other shall be sized
+        bool isStrided = (itField->nbOfElements > 1 || itField->encoding == format::SE_ARRAY_PTR);
+        if (isStrided && format::getFieldElementSize(*itField) == 0)
+        {
+            return false;
+        }
+
+        oFieldPath.push_back(&(*itField));
+        pStruct = (itField->valueType == format::SVT_STRUCT) ? itField->pStruct : nullptr;
+
+        aPos = anEnd + 1;
+    }
+
+    switch (oFieldPath.back()->valueType)
+    {
+    case format::SVT_STRUCT:
+    case format::SVT_UNKNOWN:
+    case format::SVT_WCHAR_PTR:
+    case format::SVT_CHAR_PTR:
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+void resolveQuery(const format::ANStructsSchema& iSchema, const ChunkFieldQuery& iQuery, ResolvedQuery& oResolvedQuery)
+{
+    oResolvedQuery.packFileType = iQuery.packFileType;
+    oResolvedQuery.chunkVersion = iQuery.chunkVersion;
+
+    // Chunk names may appear several times, for different PackFile types
+    for (auto itChunk = iSchema.chunks.begin(); itChunk != iSchema.chunks.end(); ++itChunk)
+    {
+        if (itChunk->name != iQuery.chunkName)
+        {
+            continue;
+        }
+
+        for (auto itVersion = itChunk->versions.begin(); itVersion != itChunk->versions.end(); ++itVersion)
+        {
+            if (itVersion->version == iQuery.chunkVersion && itVersion->pRoot != nullptr
+                    && resolveFieldPath(*itVersion->pRoot, iQuery.fieldPath, oResolvedQuery.fieldPath))
+            {
+                oResolvedQuery.chunkMagic = itChunk->magic;
+
+                const format::SchemaField& aLeaf = *oResolvedQuery.fieldPath.back();
+                oResolvedQuery.valueSize = (aLeaf.valueType == format::SVT_FILENAME) ? sizeof(uint32_t) : format::getSchemaValueSize(aLeaf.valueType);
+                return;
+            }
+        }
+    }
+
+    throw exception::Exception("Field path does not match the schema.");
+}
+
+void extractValue(const format::ChunkSpan& iSpan, const uint8_t* ipPos, const format::SchemaField& iField, std::vector<uint8_t>& ioValueVect)
+{
+    if (iField.valueType == format::SVT_FILENAME)
+    {
+        format::FilenameView aFilename(iSpan, ipPos);
+        if (aFilename.isNull())
+        {
+            return; // Nothing is referenced
+        }
+
+        uint32_t aFileId = aFilename.getFileId();
+        ioValueVect.insert(ioValueVect.end(), reinterpret_cast<const uint8_t*>(&aFileId), reinterpret_cast<const uint8_t*>(&aFileId) + sizeof(aFileId));
+        return;
+    }
+
+    uint32_t aValueSize = format::getSchemaValueSize(iField.valueType);
+    iSpan.check(ipPos, aValueSize);
+    ioValueVect.insert(ioValueVect.end(), ipPos, ipPos + aValueSize);
+}
+
+void walkFieldPath(const format::ChunkSpan& iSpan, const uint8_t* ipStructPos, const std::vector<const format::SchemaField*>& iFieldPath,
+                   uint32_t iDepth, std::vector<uint8_t>& ioValueVect)
+{
+    const format::SchemaField& aField = *iFieldPath[iDepth];
+    bool isLeaf = (iDepth + 1 == iFieldPath.size());
+
+    format::forEachFieldElement(iSpan, ipStructPos, aField,
+        [&](const uint8_t* ipElementPos)
+        {
+            if (isLeaf)
+            {
+                extractValue(iSpan, ipElementPos, aField, ioValueVect);
+            }
+            else
+            {
+                walkFieldPath(iSpan, ipElementPos, iFieldPath, iDepth + 1, ioValueVect);
+            }
+        });
+}
+
+// Walks the chunks of a PackFile for every query, values are left empty if the record is broken
+void runQueries(const format::PackFile& iPackFile, const std::vector<ResolvedQuery>& iResolvedQueryVect, std::vector<std::vector<uint8_t>>& oValueVects)
+{
+    oValueVects.resize(iResolvedQueryVect.size());
+
+    try
+    {
+        uint32_t aPackFileType;
+        memcpy(&aPackFileType, iPackFile.pHeader->type, sizeof(aPackFileType));
+
+        for (auto itChunk = iPackFile.chunks.begin(); itChunk != iPackFile.chunks.end(); ++itChunk)
+        {
+            for (uint32_t aQueryIndex = 0; aQueryIndex < iResolvedQueryVect.size(); ++aQueryIndex)
+            {
+                const ResolvedQuery& aQuery = iResolvedQueryVect[aQueryIndex];
+                if (aQuery.chunkMagic == itChunk->magic && aQuery.chunkVersion == itChunk->version
+                        && (aQuery.packFileType == 0 || aQuery.packFileType == aPackFileType))
+                {
+                    walkFieldPath(format::ChunkSpan(*itChunk), itChunk->pData, aQuery.fieldPath, 0, oValueVects[aQueryIndex]);
+                }
+            }
+        }
+    }
+    catch(std::exception&)
+    {
+        // Values of a broken record are not kept
+        for (auto it = oValueVects.begin(); it != oValueVects.end(); ++it)
+        {
+            it->clear();
+        }
+    }
+}
+
+// Records which may hold chunks of the queries
+bool isQueried(const ANDatInterface::FileRecord& iFileRecord, const std::vector<ResolvedQuery>& iResolvedQueryVect)
+{
+    for (auto it = iResolvedQueryVect.begin(); it != iResolvedQueryVect.end(); ++it)
+    {
+        if (isPackFileCandidate(iFileRecord, it->packFileType))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+GW2DATTOOLS_API std::vector<ChunkFieldColumn> GW2DATTOOLS_APIENTRY runChunkFieldQueries(ANDatInterface& ioANDatInterface, const format::ANStructsSchema& iSchema,
+                                                                                         const std::vector<ChunkFieldQuery>& iQueryVect, uint32_t iNbOfThreads)
+{
+    std::vector<ResolvedQuery> aResolvedQueryVect(iQueryVect.size());
+    std::vector<ChunkFieldColumn> aColumnVect(iQueryVect.size());
+
+    for (uint32_t aQueryIndex = 0; aQueryIndex < iQueryVect.size(); ++aQueryIndex)
+    {
+        resolveQuery(iSchema, iQueryVect[aQueryIndex], aResolvedQueryVect[aQueryIndex]);
+
+        aColumnVect[aQueryIndex].valueType = aResolvedQueryVect[aQueryIndex].fieldPath.back()->valueType;
+        aColumnVect[aQueryIndex].valueSize = aResolvedQueryVect[aQueryIndex].valueSize;
+    }
+
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (isQueried(*it, aResolvedQueryVect))
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+    }
+
+    // Values per record, then per query
+    std::vector<std::vector<std::vector<uint8_t>>> aRecordValueVects(aFileRecordPtrVect.size());
+
+    scanPackFiles(ioANDatInterface, aFileRecordPtrVect, iNbOfThreads,
+        [&aResolvedQueryVect, &aRecordValueVects](uint32_t iRecordIndex, const format::PackFile& iPackFile)
+        {
+            runQueries(iPackFile, aResolvedQueryVect, aRecordValueVects[iRecordIndex]);
+        });
+
+    // Appending the values in record order
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aFileRecordPtrVect.size(); ++aRecordIndex)
+    {
+        const std::vector<std::vector<uint8_t>>& aValueVects = aRecordValueVects[aRecordIndex];
+        if (aValueVects.empty())
+        {
+            continue; // Skipped by the scan
+        }
+
+        for (uint32_t aQueryIndex = 0; aQueryIndex < aColumnVect.size(); ++aQueryIndex)
+        {
+            ChunkFieldColumn& aColumn = aColumnVect[aQueryIndex];
+            const std::vector<uint8_t>& aValueVect = aValueVects[aQueryIndex];
+
+            aColumn.fileIdVect.insert(aColumn.fileIdVect.end(), aValueVect.size() / aColumn.valueSize, aFileRecordPtrVect[aRecordIndex]->fileId);
+            aColumn.valueVect.insert(aColumn.valueVect.end(), aValueVect.begin(), aValueVect.end());
+        }
+    }
+
+    return aColumnVect;
+}
+
+void writePadding(std::ostream& iStream, uint64_t iAlignment)
+{
+    static const char sZeroTab[16] = {};
+    uint64_t aPos = static_cast<uint64_t>(iStream.tellp());
+    iStream.write(sZeroTab, static_cast<std::streamsize>((iAlignment - (aPos % iAlignment)) % iAlignment));
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY saveChunkFieldColumn(const ChunkFieldColumn& iColumn, const char* iPath)
+{
+    std::ofstream aStream(iPath, std::ios::binary);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open the column file.");
+    }
+
+    const uint64_t anAlignment = 16;
+    uint64_t aNbOfValues = iColumn.fileIdVect.size();
+
+    ChunkFieldColumnFileHeader aHeader;
+    memcpy(aHeader.magic, "GW2C", 4);
+    aHeader.version = sChunkFieldColumnFileVersion;
+    aHeader.valueType = iColumn.valueType;
+    aHeader.valueSize = iColumn.valueSize;
+    aHeader.nbOfValues = aNbOfValues;
+    aHeader.fileIdOffset = (sizeof(aHeader) + anAlignment - 1) / anAlignment * anAlignment;
+    aHeader.valueOffset = (aHeader.fileIdOffset + aNbOfValues * sizeof(uint32_t) + anAlignment - 1) / anAlignment * anAlignment;
+
+    aStream.write(reinterpret_cast<const char*>(&aHeader), sizeof(aHeader));
+    writePadding(aStream, anAlignment);
+    aStream.write(reinterpret_cast<const char*>(iColumn.fileIdVect.data()), aNbOfValues * sizeof(uint32_t));
+    writePadding(aStream, anAlignment);
+    aStream.write(reinterpret_cast<const char*>(iColumn.valueVect.data()), iColumn.valueVect.size());
+
+    if (!aStream)
+    {
+        throw exception::Exception("Could not write the column file.");
+    }
+}
+
+}
+}
@@ -0,0 +1,258 @@
+#include "gw2DatTools/interface/ContentSearch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "RecordScanner.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GW2DATTOOLS_SEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Looks for several patterns at once. Positions are first filtered on the first two
+// bytes of the patterns, sixteen at a time with SSE2 when there are few distinct
+// prefixes, then each candidate is compared to the patterns sharing its prefix.
+class MultiPatternMatcher
+{
+public:
+    explicit MultiPatternMatcher(const std::vector<std::string>& iPatternVect);
+
+    // Appends the hits of the content, stops once iMaxHits are found (0 for no limit)
+    void match(uint32_t iSize, const uint8_t* iTab, uint32_t iMaxHits, uint32_t iFileId, std::vector<ContentSearchHit>& ioHitVect) const;
+
+private:
+    // Above this, comparing every prefix costs more than looking the bitmaps up
+    static const uint32_t sMaxSimdPrefixes = 8;
+
+    struct Prefix
+    {
+        uint8_t firstByte;
+        uint8_t secondByte;
+        bool isSingleByte;      // Prefix of a one byte pattern
+    };
+
+    bool isCandidate(uint32_t iSize, const uint8_t* iTab, uint32_t iPos) const;
+
+    // Returns false once iMaxHits are found
+    bool checkCandidate(uint32_t iSize, const uint8_t* iTab, uint32_t iPos, uint32_t iMaxHits, uint32_t iFileId,
+                        uint32_t& ioNbOfHits, std::vector<ContentSearchHit>& ioHitVect) const;
+
+    const std::vector<std::string>& _patternVect;
+
+    std::vector<Prefix> _prefixVect;
+
+    // One bit per first byte of the one byte patterns, and per first two bytes of the others
+    std::vector<uint64_t> _byteBitmap;
+    std::vector<uint64_t> _pairBitmap;
+
+    // Patterns per prefix, in increasing index
+    std::vector<uint32_t> _bytePatternVects[256];
+    std::unordered_map<uint32_t, std::vector<uint32_t>> _pairPatternDict;
+};
+
+inline bool testBit(const std::vector<uint64_t>& iBitmap, uint32_t iIndex)
+{
+    return (iBitmap[iIndex >> 6] >> (iIndex & 63)) & 1;
+}
+
+MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string>& iPatternVect) :
+    _patternVect(iPatternVect),
+    _byteBitmap(256 / 64, 0),
+    _pairBitmap(65536 / 64, 0)
+{
+    for (uint32_t aPatternIndex = 0; aPatternIndex < iPatternVect.size(); ++aPatternIndex)
+    {
+        const std::string& aPattern = iPatternVect[aPatternIndex];
+        if (aPattern.empty())
+        {
+            throw exception::Exception("Patterns shall not be empty.");
+        }
+
+        Prefix aPrefix;
+        aPrefix.firstByte = static_cast<uint8_t>(aPattern[0]);
+        aPrefix.secondByte = (aPattern.size() > 1) ? static_cast<uint8_t>(aPattern[1]) : 0;
+        aPrefix.isSingleByte = (aPattern.size() == 1);
+
+        auto itPrefix = std::find_if(_prefixVect.begin(), _prefixVect.end(), [&aPrefix](const Prefix& iPrefix)
+            {
+                return iPrefix.firstByte == aPrefix.firstByte && iPrefix.secondByte == aPrefix.secondByte && iPrefix.isSingleByte == aPrefix.isSingleByte;
+            });
+        if (itPrefix == _prefixVect.end())
+        {
+            _prefixVect.push_back(aPrefix);
+        }
+
+        if (aPrefix.isSingleByte)
+        {
+            _byteBitmap[aPrefix.firstByte >> 6] |= 1ULL << (aPrefix.firstByte & 63);
+            _bytePatternVects[aPrefix.firstByte].push_back(aPatternIndex);
+        }
+        else
+        {
+            uint32_t aKey = aPrefix.firstByte | (aPrefix.secondByte << 8);
+            _pairBitmap[aKey >> 6] |= 1ULL << (aKey & 63);
+            _pairPatternDict[aKey].push_back(aPatternIndex);
+        }
+    }
+}
+
+bool MultiPatternMatcher::isCandidate(uint32_t iSize, const uint8_t* iTab, uint32_t iPos) const
+{
+    if (testBit(_byteBitmap, iTab[iPos]))
+    {
+        return true;
+    }
+    return iPos + 1 < iSize && testBit(_pairBitmap, iTab[iPos] | (iTab[iPos + 1] << 8));
+}
+
+bool MultiPatternMatcher::checkCandidate(uint32_t iSize, const uint8_t* iTab, uint32_t iPos, uint32_t iMaxHits, uint32_t iFileId,
+                                         uint32_t& ioNbOfHits, std::vector<ContentSearchHit>& ioHitVect) const
+{
+    static const std::vector<uint32_t> sEmptyVect;
+
+    const std::vector<uint32_t>& aByteVect = _bytePatternVects[iTab[iPos]];
+    const std::vector<uint32_t>* pPairVect = &sEmptyVect;
+    if (iPos + 1 < iSize)
+    {
+        auto it = _pairPatternDict.find(iTab[iPos] | (iTab[iPos + 1] << 8));
+        if (it != _pairPatternDict.end())
+        {
+            pPairVect = &it->second;
+        }
+    }
+
+    // Merging both lists, so that the hits of a position follow the pattern order
+    auto itByte = aByteVect.begin();
+    auto itPair = pPairVect->begin();
+    while (itByte != aByteVect.end() || itPair != pPairVect->end())
+    {
+        uint32_t aPatternIndex;
+        if (itPair == pPairVect->end() || (itByte != aByteVect.end() && *itByte < *itPair))
+        {
+            aPatternIndex = *itByte++;
+        }
+        else
+        {
+            aPatternIndex = *itPair++;
+        }
+
+        const std::string& aPattern = _patternVect[aPatternIndex];
+        if (aPattern.size() > iSize - iPos || memcmp(iTab + iPos, aPattern.data(), aPattern.size()) != 0)
+        {
+            continue;
+        }
+
+        ContentSearchHit aHit;
+        aHit.fileId = iFileId;
+        aHit.patternIndex = aPatternIndex;
+        aHit.offset = iPos;
+        ioHitVect.push_back(aHit);
+
+        ++ioNbOfHits;
+        if (ioNbOfHits == iMaxHits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MultiPatternMatcher::match(uint32_t iSize, const uint8_t* iTab, uint32_t iMaxHits, uint32_t iFileId, std::vector<ContentSearchHit>& ioHitVect) const
+{
+    uint32_t aNbOfHits = 0;
+    uint32_t aPos = 0;
+
+#ifdef GW2DATTOOLS_SEARCH_SSE2
+    const uint32_t aNbOfPrefixes = static_cast<uint32_t>(_prefixVect.size());
+    if (aNbOfPrefixes <= sMaxSimdPrefixes)
+    {
+        __m128i aFirstByteTab[sMaxSimdPrefixes];
+        __m128i aSecondByteTab[sMaxSimdPrefixes];
+        for (uint32_t aPrefixIndex = 0; aPrefixIndex < aNbOfPrefixes; ++aPrefixIndex)
+        {
+            aFirstByteTab[aPrefixIndex] = _mm_set1_epi8(static_cast<char>(_prefixVect[aPrefixIndex].firstByte));
+            aSecondByteTab[aPrefixIndex] = _mm_set1_epi8(static_cast<char>(_prefixVect[aPrefixIndex].secondByte));
+        }
+
+        // The second bytes of the sixteen positions are read as well
+        for (; iSize >= 17 && aPos <= iSize - 17; aPos += 16)
+        {
+            __m128i aFirstBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iTab + aPos));
+            __m128i aSecondBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iTab + aPos + 1));
+
+            __m128i aMatches = _mm_setzero_si128();
+            for (uint32_t aPrefixIndex = 0; aPrefixIndex < aNbOfPrefixes; ++aPrefixIndex)
+            {
+                __m128i aPrefixMatches = _mm_cmpeq_epi8(aFirstBytes, aFirstByteTab[aPrefixIndex]);
+                if (!_prefixVect[aPrefixIndex].isSingleByte)
+                {
+                    aPrefixMatches = _mm_and_si128(aPrefixMatches, _mm_cmpeq_epi8(aSecondBytes, aSecondByteTab[aPrefixIndex]));
+                }
+                aMatches = _mm_or_si128(aMatches, aPrefixMatches);
+            }
+
+            uint32_t aMask = static_cast<uint32_t>(_mm_movemask_epi8(aMatches));
+            for (uint32_t anIndex = 0; aMask != 0; ++anIndex, aMask >>= 1)
+            {
+                if ((aMask & 1) && !checkCandidate(iSize, iTab, aPos + anIndex, iMaxHits, iFileId, aNbOfHits, ioHitVect))
+                {
+                    return;
+                }
+            }
+        }
+    }
+#endif
+
+    for (; aPos < iSize; ++aPos)
+    {
+        if (isCandidate(iSize, iTab, aPos) && !checkCandidate(iSize, iTab, aPos, iMaxHits, iFileId, aNbOfHits, ioHitVect))
+        {
+            return;
+        }
+    }
+}
+
+GW2DATTOOLS_API std::vector<ContentSearchHit> GW2DATTOOLS_APIENTRY searchContent(ANDatInterface& ioANDatInterface, const std::vector<std::string>& iPatternVect,
+                                                                                 uint32_t iMaxHitsPerFile, uint32_t iNbOfThreads)
+{
+    MultiPatternMatcher aMatcher(iPatternVect);
+
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (it->size != 0)
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+    }
+
+    // Hits per record
+    std::vector<std::vector<ContentSearchHit>> aRecordHitVects(aFileRecordPtrVect.size());
+
+    scanRecords(ioANDatInterface, aFileRecordPtrVect, iNbOfThreads, true,
+        [&aMatcher, &aFileRecordPtrVect, &aRecordHitVects, iMaxHitsPerFile](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+        {
+            aMatcher.match(iSize, iTab, iMaxHitsPerFile, aFileRecordPtrVect[iRecordIndex]->fileId, aRecordHitVects[iRecordIndex]);
+        });
+
+    std::vector<ContentSearchHit> aHitVect;
+    for (auto it = aRecordHitVects.begin(); it != aRecordHitVects.end(); ++it)
+    {
+        aHitVect.insert(aHitVect.end(), it->begin(), it->end());
+    }
+    return aHitVect;
+}
+
+}
+}
@@ -0,0 +1,225 @@
+#include "gw2DatTools/interface/ContentStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "../utils/Crc32c.h"
+#include "../utils/MurmurHash3.h"
+#include "RecordScanner.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+const uint32_t sContentManifestVersion = 1;
+
+bool isExistingFile(const std::string& iPath)
+{
+    std::ifstream aStream(iPath, std::ios::binary);
+    return aStream.good();
+}
+
+// Writes the content under a temporary name first, so that an interrupted extraction leaves no partial content
+bool writeContent(const std::string& iContentPath, uint32_t iSize, const uint8_t* iTab)
+{
+    const std::string aTemporaryPath = iContentPath + ".tmp";
+    {
+        std::ofstream aStream(aTemporaryPath, std::ios::binary);
+        aStream.write(reinterpret_cast<const char*>(iTab), iSize);
+        if (!aStream)
+        {
+            return false;
+        }
+    }
+
+    if (std::rename(aTemporaryPath.c_str(), iContentPath.c_str()) != 0)
+    {
+        std::remove(aTemporaryPath.c_str());
+        return isExistingFile(iContentPath);
+    }
+    return true;
+}
+
+GW2DATTOOLS_API std::string GW2DATTOOLS_APIENTRY getContentPath(const char* iStorePath, const ContentManifestEntry& iEntry)
+{
+    char aName[33];
+    snprintf(aName, sizeof(aName), "%016llx%016llx", static_cast<unsigned long long>(iEntry.hash[1]), static_cast<unsigned long long>(iEntry.hash[0]));
+    return std::string(iStorePath) + "/" + aName;
+}
+
+GW2DATTOOLS_API bool GW2DATTOOLS_APIENTRY loadContentManifest(const char* iManifestPath, std::vector<ContentManifestEntry>& oEntryVect)
+{
+    std::ifstream aStream(iManifestPath, std::ios::binary);
+    if (!aStream)
+    {
+        return false;
+    }
+
+    aStream.seekg(0, std::ios::end);
+    uint64_t aManifestSize = aStream.tellg();
+    aStream.seekg(0);
+
+    ContentManifestHeader aHeader;
+    aStream.read(reinterpret_cast<char*>(&aHeader), sizeof(aHeader));
+
+    if (!aStream
+            || memcmp(aHeader.magic, "GW2M", 4) != 0
+            || aHeader.version != sContentManifestVersion
+            || aHeader.nbOfEntries != (aManifestSize - sizeof(aHeader)) / sizeof(ContentManifestEntry))
+    {
+        return false;
+    }
+
+    oEntryVect.resize(aHeader.nbOfEntries);
+    aStream.read(reinterpret_cast<char*>(oEntryVect.data()), oEntryVect.size() * sizeof(ContentManifestEntry));
+    return !aStream.fail();
+}
+
+GW2DATTOOLS_API ContentStoreStats GW2DATTOOLS_APIENTRY extractToContentStore(ANDatInterface& ioANDatInterface, const char* iStorePath, const char* iManifestPath,
+                                                                             const char* iPreviousManifestPath, uint32_t iNbOfThreads)
+{
+    ContentStoreStats aStats;
+    aStats.nbOfRecords = 0;
+    aStats.nbOfReusedRecords = 0;
+    aStats.nbOfWrittenContents = 0;
+    aStats.nbOfWrittenBytes = 0;
+
+    std::unordered_map<uint32_t, ContentManifestEntry> aPreviousEntryDict;
+    std::vector<ContentManifestEntry> aPreviousEntryVect;
+    if (iPreviousManifestPath != nullptr && loadContentManifest(iPreviousManifestPath, aPreviousEntryVect))
+    {
+        for (auto it = aPreviousEntryVect.begin(); it != aPreviousEntryVect.end(); ++it)
+        {
+            aPreviousEntryDict.insert(std::make_pair(it->fileId, *it));
+        }
+    }
+
+    std::vector<ContentManifestEntry> anEntryVect;
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        // The manifest is keyed by fileId, only the record found by it is extracted
+        if (it->size == 0 || &ioANDatInterface.getFileRecordForFileId(it->fileId) != &(*it))
+        {
+            continue;
+        }
+
+        // A record whose stored content has the same CRC is not read again, if its content is still in the store.
+        // The CRC of a compressed record of a single block tells nothing about its content.
+        auto itPrevious = aPreviousEntryDict.find(it->fileId);
+        if (itPrevious != aPreviousEntryDict.end()
+                && itPrevious->second.size == it->size
+                && itPrevious->second.crc == it->crc
+                && it->crc != 0 && it->crc != utils::sCrc32cResidue
+                && isExistingFile(getContentPath(iStorePath, itPrevious->second)))
+        {
+            anEntryVect.push_back(itPrevious->second);
+            ++aStats.nbOfReusedRecords;
+            continue;
+        }
+
+        aFileRecordPtrVect.push_back(&(*it));
+    }
+
+    // Entry per scanned record, set by the thread which inflated it
+    std::vector<ContentManifestEntry> aScannedEntryVect(aFileRecordPtrVect.size());
+    std::vector<uint8_t> isScannedVect(aFileRecordPtrVect.size(), 0);
+
+    // Contents being written by this extraction, so that two threads never write the same one
+    std::set<std::pair<uint64_t, uint64_t>> aClaimedHashSet;
+    std::mutex aClaimedHashMutex;
+
+    std::atomic<uint32_t> aNbOfWrittenContents(0);
+    std::atomic<uint64_t> aNbOfWrittenBytes(0);
+    std::atomic<bool> hasWriteFailed(false);
+
+    scanRecords(ioANDatInterface, aFileRecordPtrVect, iNbOfThreads, true,
+        [iStorePath, &aFileRecordPtrVect, &aScannedEntryVect, &isScannedVect, &aClaimedHashSet, &aClaimedHashMutex,
+         &aNbOfWrittenContents, &aNbOfWrittenBytes, &hasWriteFailed](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+        {
+            const ANDatInterface::FileRecord& aFileRecord = *aFileRecordPtrVect[iRecordIndex];
+
+            // Hashed by the thread which just inflated it, while it is in its cache
+            ContentManifestEntry& anEntry = aScannedEntryVect[iRecordIndex];
+            anEntry.fileId = aFileRecord.fileId;
+            anEntry.size = aFileRecord.size;
+            anEntry.crc = aFileRecord.crc;
+            anEntry.contentSize = iSize;
+            utils::computeMurmurHash3(iTab, iSize, anEntry.hash);
+
+            bool isClaimed;
+            {
+                std::lock_guard<std::mutex> aLock(aClaimedHashMutex);
+                isClaimed = aClaimedHashSet.insert(std::make_pair(anEntry.hash[0], anEntry.hash[1])).second;
+            }
+
+            const std::string aContentPath = getContentPath(iStorePath, anEntry);
+            if (isClaimed && !isExistingFile(aContentPath))
+            {
+                if (!writeContent(aContentPath, iSize, iTab))
+                {
+                    hasWriteFailed = true;
+                    return;
+                }
+
+                ++aNbOfWrittenContents;
+                aNbOfWrittenBytes += iSize;
+            }
+
+            isScannedVect[iRecordIndex] = 1;
+        });
+
+    if (hasWriteFailed)
+    {
+        throw exception::Exception("Could not write to the content store.");
+    }
+
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aScannedEntryVect.size(); ++aRecordIndex)
+    {
+        if (isScannedVect[aRecordIndex])
+        {
+            anEntryVect.push_back(aScannedEntryVect[aRecordIndex]);
+        }
+    }
+
+    std::sort(anEntryVect.begin(), anEntryVect.end(),
+        [](const ContentManifestEntry& iLeft, const ContentManifestEntry& iRight) { return iLeft.fileId < iRight.fileId; });
+
+    std::ofstream aStream(iManifestPath, std::ios::binary);
+    if (!aStream)
+    {
+        throw exception::Exception("Could not open the manifest file.");
+    }
+
+    ContentManifestHeader aHeader;
+    memcpy(aHeader.magic, "GW2M", 4);
+    aHeader.version = sContentManifestVersion;
+    aHeader.nbOfEntries = static_cast<uint32_t>(anEntryVect.size());
+
+    aStream.write(reinterpret_cast<const char*>(&aHeader), sizeof(aHeader));
+    aStream.write(reinterpret_cast<const char*>(anEntryVect.data()), anEntryVect.size() * sizeof(ContentManifestEntry));
+
+    if (!aStream)
+    {
+        throw exception::Exception("Could not write the manifest file.");
+    }
+
+    aStats.nbOfRecords = static_cast<uint32_t>(anEntryVect.size());
+    aStats.nbOfWrittenContents = aNbOfWrittenContents;
+    aStats.nbOfWrittenBytes = aNbOfWrittenBytes;
+    return aStats;
+}
+
+}
+}
@@ -0,0 +1,492 @@
+#include "gw2DatTools/interface/DecodeScheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "../compression/DatFileInflater.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+const uint32_t sNbOfDecodePriorities = 3;
+
+// Output inflated between two checks of a decode
+const uint32_t sDecodeStepSize = 65536;
+
+class DecodeJob : public DecodeTicket
+{
+public:
+    DecodeJob(DecodeScheduler::Priority iPriority, uint32_t iDeadlineMs);
+    virtual ~DecodeJob();
+
+    virtual void cancel();
+    virtual Status getStatus() const;
+    virtual Status wait();
+    virtual Status waitFor(uint32_t iTimeoutMs);
+    virtual const std::vector<uint8_t>& getBuffer() const;
+    virtual const std::string& getErrorMessage() const;
+
+    // Ends the decode, unless it was cancelled meanwhile
+    void finish(Status iStatus, const std::string& iErrorMessage = std::string());
+
+    bool isCancelled() const;
+    bool isExpired() const;
+
+    DecodeScheduler::Priority priority;
+
+    // Input, pFileRecord is nullptr for a submitted buffer
+    const ANDatInterface::FileRecord* pFileRecord;
+    uint32_t inputSize;
+    const uint8_t* pInputTab;
+
+    // Decoding state, used by one thread at a time, the one running the job
+    bool isStarted;
+    std::vector<uint8_t> rawBuffer;
+    std::unique_ptr<compression::dat::DatFileInflater> pInflater;
+    uint32_t outputPos;
+    std::vector<uint8_t> outputBuffer;
+
+private:
+    bool _hasDeadline;
+    std::chrono::steady_clock::time_point _deadline;
+    std::atomic<bool> _isCancelled;
+
+    mutable std::mutex _statusMutex;
+    std::condition_variable _statusCondition;
+    Status _status;
+    std::string _errorMessage;
+};
+
+DecodeJob::DecodeJob(DecodeScheduler::Priority iPriority, uint32_t iDeadlineMs) :
+    priority(iPriority),
+    pFileRecord(nullptr),
+    inputSize(0),
+    pInputTab(nullptr),
+    isStarted(false),
+    outputPos(0),
+    _hasDeadline(iDeadlineMs != 0),
+    _deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(iDeadlineMs)),
+    _isCancelled(false),
+    _status(ST_PENDING)
+{
+}
+
+DecodeJob::~DecodeJob()
+{
+}
+
+void DecodeJob::cancel()
+{
+    _isCancelled = true;
+
+    // Waiters do not wait for a thread to pick the job up
+    {
+        std::lock_guard<std::mutex> aLock(_statusMutex);
+        if (_status != ST_PENDING)
+        {
+            return;
+        }
+        _status = ST_CANCELLED;
+    }
+    _statusCondition.notify_all();
+}
+
+DecodeTicket::Status DecodeJob::getStatus() const
+{
+    std::lock_guard<std::mutex> aLock(_statusMutex);
+    return _status;
+}
+
+DecodeTicket::Status DecodeJob::wait()
+{
+    std::unique_lock<std::mutex> aLock(_statusMutex);
+    _statusCondition.wait(aLock, [this]() { return _status != ST_PENDING; });
+    return _status;
+}
+
+DecodeTicket::Status DecodeJob::waitFor(uint32_t iTimeoutMs)
+{
+    std::unique_lock<std::mutex> aLock(_statusMutex);
+    _statusCondition.wait_for(aLock, std::chrono::milliseconds(iTimeoutMs), [this]() { return _status != ST_PENDING; });
+    return _status;
+}
+
+const std::vector<uint8_t>& DecodeJob::getBuffer() const
+{
+    return outputBuffer;
+}
+
+const std::string& DecodeJob::getErrorMessage() const
+{
+    return _errorMessage;
+}
+
+void DecodeJob::finish(Status iStatus, const std::string& iErrorMessage)
+{
+    // Decoding state is not needed anymore
+    rawBuffer = std::vector<uint8_t>();
+    pInflater.reset();
+
+    {
+        std::lock_guard<std::mutex> aLock(_statusMutex);
+        if (_status != ST_PENDING)
+        {
+            return;
+        }
+        _status = iStatus;
+        _errorMessage = iErrorMessage;
+    }
+    _statusCondition.notify_all();
+}
+
+bool DecodeJob::isCancelled() const
+{
+    return _isCancelled;
+}
+
+bool DecodeJob::isExpired() const
+{
+    return _hasDeadline && std::chrono::steady_clock::now() >= _deadline;
+}
+
+class DecodeSchedulerImpl : public DecodeScheduler
+{
+public:
+    DecodeSchedulerImpl(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads);
+    virtual ~DecodeSchedulerImpl();
+
+    virtual std::shared_ptr<DecodeTicket> submit(const ANDatInterface::FileRecord& iFileRecord, Priority iPriority, uint32_t iDeadlineMs);
+    virtual std::shared_ptr<DecodeTicket> submitBuffer(uint32_t iInputSize, const uint8_t* iInputTab, Priority iPriority, uint32_t iDeadlineMs);
+
+private:
+    struct JobQueues
+    {
+        std::mutex mutex;
+        std::array<std::deque<std::shared_ptr<DecodeJob>>, sNbOfDecodePriorities> jobDequeArray;
+    };
+
+    // A resumed job goes first in the queue of its thread
+    void push(const std::shared_ptr<DecodeJob>& ipJob, uint32_t iThreadIndex, bool iIsResumed);
+    // Most urgent job, from the queues of the thread first, stolen from the other threads otherwise
+    std::shared_ptr<DecodeJob> pop(uint32_t iThreadIndex);
+
+    bool hasQueuedJobBefore(Priority iPriority) const;
+    bool hasQueuedJob() const;
+
+    void runWorker(uint32_t iThreadIndex);
+    void runJob(const std::shared_ptr<DecodeJob>& ipJob, uint32_t iThreadIndex);
+    void startJob(DecodeJob& ioJob);
+
+    ANDatInterface& _ANDatInterface;
+
+    std::vector<std::unique_ptr<JobQueues>> _jobQueuesVect;
+    std::array<std::atomic<uint32_t>, sNbOfDecodePriorities> _nbOfQueuedJobsArray;
+    std::atomic<uint32_t> _nextThreadIndex;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<bool> _isStopping;
+
+    std::vector<std::thread> _threadVect;
+};
+
+DecodeSchedulerImpl::DecodeSchedulerImpl(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads) :
+    _ANDatInterface(ioANDatInterface),
+    _nextThreadIndex(0),
+    _isStopping(false)
+{
+    for (auto it = _nbOfQueuedJobsArray.begin(); it != _nbOfQueuedJobsArray.end(); ++it)
+    {
+        *it = 0;
+    }
+
+    uint32_t aNbOfThreads = (iNbOfThreads != 0) ? iNbOfThreads : std::thread::hardware_concurrency();
+    aNbOfThreads = std::max(1u, aNbOfThreads);
+
+    for (uint32_t aThreadIndex = 0; aThreadIndex < aNbOfThreads; ++aThreadIndex)
+    {
+        _jobQueuesVect.push_back(std::unique_ptr<JobQueues>(new JobQueues()));
+    }
+
+    for (uint32_t aThreadIndex = 0; aThreadIndex < aNbOfThreads; ++aThreadIndex)
+    {
+        try
+        {
+            _threadVect.push_back(std::thread(&DecodeSchedulerImpl::runWorker, this, aThreadIndex));
+        }
+        catch(std::exception&)
+        {
+            break;
+        }
+    }
+
+    if (_threadVect.empty())
+    {
+        throw exception::Exception("Could not start the decoding threads.");
+    }
+    // Jobs queued for a thread which could not be started are stolen by the others
+}
+
+DecodeSchedulerImpl::~DecodeSchedulerImpl()
+{
+    {
+        std::lock_guard<std::mutex> aLock(_sleepMutex);
+        _isStopping = true;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto it = _threadVect.begin(); it != _threadVect.end(); ++it)
+    {
+        it->join();
+    }
+
+    for (auto itQueues = _jobQueuesVect.begin(); itQueues != _jobQueuesVect.end(); ++itQueues)
+    {
+        for (auto itDeque = (*itQueues)->jobDequeArray.begin(); itDeque != (*itQueues)->jobDequeArray.end(); ++itDeque)
+        {
+            for (auto itJob = itDeque->begin(); itJob != itDeque->end(); ++itJob)
+            {
+                (*itJob)->cancel();
+            }
+        }
+    }
+}
+
+std::shared_ptr<DecodeTicket> DecodeSchedulerImpl::submit(const ANDatInterface::FileRecord& iFileRecord, Priority iPriority, uint32_t iDeadlineMs)
+{
+    std::shared_ptr<DecodeJob> pJob(new DecodeJob(iPriority, iDeadlineMs));
+    pJob->pFileRecord = &iFileRecord;
+
+    push(pJob, _nextThreadIndex++ % _jobQueuesVect.size(), false);
+    return pJob;
+}
+
+std::shared_ptr<DecodeTicket> DecodeSchedulerImpl::submitBuffer(uint32_t iInputSize, const uint8_t* iInputTab, Priority iPriority, uint32_t iDeadlineMs)
+{
+    if (iInputTab == nullptr)
+    {
+        throw exception::Exception("Input buffer is null.");
+    }
+
+    std::shared_ptr<DecodeJob> pJob(new DecodeJob(iPriority, iDeadlineMs));
+    pJob->inputSize = iInputSize;
+    pJob->pInputTab = iInputTab;
+
+    push(pJob, _nextThreadIndex++ % _jobQueuesVect.size(), false);
+    return pJob;
+}
+
+void DecodeSchedulerImpl::push(const std::shared_ptr<DecodeJob>& ipJob, uint32_t iThreadIndex, bool iIsResumed)
+{
+    JobQueues& aJobQueues = *_jobQueuesVect[iThreadIndex];
+    {
+        std::lock_guard<std::mutex> aLock(aJobQueues.mutex);
+
+        std::deque<std::shared_ptr<DecodeJob>>& aJobDeque = aJobQueues.jobDequeArray[ipJob->priority];
+        if (iIsResumed)
+        {
+            aJobDeque.push_front(ipJob);
+        }
+        else
+        {
+            aJobDeque.push_back(ipJob);
+        }
+        ++_nbOfQueuedJobsArray[ipJob->priority];
+    }
+
+    // So that a thread going to sleep sees the job
+    {
+        std::lock_guard<std::mutex> aLock(_sleepMutex);
+    }
+    _sleepCondition.notify_one();
+}
+
+std::shared_ptr<DecodeJob> DecodeSchedulerImpl::pop(uint32_t iThreadIndex)
+{
+    const uint32_t aNbOfThreads = static_cast<uint32_t>(_jobQueuesVect.size());
+
+    for (uint32_t aPriority = 0; aPriority < sNbOfDecodePriorities; ++aPriority)
+    {
+        if (_nbOfQueuedJobsArray[aPriority] == 0)
+        {
+            continue;
+        }
+
+        for (uint32_t anOffset = 0; anOffset < aNbOfThreads; ++anOffset)
+        {
+            JobQueues& aJobQueues = *_jobQueuesVect[(iThreadIndex + anOffset) % aNbOfThreads];
+            std::lock_guard<std::mutex> aLock(aJobQueues.mutex);
+
+            std::deque<std::shared_ptr<DecodeJob>>& aJobDeque = aJobQueues.jobDequeArray[aPriority];
+            if (aJobDeque.empty())
+            {
+                continue;
+            }
+
+            // Own jobs are taken from the front, stolen ones from the back
+            std::shared_ptr<DecodeJob> pJob;
+            if (anOffset == 0)
+            {
+                pJob = aJobDeque.front();
+                aJobDeque.pop_front();
+            }
+            else
+            {
+                pJob = aJobDeque.back();
+                aJobDeque.pop_back();
+            }
+            --_nbOfQueuedJobsArray[aPriority];
+            return pJob;
+        }
+    }
+
+    return std::shared_ptr<DecodeJob>();
+}
+
+bool DecodeSchedulerImpl::hasQueuedJobBefore(Priority iPriority) const
+{
+    for (uint32_t aPriority = 0; aPriority < static_cast<uint32_t>(iPriority); ++aPriority)
+    {
+        if (_nbOfQueuedJobsArray[aPriority] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecodeSchedulerImpl::hasQueuedJob() const
+{
+    return hasQueuedJobBefore(static_cast<Priority>(sNbOfDecodePriorities));
+}
+
+void DecodeSchedulerImpl::runWorker(uint32_t iThreadIndex)
+{
+    while (!_isStopping)
+    {
+        std::shared_ptr<DecodeJob> pJob = pop(iThreadIndex);
+        if (pJob)
+        {
+            runJob(pJob, iThreadIndex);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> aLock(_sleepMutex);
+        _sleepCondition.wait(aLock, [this]() { return _isStopping || hasQueuedJob(); });
+    }
+}
+
+void DecodeSchedulerImpl::runJob(const std::shared_ptr<DecodeJob>& ipJob, uint32_t iThreadIndex)
+{
+    DecodeJob& aJob = *ipJob;
+
+    try
+    {
+        while (true)
+        {
+            if (aJob.isCancelled() || _isStopping)
+            {
+                aJob.finish(DecodeTicket::ST_CANCELLED);
+                return;
+            }
+            if (aJob.isExpired())
+            {
+                aJob.finish(DecodeTicket::ST_EXPIRED);
+                return;
+            }
+
+            if (!aJob.isStarted)
+            {
+                startJob(aJob);
+            }
+            else if (hasQueuedJobBefore(aJob.priority))
+            {
+                // More urgent work is waiting, this job resumes from its state once its turn comes back
+                push(ipJob, iThreadIndex, true);
+                return;
+            }
+
+            if (aJob.outputPos == aJob.outputBuffer.size())
+            {
+                break;
+            }
+
+            uint32_t aStepEnd = std::min(static_cast<uint32_t>(aJob.outputBuffer.size()), aJob.outputPos + sDecodeStepSize);
+            if (!aJob.pInflater->inflate(aJob.outputBuffer.data(), aJob.outputPos, aStepEnd))
+            {
+                // Compressed stream ended before the size in its header
+                aJob.outputBuffer.resize(aJob.outputPos);
+                break;
+            }
+        }
+
+        aJob.finish(DecodeTicket::ST_DONE);
+    }
+    catch(std::exception& iException)
+    {
+        aJob.finish(DecodeTicket::ST_FAILED, iException.what());
+    }
+}
+
+void DecodeSchedulerImpl::startJob(DecodeJob& ioJob)
+{
+    ioJob.isStarted = true;
+
+    if (ioJob.pFileRecord != nullptr)
+    {
+        const ANDatInterface::FileRecord& aFileRecord = *ioJob.pFileRecord;
+
+        if (_ANDatInterface.isInSidecar(aFileRecord))
+        {
+            _ANDatInterface.getInflatedBuffer(aFileRecord, ioJob.outputBuffer);
+            ioJob.outputPos = static_cast<uint32_t>(ioJob.outputBuffer.size());
+            return;
+        }
+
+        ioJob.rawBuffer.resize(aFileRecord.size);
+        uint32_t aRawSize = aFileRecord.size;
+        if (aRawSize != 0)
+        {
+            _ANDatInterface.getBuffer(aFileRecord, aRawSize, ioJob.rawBuffer.data());
+        }
+        ioJob.rawBuffer.resize(aRawSize);
+
+        if (!aFileRecord.isCompressed)
+        {
+            ioJob.outputBuffer.swap(ioJob.rawBuffer);
+            ioJob.outputPos = aRawSize;
+            return;
+        }
+
+        ioJob.inputSize = aRawSize;
+        ioJob.pInputTab = ioJob.rawBuffer.data();
+    }
+
+    // Size of the uncompressed data is the second uint32 of the header
+    if (ioJob.inputSize < 2 * sizeof(uint32_t))
+    {
+        throw exception::Exception("Compressed buffer is too small.");
+    }
+
+    ioJob.pInflater.reset(new compression::dat::DatFileInflater(ioJob.inputSize, ioJob.pInputTab));
+    ioJob.outputBuffer.resize(ioJob.pInflater->getOutputSize());
+    ioJob.outputPos = 0;
+}
+
+GW2DATTOOLS_API std::unique_ptr<DecodeScheduler> GW2DATTOOLS_APIENTRY createDecodeScheduler(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads)
+{
+    return std::unique_ptr<DecodeScheduler>(new DecodeSchedulerImpl(ioANDatInterface, iNbOfThreads));
+}
+
+}
+}
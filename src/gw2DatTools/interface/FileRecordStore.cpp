@@ -0,0 +1,246 @@
+#include "gw2DatTools/interface/FileRecordStore.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define GW2DATTOOLS_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Radix sort digits, the keys of the store need at most 6 passes
+const uint32_t sRadixDigitBits = 11;
+const uint32_t sRadixDigitMask = (1 << sRadixDigitBits) - 1;
+// Below this number of indexes, a comparison sort is faster
+const uint32_t sRadixMinNbOfIndexes = 256;
+
+GW2DATTOOLS_API FileRecordStore GW2DATTOOLS_APIENTRY buildFileRecordStore(const std::vector<ANDatInterface::FileRecord>& iFileRecordVect)
+{
+    FileRecordStore aFileRecordStore;
+
+    aFileRecordStore.offsetVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.sizeVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.baseIdVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.fileIdVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.flagVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.fileTypeVect.reserve(iFileRecordVect.size());
+    aFileRecordStore.packFileTypeVect.reserve(iFileRecordVect.size());
+
+    bool hasUncompressedSizes = false;
+    bool hasArchiveIndexes = false;
+
+    for (auto it = iFileRecordVect.begin(); it != iFileRecordVect.end(); ++it)
+    {
+        aFileRecordStore.offsetVect.push_back(it->offset);
+        aFileRecordStore.sizeVect.push_back(it->size);
+        aFileRecordStore.baseIdVect.push_back(it->baseId);
+        aFileRecordStore.fileIdVect.push_back(it->fileId);
+        aFileRecordStore.flagVect.push_back(it->isCompressed ? sFileRecordCompressedFlag : 0);
+        aFileRecordStore.fileTypeVect.push_back(static_cast<uint8_t>(it->fileType));
+        aFileRecordStore.packFileTypeVect.push_back(it->packFileType);
+
+        hasUncompressedSizes = hasUncompressedSizes || (it->isCompressed && it->uncompressedSize != 0);
+        hasArchiveIndexes = hasArchiveIndexes || (it->archiveIndex != 0);
+    }
+
+    // Optional columns
+    if (hasUncompressedSizes)
+    {
+        aFileRecordStore.uncompressedSizeVect.reserve(iFileRecordVect.size());
+        for (auto it = iFileRecordVect.begin(); it != iFileRecordVect.end(); ++it)
+        {
+            aFileRecordStore.uncompressedSizeVect.push_back(it->uncompressedSize);
+        }
+    }
+
+    if (hasArchiveIndexes)
+    {
+        aFileRecordStore.archiveIndexVect.reserve(iFileRecordVect.size());
+        for (auto it = iFileRecordVect.begin(); it != iFileRecordVect.end(); ++it)
+        {
+            aFileRecordStore.archiveIndexVect.push_back(it->archiveIndex);
+        }
+    }
+
+    return aFileRecordStore;
+}
+
+bool isMatchingRecord(const FileRecordStore& iFileRecordStore, const FileRecordFilter& iFileRecordFilter, uint32_t iRecordIndex)
+{
+    const uint32_t aSize = iFileRecordStore.sizeVect[iRecordIndex];
+    const uint32_t aFileType = iFileRecordStore.fileTypeVect[iRecordIndex];
+
+    return aSize >= iFileRecordFilter.minSize && aSize <= iFileRecordFilter.maxSize
+        && (iFileRecordStore.flagVect[iRecordIndex] & iFileRecordFilter.flagMask) == iFileRecordFilter.flagValue
+        && aFileType < 32 && ((iFileRecordFilter.fileTypeMask >> aFileType) & 1) != 0
+        && (iFileRecordFilter.packFileType == 0 || iFileRecordStore.packFileTypeVect[iRecordIndex] == iFileRecordFilter.packFileType);
+}
+
+GW2DATTOOLS_API std::vector<uint32_t> GW2DATTOOLS_APIENTRY filterFileRecords(const FileRecordStore& iFileRecordStore, const FileRecordFilter& iFileRecordFilter)
+{
+    std::vector<uint32_t> anIndexVect;
+
+    const uint32_t aNbOfRecords = static_cast<uint32_t>(iFileRecordStore.sizeVect.size());
+    uint32_t aRecordIndex = 0;
+
+#ifdef GW2DATTOOLS_FILTER_SSE2
+    // Four records at a time on the size, flags and packFileType columns, the file type
+    // is only checked on the records passing them. Sizes are biased for unsigned comparisons.
+    const __m128i aBias = _mm_set1_epi32(static_cast<int32_t>(0x80000000));
+    const __m128i aMinSize = _mm_set1_epi32(static_cast<int32_t>(iFileRecordFilter.minSize ^ 0x80000000));
+    const __m128i aMaxSize = _mm_set1_epi32(static_cast<int32_t>(iFileRecordFilter.maxSize ^ 0x80000000));
+    const __m128i aFlagMask = _mm_set1_epi32(iFileRecordFilter.flagMask);
+    const __m128i aFlagValue = _mm_set1_epi32(iFileRecordFilter.flagValue);
+    const __m128i aPackFileType = _mm_set1_epi32(static_cast<int32_t>(iFileRecordFilter.packFileType));
+    const __m128i isAnyPackFileType = _mm_set1_epi32(iFileRecordFilter.packFileType == 0 ? -1 : 0);
+    const __m128i aZero = _mm_setzero_si128();
+
+    for (; aRecordIndex + 4 <= aNbOfRecords; aRecordIndex += 4)
+    {
+        __m128i aSizes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&iFileRecordStore.sizeVect[aRecordIndex]));
+        aSizes = _mm_xor_si128(aSizes, aBias);
+        __m128i isOutOfRange = _mm_or_si128(_mm_cmplt_epi32(aSizes, aMinSize), _mm_cmpgt_epi32(aSizes, aMaxSize));
+
+        int32_t aPackedFlags;
+        memcpy(&aPackedFlags, &iFileRecordStore.flagVect[aRecordIndex], sizeof(aPackedFlags));
+        __m128i aFlags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(aPackedFlags), aZero), aZero);
+        __m128i hasFlags = _mm_cmpeq_epi32(_mm_and_si128(aFlags, aFlagMask), aFlagValue);
+
+        __m128i aPackFileTypes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&iFileRecordStore.packFileTypeVect[aRecordIndex]));
+        __m128i hasPackFileType = _mm_or_si128(isAnyPackFileType, _mm_cmpeq_epi32(aPackFileTypes, aPackFileType));
+
+        __m128i isCandidate = _mm_andnot_si128(isOutOfRange, _mm_and_si128(hasFlags, hasPackFileType));
+        int aCandidateMask = _mm_movemask_ps(_mm_castsi128_ps(isCandidate));
+        if (aCandidateMask == 0)
+        {
+            continue;
+        }
+
+        for (uint32_t aLane = 0; aLane < 4; ++aLane)
+        {
+            const uint32_t aFileType = iFileRecordStore.fileTypeVect[aRecordIndex + aLane];
+            if ((aCandidateMask & (1 << aLane)) != 0 && aFileType < 32 && ((iFileRecordFilter.fileTypeMask >> aFileType) & 1) != 0)
+            {
+                anIndexVect.push_back(aRecordIndex + aLane);
+            }
+        }
+    }
+#endif
+
+    for (; aRecordIndex < aNbOfRecords; ++aRecordIndex)
+    {
+        if (isMatchingRecord(iFileRecordStore, iFileRecordFilter, aRecordIndex))
+        {
+            anIndexVect.push_back(aRecordIndex);
+        }
+    }
+
+    return anIndexVect;
+}
+
+// Stable LSD radix sort of ioIndexVect by ioKeyVect, which holds the key of each index and is sorted along.
+// Digits shared by every key are skipped, so that small offsets or ids only take a few passes.
+void radixSortIndexes(std::vector<uint64_t>& ioKeyVect, std::vector<uint32_t>& ioIndexVect)
+{
+    uint64_t aKeyOr = 0;
+    uint64_t aKeyAnd = ~0ULL;
+    for (auto it = ioKeyVect.begin(); it != ioKeyVect.end(); ++it)
+    {
+        aKeyOr |= *it;
+        aKeyAnd &= *it;
+    }
+    const uint64_t aVaryingBits = aKeyOr ^ aKeyAnd;
+
+    std::vector<uint64_t> aKeyBuffer(ioKeyVect.size());
+    std::vector<uint32_t> anIndexBuffer(ioIndexVect.size());
+    std::vector<uint32_t> aCountVect(sRadixDigitMask + 1);
+
+    for (uint32_t aShift = 0; aShift < 64; aShift += sRadixDigitBits)
+    {
+        if (((aVaryingBits >> aShift) & sRadixDigitMask) == 0)
+        {
+            continue;
+        }
+
+        std::fill(aCountVect.begin(), aCountVect.end(), 0);
+        for (auto it = ioKeyVect.begin(); it != ioKeyVect.end(); ++it)
+        {
+            ++aCountVect[(*it >> aShift) & sRadixDigitMask];
+        }
+
+        // Counts to first position of each digit
+        uint32_t aPosition = 0;
+        for (auto it = aCountVect.begin(); it != aCountVect.end(); ++it)
+        {
+            uint32_t aCount = *it;
+            *it = aPosition;
+            aPosition += aCount;
+        }
+
+        for (uint32_t anIndex = 0; anIndex < ioKeyVect.size(); ++anIndex)
+        {
+            uint32_t& aDigitPosition = aCountVect[(ioKeyVect[anIndex] >> aShift) & sRadixDigitMask];
+            aKeyBuffer[aDigitPosition] = ioKeyVect[anIndex];
+            anIndexBuffer[aDigitPosition] = ioIndexVect[anIndex];
+            ++aDigitPosition;
+        }
+
+        ioKeyVect.swap(aKeyBuffer);
+        ioIndexVect.swap(anIndexBuffer);
+    }
+}
+
+// Sorts ioIndexVect by iKeyVect[index], keeping the order of equal keys
+template <typename KeyType>
+void sortIndexesByKey(const std::vector<KeyType>& iKeyVect, std::vector<uint32_t>& ioIndexVect)
+{
+    for (auto it = ioIndexVect.begin(); it != ioIndexVect.end(); ++it)
+    {
+        if (*it >= iKeyVect.size())
+        {
+            throw exception::Exception("Record index out of the store.");
+        }
+    }
+
+    if (ioIndexVect.size() < sRadixMinNbOfIndexes)
+    {
+        std::stable_sort(ioIndexVect.begin(), ioIndexVect.end(),
+            [&iKeyVect](uint32_t iLeft, uint32_t iRight) { return iKeyVect[iLeft] < iKeyVect[iRight]; });
+        return;
+    }
+
+    std::vector<uint64_t> aKeyVect;
+    aKeyVect.reserve(ioIndexVect.size());
+    for (auto it = ioIndexVect.begin(); it != ioIndexVect.end(); ++it)
+    {
+        aKeyVect.push_back(iKeyVect[*it]);
+    }
+
+    radixSortIndexes(aKeyVect, ioIndexVect);
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY sortByOffset(const FileRecordStore& iFileRecordStore, std::vector<uint32_t>& ioIndexVect)
+{
+    sortIndexesByKey(iFileRecordStore.offsetVect, ioIndexVect);
+
+    // The sort is stable, records of the same archive stay in offset order
+    if (!iFileRecordStore.archiveIndexVect.empty())
+    {
+        sortIndexesByKey(iFileRecordStore.archiveIndexVect, ioIndexVect);
+    }
+}
+
+GW2DATTOOLS_API void GW2DATTOOLS_APIENTRY sortByFileId(const FileRecordStore& iFileRecordStore, std::vector<uint32_t>& ioIndexVect)
+{
+    sortIndexesByKey(iFileRecordStore.fileIdVect, ioIndexVect);
+}
+
+}
+}
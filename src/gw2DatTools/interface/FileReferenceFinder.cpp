@@ -0,0 +1,139 @@
+#include "FileReferenceFinder.h"
+
+#include <cstring>
+
+#include "gw2DatTools/exception/Exception.h"
+
+#include "../format/SchemaWalk.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+FileReferenceFinder::FileReferenceFinder(const format::ANStructsSchema& iSchema)
+{
+    for (auto itChunk = iSchema.chunks.begin(); itChunk != iSchema.chunks.end(); ++itChunk)
+    {
+        for (auto itVersion = itChunk->versions.begin(); itVersion != itChunk->versions.end(); ++itVersion)
+        {
+            if (itVersion->pRoot != nullptr && mayHoldReferences(*itVersion->pRoot))
+            {
+                _rootDict[makeKey(itChunk->magic, itVersion->version)].push_back(itVersion->pRoot);
+            }
+        }
+    }
+}
+
+uint64_t FileReferenceFinder::makeKey(uint32_t iMagic, uint32_t iVersion)
+{
+    return (static_cast<uint64_t>(iMagic) << 32) | iVersion;
+}
+
+bool FileReferenceFinder::mayHoldReferences(const format::SchemaStruct& iStruct)
+{
+    auto it = _holdsReferencesDict.find(&iStruct);
+    if (it != _holdsReferencesDict.end())
+    {
+        return it->second;
+    }
+
+    // Structs only use the ones defined before them, there is no cycle
+    bool isHolding = false;
+    for (auto itField = iStruct.fields.begin(); itField != iStruct.fields.end() && itField->isLocated; ++itField)
+    {
+        if (itField->valueType == format::SVT_FILENAME || itField->valueType == format::SVT_FILEREF
+                || (itField->valueType == format::SVT_STRUCT && mayHoldReferences(*itField->pStruct)))
+        {
+            isHolding = true;
+        }
+    }
+
+    _holdsReferencesDict[&iStruct] = isHolding;
+    return isHolding;
+}
+
+void FileReferenceFinder::findInStruct(const format::ChunkSpan& iSpan, const uint8_t* ipStructPos, const format::SchemaStruct& iStruct,
+                                       uint32_t iDepth, std::vector<uint32_t>& ioFileIdVect) const
+{
+    if (iDepth >= sMaxDepth)
+    {
+        throw exception::Exception("Chunk is nested too deeply.");
+    }
+
+    // Fields after an unsized one cannot be located
+    for (auto itField = iStruct.fields.begin(); itField != iStruct.fields.end() && itField->isLocated; ++itField)
+    {
+        const format::SchemaField& aField = *itField;
+
+        if (aField.valueType == format::SVT_STRUCT)
+        {
+            if (!_holdsReferencesDict.at(aField.pStruct))
+            {
+                continue;
+            }
+        }
+        else if (aField.valueType != format::SVT_FILENAME && aField.valueType != format::SVT_FILEREF)
+        {
+            continue;
+        }
+
+        bool isStrided = (aField.nbOfElements > 1 || aField.encoding == format::SE_ARRAY_PTR);
+        if (isStrided && format::getFieldElementSize(aField) == 0)
+        {
+            continue;
+        }
+
+        format::forEachFieldElement(iSpan, ipStructPos, aField,
+            [&](const uint8_t* ipElementPos)
+            {
+                if (aField.valueType == format::SVT_STRUCT)
+                {
+                    findInStruct(iSpan, ipElementPos, *aField.pStruct, iDepth + 1, ioFileIdVect);
+                }
+                else if (aField.valueType == format::SVT_FILENAME)
+                {
+                    format::FilenameView aFilename(iSpan, ipElementPos);
+                    if (!aFilename.isNull())
+                    {
+                        ioFileIdVect.push_back(aFilename.getFileId());
+                    }
+                }
+                else
+                {
+                    uint32_t aFileId;
+                    iSpan.check(ipElementPos, sizeof(aFileId));
+                    memcpy(&aFileId, ipElementPos, sizeof(aFileId));
+                    if (aFileId != 0)
+                    {
+                        ioFileIdVect.push_back(aFileId);
+                    }
+                }
+            });
+    }
+}
+
+void FileReferenceFinder::findReferences(const format::PackFile& iPackFile, std::vector<uint32_t>& ioFileIdVect) const
+{
+    for (auto itChunk = iPackFile.chunks.begin(); itChunk != iPackFile.chunks.end(); ++itChunk)
+    {
+        auto itRoots = _rootDict.find(makeKey(itChunk->magic, itChunk->version));
+        if (itRoots == _rootDict.end())
+        {
+            continue;
+        }
+
+        // Taking the first layout whose fixed part fits in the chunk
+        for (auto itRoot = itRoots->second.begin(); itRoot != itRoots->second.end(); ++itRoot)
+        {
+            if (!(*itRoot)->isSized || (*itRoot)->size <= itChunk->dataSize)
+            {
+                findInStruct(format::ChunkSpan(*itChunk), itChunk->pData, **itRoot, 0, ioFileIdVect);
+                break;
+            }
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,50 @@
+#ifndef GW2DATTOOLS_INTERFACE_FILEREFERENCEFINDER_H
+#define GW2DATTOOLS_INTERFACE_FILEREFERENCEFINDER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "gw2DatTools/format/ANStructsSchema.h"
+#include "gw2DatTools/format/PackFile.h"
+#include "gw2DatTools/format/StructView.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Gathers the file ids held by the filename and fileref fields of the chunks of a PackFile.
+// Can be used by several threads at once.
+class FileReferenceFinder
+{
+public:
+    // iSchema shall outlive the finder
+    explicit FileReferenceFinder(const format::ANStructsSchema& iSchema);
+
+    // Appends the ids referenced by the chunks which are described by the schema.
+    // Throws gw2dt::exception::Exception if a chunk does not match its layout.
+    void findReferences(const format::PackFile& iPackFile, std::vector<uint32_t>& ioFileIdVect) const;
+
+private:
+    // Bounds the work spent on chunks whose pointers loop
+    static const uint32_t sMaxDepth = 32;
+
+    static uint64_t makeKey(uint32_t iMagic, uint32_t iVersion);
+
+    bool mayHoldReferences(const format::SchemaStruct& iStruct);
+
+    void findInStruct(const format::ChunkSpan& iSpan, const uint8_t* ipStructPos, const format::SchemaStruct& iStruct,
+                      uint32_t iDepth, std::vector<uint32_t>& ioFileIdVect) const;
+
+    // Roots of the layouts of a chunk magic and version, a chunk name may be described once per PackFile type
+    std::unordered_map<uint64_t, std::vector<const format::SchemaStruct*>> _rootDict;
+
+    // Structs holding filename or fileref fields, directly or through their members
+    std::unordered_map<const format::SchemaStruct*, bool> _holdsReferencesDict;
+};
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_FILEREFERENCEFINDER_H
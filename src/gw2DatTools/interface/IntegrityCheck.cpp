@@ -0,0 +1,74 @@
+#include "gw2DatTools/interface/IntegrityCheck.h"
+
+#include "gw2DatTools/compression/inflateDatFileBuffer.h"
+
+#include "../utils/Crc32c.h"
+#include "RecordScanner.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+void verifyRecord(const ANDatInterface::FileRecord& iFileRecord, uint32_t iSize, const uint8_t* iTab, std::vector<IntegrityError>& ioErrorVect)
+{
+    IntegrityError anError;
+    anError.fileId = iFileRecord.fileId;
+
+    if (iFileRecord.crc != 0)
+    {
+        anError.blockIndex = sRecordCrcBlockIndex;
+        anError.expectedCrc = iFileRecord.crc;
+        anError.computedCrc = utils::computeCrc32c(iTab, iSize);
+        if (anError.expectedCrc != anError.computedCrc)
+        {
+            ioErrorVect.push_back(anError);
+        }
+    }
+
+    if (iFileRecord.isCompressed)
+    {
+        uint32_t aNbOfBlocks = compression::getNbOfDatFileBlocks(iSize);
+        for (uint32_t aBlockIndex = 0; aBlockIndex < aNbOfBlocks; ++aBlockIndex)
+        {
+            anError.blockIndex = aBlockIndex;
+            if (!compression::checkDatFileBlock(iSize, iTab, aBlockIndex, anError.expectedCrc, anError.computedCrc))
+            {
+                ioErrorVect.push_back(anError);
+            }
+        }
+    }
+}
+
+GW2DATTOOLS_API std::vector<IntegrityError> GW2DATTOOLS_APIENTRY verifyArchive(ANDatInterface& ioANDatInterface, uint32_t iNbOfThreads)
+{
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    for (auto it = aFileRecordVect.begin(); it != aFileRecordVect.end(); ++it)
+    {
+        if (it->size != 0)
+        {
+            aFileRecordPtrVect.push_back(&(*it));
+        }
+    }
+
+    // Errors per record
+    std::vector<std::vector<IntegrityError>> aRecordErrorVects(aFileRecordPtrVect.size());
+
+    scanRecords(ioANDatInterface, aFileRecordPtrVect, iNbOfThreads, false,
+        [&aFileRecordPtrVect, &aRecordErrorVects](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+        {
+            verifyRecord(*aFileRecordPtrVect[iRecordIndex], iSize, iTab, aRecordErrorVects[iRecordIndex]);
+        });
+
+    std::vector<IntegrityError> anErrorVect;
+    for (auto it = aRecordErrorVects.begin(); it != aRecordErrorVects.end(); ++it)
+    {
+        anErrorVect.insert(anErrorVect.end(), it->begin(), it->end());
+    }
+    return anErrorVect;
+}
+
+}
+}
@@ -0,0 +1,244 @@
+#include "gw2DatTools/interface/RecordReader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "gw2DatTools/compression/inflateDatFileBuffer.h"
+
+#include "RecordScanner.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+class RecordReaderImpl : public RecordReader
+{
+public:
+    RecordReaderImpl(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect, uint32_t iNbOfBuffers);
+    virtual ~RecordReaderImpl();
+
+    virtual bool next(DecodedRecord& oRecord);
+
+private:
+    struct Slot
+    {
+        std::vector<uint8_t> rawBuffer;
+        std::vector<uint8_t> inflatedBuffer;
+        DecodedRecord record;
+    };
+
+    // Returns false if the record cannot be read or inflated
+    bool readRecord(const ANDatInterface::FileRecord& iFileRecord, Slot& ioSlot);
+
+    void runReadAhead();
+
+    ANDatInterface& _ANDatInterface;
+    std::vector<const ANDatInterface::FileRecord*> _fileRecordPtrVect;
+
+    // Record i is read in slot i % size
+    std::vector<Slot> _slotVect;
+
+    // Next record to read by next, if the background thread could not be started
+    uint32_t _nextRecordIndex;
+
+    std::thread _readAheadThread;
+    std::mutex _readAheadMutex;
+    std::condition_variable _readAheadCondition;
+    uint64_t _nbOfReadRecords;      // Written in their slot by the background thread
+    uint64_t _nbOfReleasedRecords;  // Done with by the consumer
+    bool _hasCurrentRecord;         // Consumer uses the slot of record _nbOfReleasedRecords
+    bool _isReadAheadFinished;
+    bool _isReadAheadStopping;
+};
+
+RecordReaderImpl::RecordReaderImpl(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                                   uint32_t iNbOfBuffers) :
+    _ANDatInterface(ioANDatInterface),
+    _fileRecordPtrVect(iFileRecordPtrVect),
+    _slotVect(std::max(2u, iNbOfBuffers)),
+    _nextRecordIndex(0),
+    _nbOfReadRecords(0),
+    _nbOfReleasedRecords(0),
+    _hasCurrentRecord(false),
+    _isReadAheadFinished(false),
+    _isReadAheadStopping(false)
+{
+    std::stable_sort(_fileRecordPtrVect.begin(), _fileRecordPtrVect.end(),
+        [](const ANDatInterface::FileRecord* ipLeft, const ANDatInterface::FileRecord* ipRight) { return isStoredBefore(*ipLeft, *ipRight); });
+
+    try
+    {
+        _readAheadThread = std::thread(&RecordReaderImpl::runReadAhead, this);
+    }
+    catch(std::exception&)
+    {
+        // Records are read by next then
+    }
+}
+
+RecordReaderImpl::~RecordReaderImpl()
+{
+    if (_readAheadThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> aLock(_readAheadMutex);
+            _isReadAheadStopping = true;
+        }
+        _readAheadCondition.notify_all();
+        _readAheadThread.join();
+    }
+}
+
+bool RecordReaderImpl::next(DecodedRecord& oRecord)
+{
+    if (!_readAheadThread.joinable())
+    {
+        while (_nextRecordIndex < _fileRecordPtrVect.size())
+        {
+            Slot& aSlot = _slotVect[0];
+            if (readRecord(*_fileRecordPtrVect[_nextRecordIndex++], aSlot))
+            {
+                oRecord = aSlot.record;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::unique_lock<std::mutex> aLock(_readAheadMutex);
+
+    if (_hasCurrentRecord)
+    {
+        ++_nbOfReleasedRecords;
+        _hasCurrentRecord = false;
+        _readAheadCondition.notify_all();
+    }
+
+    _readAheadCondition.wait(aLock, [this]() { return _nbOfReadRecords > _nbOfReleasedRecords || _isReadAheadFinished; });
+    if (_nbOfReadRecords == _nbOfReleasedRecords)
+    {
+        return false;
+    }
+
+    oRecord = _slotVect[_nbOfReleasedRecords % _slotVect.size()].record;
+    _hasCurrentRecord = true;
+    return true;
+}
+
+bool RecordReaderImpl::readRecord(const ANDatInterface::FileRecord& iFileRecord, Slot& ioSlot)
+{
+    try
+    {
+        DecodedRecord& aRecord = ioSlot.record;
+        aRecord.pFileRecord = &iFileRecord;
+
+        // Buffers only grow, resizing them does not allocate once they hold the largest record
+        if (_ANDatInterface.isInSidecar(iFileRecord))
+        {
+            _ANDatInterface.getInflatedBuffer(iFileRecord, ioSlot.inflatedBuffer);
+            aRecord.size = static_cast<uint32_t>(ioSlot.inflatedBuffer.size());
+            aRecord.pTab = ioSlot.inflatedBuffer.data();
+            return true;
+        }
+
+        ioSlot.rawBuffer.resize(iFileRecord.size);
+        uint32_t aRawSize = iFileRecord.size;
+        if (aRawSize != 0)
+        {
+            _ANDatInterface.getBuffer(iFileRecord, aRawSize, ioSlot.rawBuffer.data());
+        }
+
+        if (!iFileRecord.isCompressed)
+        {
+            aRecord.size = aRawSize;
+            aRecord.pTab = ioSlot.rawBuffer.data();
+            return true;
+        }
+
+        // Size of the uncompressed data is the second uint32 of the header
+        if (aRawSize < 2 * sizeof(uint32_t))
+        {
+            return false;
+        }
+
+        uint32_t anOutputSize;
+        memcpy(&anOutputSize, ioSlot.rawBuffer.data() + sizeof(uint32_t), sizeof(uint32_t));
+
+        ioSlot.inflatedBuffer.resize(anOutputSize);
+        if (anOutputSize != 0)
+        {
+            compression::inflateDatFileBuffer(aRawSize, ioSlot.rawBuffer.data(), anOutputSize, ioSlot.inflatedBuffer.data());
+        }
+
+        aRecord.size = anOutputSize;
+        aRecord.pTab = ioSlot.inflatedBuffer.data();
+        return true;
+    }
+    catch(std::exception&)
+    {
+        return false;
+    }
+}
+
+void RecordReaderImpl::runReadAhead()
+{
+    const uint64_t aNbOfSlots = _slotVect.size();
+
+    for (auto it = _fileRecordPtrVect.begin(); it != _fileRecordPtrVect.end(); ++it)
+    {
+        {
+            std::unique_lock<std::mutex> aLock(_readAheadMutex);
+            _readAheadCondition.wait(aLock, [this, aNbOfSlots]() { return _nbOfReadRecords - _nbOfReleasedRecords < aNbOfSlots || _isReadAheadStopping; });
+            if (_isReadAheadStopping)
+            {
+                return;
+            }
+        }
+
+        // Only this thread updates _nbOfReadRecords, and the consumer does not use this slot
+        if (readRecord(**it, _slotVect[_nbOfReadRecords % aNbOfSlots]))
+        {
+            {
+                std::lock_guard<std::mutex> aLock(_readAheadMutex);
+                ++_nbOfReadRecords;
+            }
+            _readAheadCondition.notify_all();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> aLock(_readAheadMutex);
+        _isReadAheadFinished = true;
+    }
+    _readAheadCondition.notify_all();
+}
+
+GW2DATTOOLS_API std::unique_ptr<RecordReader> GW2DATTOOLS_APIENTRY createRecordReader(ANDatInterface& ioANDatInterface, const FileRecordFilter& iFileRecordFilter,
+                                                                                       uint32_t iNbOfBuffers)
+{
+    const std::vector<ANDatInterface::FileRecord>& aFileRecordVect = ioANDatInterface.getFileRecordVect();
+    std::vector<uint32_t> anIndexVect = filterFileRecords(buildFileRecordStore(aFileRecordVect), iFileRecordFilter);
+
+    std::vector<const ANDatInterface::FileRecord*> aFileRecordPtrVect;
+    aFileRecordPtrVect.reserve(anIndexVect.size());
+    for (auto it = anIndexVect.begin(); it != anIndexVect.end(); ++it)
+    {
+        aFileRecordPtrVect.push_back(&aFileRecordVect[*it]);
+    }
+
+    return std::unique_ptr<RecordReader>(new RecordReaderImpl(ioANDatInterface, aFileRecordPtrVect, iNbOfBuffers));
+}
+
+GW2DATTOOLS_API std::unique_ptr<RecordReader> GW2DATTOOLS_APIENTRY createRecordReader(ANDatInterface& ioANDatInterface,
+                                                                                       const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                                                                                       uint32_t iNbOfBuffers)
+{
+    return std::unique_ptr<RecordReader>(new RecordReaderImpl(ioANDatInterface, iFileRecordPtrVect, iNbOfBuffers));
+}
+
+}
+}
@@ -0,0 +1,216 @@
+#include "RecordScanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "gw2DatTools/exception/Exception.h"
+#include "gw2DatTools/compression/inflateDatFileBuffer.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Amount of raw records read before they are dispatched to the threads
+const uint64_t sScanBatchInputSize = 64 * 1024 * 1024;
+
+struct ScanJob
+{
+    uint32_t recordIndex;
+    uint64_t inputOffset;       // Position of the record in the batch buffer, or in the inflated one
+    bool isInflated;            // Read inflated from the sidecar of the archive
+    uint32_t inflatedSize;
+};
+
+bool isPackFileCandidate(const ANDatInterface::FileRecord& iFileRecord, uint32_t iPackFileType)
+{
+    if (iFileRecord.size == 0)
+    {
+        return false;
+    }
+
+    if (iFileRecord.fileType == ANDatInterface::FT_UNKNOWN)
+    {
+        return true;
+    }
+
+    return iFileRecord.fileType == ANDatInterface::FT_PACKFILE
+        && (iPackFileType == 0 || iPackFileType == iFileRecord.packFileType);
+}
+
+void scanJob(const ScanJob& iJob, const ANDatInterface::FileRecord& iFileRecord, const uint8_t* iInputTab,
+             bool iIsInflating, const RecordVisitor& iVisitor, std::vector<uint8_t>& ioScratch)
+{
+    try
+    {
+        const uint8_t* pContentTab = iInputTab;
+        uint32_t aContentSize = iJob.isInflated ? iJob.inflatedSize : iFileRecord.size;
+
+        if (iIsInflating && iFileRecord.isCompressed && !iJob.isInflated)
+        {
+            if (iFileRecord.size < 2 * sizeof(uint32_t))
+            {
+                return;
+            }
+
+            // Size of the uncompressed data is the second uint32 of the header
+            uint32_t anOutputSize;
+            memcpy(&anOutputSize, iInputTab + sizeof(uint32_t), sizeof(anOutputSize));
+            if (anOutputSize == 0)
+            {
+                return;
+            }
+
+            ioScratch.resize(anOutputSize);
+            compression::inflateDatFileBuffer(iFileRecord.size, iInputTab, anOutputSize, ioScratch.data());
+
+            pContentTab = ioScratch.data();
+            aContentSize = anOutputSize;
+        }
+
+        iVisitor(iJob.recordIndex, aContentSize, pContentTab);
+    }
+    catch(std::exception&)
+    {
+        // Broken records are skipped
+    }
+}
+
+void runScanWorker(std::atomic<uint32_t>& ioNextJob, const std::vector<ScanJob>& iJobVect, const std::vector<uint8_t>& iInputBuffer,
+                   const std::vector<uint8_t>& iInflatedBuffer, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                   bool iIsInflating, const RecordVisitor& iVisitor)
+{
+    std::vector<uint8_t> aScratch;
+
+    while (true)
+    {
+        uint32_t aJobIndex = ioNextJob.fetch_add(1);
+        if (aJobIndex >= iJobVect.size())
+        {
+            return;
+        }
+
+        const ScanJob& aJob = iJobVect[aJobIndex];
+        const uint8_t* pInputTab = (aJob.isInflated ? iInflatedBuffer.data() : iInputBuffer.data()) + aJob.inputOffset;
+        scanJob(aJob, *iFileRecordPtrVect[aJob.recordIndex], pInputTab, iIsInflating, iVisitor, aScratch);
+    }
+}
+
+void scanRecords(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                 uint32_t iNbOfThreads, bool iIsInflating, const RecordVisitor& iVisitor)
+{
+    // Reading the records in storage order, so that the disk is read forward only
+    std::vector<uint32_t> aRecordIndexVect(iFileRecordPtrVect.size());
+    for (uint32_t aRecordIndex = 0; aRecordIndex < aRecordIndexVect.size(); ++aRecordIndex)
+    {
+        aRecordIndexVect[aRecordIndex] = aRecordIndex;
+    }
+
+    std::sort(aRecordIndexVect.begin(), aRecordIndexVect.end(),
+        [&iFileRecordPtrVect](uint32_t iLeft, uint32_t iRight) { return isStoredBefore(*iFileRecordPtrVect[iLeft], *iFileRecordPtrVect[iRight]); });
+
+    uint32_t aNbOfThreads = (iNbOfThreads != 0) ? iNbOfThreads : std::thread::hardware_concurrency();
+    aNbOfThreads = std::max(1u, aNbOfThreads);
+
+    std::vector<ScanJob> aJobVect;
+    std::vector<uint8_t> anInputBuffer;
+    std::vector<uint8_t> anInflatedBuffer;
+    std::vector<uint8_t> aSidecarContent;
+
+    auto itFirst = aRecordIndexVect.begin();
+    while (itFirst != aRecordIndexVect.end())
+    {
+        // Gathering a batch, a record bigger than the batch size is a batch on its own
+        uint64_t anInputSize = 0;
+        auto itLast = itFirst;
+        while (itLast != aRecordIndexVect.end() && (itLast == itFirst || anInputSize + iFileRecordPtrVect[*itLast]->size <= sScanBatchInputSize))
+        {
+            anInputSize += iFileRecordPtrVect[*itLast]->size;
+            ++itLast;
+        }
+
+        aJobVect.resize(itLast - itFirst);
+        anInputBuffer.resize(static_cast<size_t>(anInputSize));
+        anInflatedBuffer.clear();
+
+        uint64_t anInputOffset = 0;
+        for (auto it = itFirst; it != itLast; ++it)
+        {
+            const ANDatInterface::FileRecord& aFileRecord = *iFileRecordPtrVect[*it];
+
+            ScanJob& aJob = aJobVect[it - itFirst];
+            aJob.recordIndex = *it;
+            aJob.isInflated = iIsInflating && aFileRecord.isCompressed && ioANDatInterface.isInSidecar(aFileRecord);
+
+            if (aJob.isInflated)
+            {
+                // Nothing left to decode
+                ioANDatInterface.getInflatedBuffer(aFileRecord, aSidecarContent);
+
+                aJob.inputOffset = anInflatedBuffer.size();
+                aJob.inflatedSize = static_cast<uint32_t>(aSidecarContent.size());
+                anInflatedBuffer.insert(anInflatedBuffer.end(), aSidecarContent.begin(), aSidecarContent.end());
+                continue;
+            }
+
+            aJob.inputOffset = anInputOffset;
+
+            uint32_t aSize = aFileRecord.size;
+            ioANDatInterface.getBuffer(aFileRecord, aSize, anInputBuffer.data() + anInputOffset);
+            if (aSize != aFileRecord.size)
+            {
+                throw exception::Exception("Could not read a record.");
+            }
+
+            anInputOffset += aSize;
+        }
+
+        std::atomic<uint32_t> aNextJob(0);
+        uint32_t aNbOfBatchThreads = std::min(aNbOfThreads, static_cast<uint32_t>(aJobVect.size()));
+
+        // The calling thread is one of the workers
+        std::vector<std::thread> aThreadVect;
+        for (uint32_t aThreadIndex = 1; aThreadIndex < aNbOfBatchThreads; ++aThreadIndex)
+        {
+            try
+            {
+                aThreadVect.push_back(std::thread(runScanWorker, std::ref(aNextJob), std::cref(aJobVect), std::cref(anInputBuffer), std::cref(anInflatedBuffer),
+                                                  std::cref(iFileRecordPtrVect), iIsInflating, std::cref(iVisitor)));
+            }
+            catch(std::exception&)
+            {
+                break; // The running workers take the remaining jobs
+            }
+        }
+
+        runScanWorker(aNextJob, aJobVect, anInputBuffer, anInflatedBuffer, iFileRecordPtrVect, iIsInflating, iVisitor);
+
+        for (auto it = aThreadVect.begin(); it != aThreadVect.end(); ++it)
+        {
+            it->join();
+        }
+
+        itFirst = itLast;
+    }
+}
+
+void scanPackFiles(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                   uint32_t iNbOfThreads, const PackFileVisitor& iVisitor)
+{
+    scanRecords(ioANDatInterface, iFileRecordPtrVect, iNbOfThreads, true,
+        [&iVisitor](uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)
+        {
+            if (iSize < sizeof(format::PackFileHeader) || iTab[0] != 'P' || iTab[1] != 'F')
+            {
+                return;
+            }
+
+            auto pPackFile = format::parsePackFile(iSize, iTab);
+            iVisitor(iRecordIndex, *pPackFile);
+        });
+}
+
+}
+}
@@ -0,0 +1,49 @@
+#ifndef GW2DATTOOLS_INTERFACE_RECORDSCANNER_H
+#define GW2DATTOOLS_INTERFACE_RECORDSCANNER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "gw2DatTools/format/PackFile.h"
+#include "gw2DatTools/interface/ANDatInterface.h"
+
+namespace gw2dt
+{
+namespace interface
+{
+
+// Visitors are called on the worker threads with the index of the record in the scanned vector.
+// Exceptions thrown by a visitor are ignored, the visitor shall drop what it
+// gathered from the record by itself.
+typedef std::function<void(uint32_t iRecordIndex, uint32_t iSize, const uint8_t* iTab)> RecordVisitor;
+typedef std::function<void(uint32_t iRecordIndex, const format::PackFile& iPackFile)> PackFileVisitor;
+
+// Storage order of the records, reading them in this order reads every archive forward only
+inline bool isStoredBefore(const ANDatInterface::FileRecord& iLeft, const ANDatInterface::FileRecord& iRight)
+{
+    return iLeft.archiveIndex < iRight.archiveIndex
+        || (iLeft.archiveIndex == iRight.archiveIndex && iLeft.offset < iRight.offset);
+}
+
+// Records which may be PackFiles, of the given type if iPackFileType is not 0.
+// Unclassified records are kept.
+bool isPackFileCandidate(const ANDatInterface::FileRecord& iFileRecord, uint32_t iPackFileType);
+
+// Reads the records in storage order, by batches, and inflates them on iNbOfThreads
+// threads (0 for one per hardware thread), in a buffer per thread which is valid
+// during the call to the visitor. Records which cannot be inflated are skipped.
+// Records held by the sidecar of the archive are read from it already inflated.
+// If iIsInflating is false, the visitor gets the records as stored in the dat.
+// ioANDatInterface is only used by the calling thread.
+void scanRecords(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                 uint32_t iNbOfThreads, bool iIsInflating, const RecordVisitor& iVisitor);
+
+// Same as scanRecords, records which are not PackFiles are skipped
+void scanPackFiles(ANDatInterface& ioANDatInterface, const std::vector<const ANDatInterface::FileRecord*>& iFileRecordPtrVect,
+                   uint32_t iNbOfThreads, const PackFileVisitor& iVisitor);
+
+}
+}
+
+#endif // GW2DATTOOLS_INTERFACE_RECORDSCANNER_H
@@ -34,6 +34,11 @@ public:
     template <typename OutputType>
     void drop();
 
+    // Bytes of the buffer which were not pulled yet
+    uint32_t getBytesAvail() const;
+    // Goes on reading from ipBuffer, which shall start with the bytes which were not pulled yet
+    void setBuffer(const uint8_t* ipBuffer, uint32_t iSize);
+
 private:
     template <typename OutputType>
     void readImpl(uint8_t iBitNumber, OutputType& oValue) const;
@@ -41,11 +46,11 @@ private:
 
     void pull(IntType& oValue, uint8_t& oNbPulledBits);
 
-    const uint8_t* const _pBufferStartPos;
     const uint8_t* _pBufferPos;
     uint32_t _bytesAvail;
 
     uint32_t _skippedBytes;
+    uint32_t _wordPos; // Words pulled or skipped since the start of the data
 
     IntType _head;
     IntType _buffer;
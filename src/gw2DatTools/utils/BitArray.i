@@ -12,10 +12,10 @@ namespace utils
 
 template <typename IntType>
 BitArray<IntType>::BitArray(const uint8_t* ipBuffer, uint32_t iSize, uint32_t iSkippedBytes) :
-    _pBufferStartPos(ipBuffer),
     _pBufferPos(ipBuffer),
     _bytesAvail(iSize),
     _skippedBytes(iSkippedBytes),
+    _wordPos(0),
     _head(0),
     _buffer(0),
     _bitsAvail(0)
@@ -32,15 +32,21 @@ void BitArray<IntType>::pull(IntType& oValue, uint8_t& oNbPulledBits)
     {
         if (_skippedBytes != 0)
         {
-            if ((((_pBufferPos - _pBufferStartPos)/sizeof(IntType)) + 1) % _skippedBytes == 0)
+            if ((_wordPos + 1) % _skippedBytes == 0)
             {
                 _bytesAvail -= sizeof(IntType);
                 _pBufferPos += sizeof(IntType);
+                ++_wordPos;
             }
         }
+    }
+
+    if (_bytesAvail >= sizeof(IntType))
+    {
         oValue = *(reinterpret_cast<const IntType*>(_pBufferPos));
         _bytesAvail -= sizeof(IntType);
         _pBufferPos += sizeof(IntType);
+        ++_wordPos;
         oNbPulledBits = sizeof(IntType) * 8;
     }
     else
@@ -50,6 +56,43 @@ void BitArray<IntType>::pull(IntType& oValue, uint8_t& oNbPulledBits)
     }
 }
 
+template <typename IntType>
+uint32_t BitArray<IntType>::getBytesAvail() const
+{
+    return _bytesAvail;
+}
+
+template <typename IntType>
+void BitArray<IntType>::setBuffer(const uint8_t* ipBuffer, uint32_t iSize)
+{
+    _pBufferPos = ipBuffer;
+    _bytesAvail = iSize;
+
+    // Filling the room left by the pulls which found the previous buffer empty
+    if (_bitsAvail <= sizeof(IntType) * 8)
+    {
+        IntType aNewValue;
+        uint8_t aNbPulledBits;
+        pull(aNewValue, aNbPulledBits);
+
+        if (_bitsAvail == 0)
+        {
+            _head = aNewValue;
+            _buffer = 0;
+        }
+        else if (_bitsAvail == sizeof(IntType) * 8)
+        {
+            _buffer = aNewValue;
+        }
+        else
+        {
+            _head = (_head & ~(static_cast<IntType>(~0) >> _bitsAvail)) | (aNewValue >> _bitsAvail);
+            _buffer = aNewValue << ((sizeof(IntType) * 8) - _bitsAvail);
+        }
+        _bitsAvail += aNbPulledBits;
+    }
+}
+
 template <typename IntType>
 template <typename OutputType>
 void BitArray<IntType>::readImpl(uint8_t iBitNumber, OutputType& oValue) const
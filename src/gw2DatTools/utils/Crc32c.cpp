@@ -0,0 +1,139 @@
+#include "Crc32c.h"
+
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GW2DATTOOLS_CRC_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GW2DATTOOLS_CRC_SSE42_TARGET
+#else
+#include <cpuid.h>
+#define GW2DATTOOLS_CRC_SSE42_TARGET __attribute__((target("sse4.2")))
+#endif
+#endif
+
+namespace gw2dt
+{
+namespace utils
+{
+
+const uint32_t sCrc32cPolynomial = 0x82F63B78; // Reversed
+
+// Slicing by 8: table k gives the CRC of a byte followed by k zero bytes
+struct Crc32cTables
+{
+    Crc32cTables()
+    {
+        for (uint32_t aByte = 0; aByte < 256; ++aByte)
+        {
+            uint32_t aCrc = aByte;
+            for (uint32_t aBit = 0; aBit < 8; ++aBit)
+            {
+                aCrc = (aCrc >> 1) ^ ((aCrc & 1) ? sCrc32cPolynomial : 0);
+            }
+            tab[0][aByte] = aCrc;
+        }
+
+        for (uint32_t aByte = 0; aByte < 256; ++aByte)
+        {
+            for (uint32_t aSlice = 1; aSlice < 8; ++aSlice)
+            {
+                uint32_t aPrevious = tab[aSlice - 1][aByte];
+                tab[aSlice][aByte] = (aPrevious >> 8) ^ tab[0][aPrevious & 0xFF];
+            }
+        }
+    }
+
+    uint32_t tab[8][256];
+};
+
+uint32_t computeCrc32cSoftware(const uint8_t* iTab, uint32_t iSize, uint32_t iCrc)
+{
+    static const Crc32cTables sTables;
+
+    uint32_t aCrc = iCrc;
+
+    while (iSize >= 8)
+    {
+        uint32_t aLow;
+        uint32_t aHigh;
+        memcpy(&aLow, iTab, sizeof(aLow));
+        memcpy(&aHigh, iTab + 4, sizeof(aHigh));
+        aLow ^= aCrc;
+
+        aCrc = sTables.tab[7][aLow & 0xFF] ^ sTables.tab[6][(aLow >> 8) & 0xFF]
+             ^ sTables.tab[5][(aLow >> 16) & 0xFF] ^ sTables.tab[4][aLow >> 24]
+             ^ sTables.tab[3][aHigh & 0xFF] ^ sTables.tab[2][(aHigh >> 8) & 0xFF]
+             ^ sTables.tab[1][(aHigh >> 16) & 0xFF] ^ sTables.tab[0][aHigh >> 24];
+
+        iTab += 8;
+        iSize -= 8;
+    }
+
+    while (iSize != 0)
+    {
+        aCrc = (aCrc >> 8) ^ sTables.tab[0][(aCrc ^ *iTab) & 0xFF];
+        ++iTab;
+        --iSize;
+    }
+
+    return aCrc;
+}
+
+#ifdef GW2DATTOOLS_CRC_SSE42
+bool hasSse42()
+{
+#ifdef _MSC_VER
+    int aRegisterTab[4];
+    __cpuid(aRegisterTab, 1);
+    return (aRegisterTab[2] & (1 << 20)) != 0;
+#else
+    unsigned int anEax, anEbx, anEcx, anEdx;
+    return __get_cpuid(1, &anEax, &anEbx, &anEcx, &anEdx) && (anEcx & bit_SSE4_2) != 0;
+#endif
+}
+
+GW2DATTOOLS_CRC_SSE42_TARGET uint32_t computeCrc32cSse42(const uint8_t* iTab, uint32_t iSize, uint32_t iCrc)
+{
+    uint32_t aCrc = iCrc;
+
+    while (iSize >= 4)
+    {
+        uint32_t aValue;
+        memcpy(&aValue, iTab, sizeof(aValue));
+        aCrc = _mm_crc32_u32(aCrc, aValue);
+
+        iTab += 4;
+        iSize -= 4;
+    }
+
+    while (iSize != 0)
+    {
+        aCrc = _mm_crc32_u8(aCrc, *iTab);
+        ++iTab;
+        --iSize;
+    }
+
+    return aCrc;
+}
+#endif
+
+uint32_t computeCrc32c(const uint8_t* iTab, uint32_t iSize, uint32_t iCrc)
+{
+    uint32_t aCrc = ~iCrc;
+
+#ifdef GW2DATTOOLS_CRC_SSE42
+    static const bool sHasSse42 = hasSse42();
+    if (sHasSse42)
+    {
+        return ~computeCrc32cSse42(iTab, iSize, aCrc);
+    }
+#endif
+
+    return ~computeCrc32cSoftware(iTab, iSize, aCrc);
+}
+
+}
+}
@@ -0,0 +1,21 @@
+#ifndef GW2DATTOOLS_UTILS_CRC32C_H
+#define GW2DATTOOLS_UTILS_CRC32C_H
+
+#include <cstdint>
+
+namespace gw2dt
+{
+namespace utils
+{
+
+// CRC-32C (Castagnoli), with the SSE4.2 crc32 instruction when the processor has it.
+// iCrc is the CRC of the previous bytes, to compute it piece by piece.
+uint32_t computeCrc32c(const uint8_t* iTab, uint32_t iSize, uint32_t iCrc = 0);
+
+// CRC of any data followed by its own CRC, that of a record ending with the CRC of its last block for example
+const uint32_t sCrc32cResidue = 0x48674BC7;
+
+}
+}
+
+#endif // GW2DATTOOLS_UTILS_CRC32C_H
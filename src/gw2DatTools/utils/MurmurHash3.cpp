@@ -0,0 +1,103 @@
+#include "MurmurHash3.h"
+
+#include <cstring>
+
+namespace gw2dt
+{
+namespace utils
+{
+
+const uint64_t sMurmurHash3C1 = 0x87C37B91114253D5ULL;
+const uint64_t sMurmurHash3C2 = 0x4CF5AD432745937FULL;
+
+inline uint64_t rotateLeft(uint64_t iValue, uint32_t iShift)
+{
+    return (iValue << iShift) | (iValue >> (64 - iShift));
+}
+
+inline uint64_t mixFinal(uint64_t iValue)
+{
+    iValue ^= iValue >> 33;
+    iValue *= 0xFF51AFD7ED558CCDULL;
+    iValue ^= iValue >> 33;
+    iValue *= 0xC4CEB9FE1A85EC53ULL;
+    iValue ^= iValue >> 33;
+    return iValue;
+}
+
+inline uint64_t mixFirstLane(uint64_t iValue)
+{
+    iValue *= sMurmurHash3C1;
+    iValue = rotateLeft(iValue, 31);
+    iValue *= sMurmurHash3C2;
+    return iValue;
+}
+
+inline uint64_t mixSecondLane(uint64_t iValue)
+{
+    iValue *= sMurmurHash3C2;
+    iValue = rotateLeft(iValue, 33);
+    iValue *= sMurmurHash3C1;
+    return iValue;
+}
+
+void computeMurmurHash3(const uint8_t* iTab, uint32_t iSize, uint64_t oHash[2], uint32_t iSeed)
+{
+    uint64_t aFirst = iSeed;
+    uint64_t aSecond = iSeed;
+
+    // Blocks of 16 bytes, read as two little endian uint64
+    const uint32_t aNbOfBlocks = iSize / 16;
+    for (uint32_t aBlockIndex = 0; aBlockIndex < aNbOfBlocks; ++aBlockIndex)
+    {
+        uint64_t aBlock[2];
+        memcpy(aBlock, iTab + aBlockIndex * 16, sizeof(aBlock));
+
+        aFirst ^= mixFirstLane(aBlock[0]);
+        aFirst = rotateLeft(aFirst, 27);
+        aFirst += aSecond;
+        aFirst = aFirst * 5 + 0x52DCE729;
+
+        aSecond ^= mixSecondLane(aBlock[1]);
+        aSecond = rotateLeft(aSecond, 31);
+        aSecond += aFirst;
+        aSecond = aSecond * 5 + 0x38495AB5;
+    }
+
+    // Last bytes, zero padded
+    const uint8_t* pTail = iTab + aNbOfBlocks * 16;
+    const uint32_t aTailSize = iSize & 15;
+
+    uint64_t aTail[2] = { 0, 0 };
+    for (uint32_t anIndex = 0; anIndex < aTailSize; ++anIndex)
+    {
+        aTail[anIndex / 8] |= static_cast<uint64_t>(pTail[anIndex]) << (8 * (anIndex % 8));
+    }
+
+    if (aTailSize > 8)
+    {
+        aSecond ^= mixSecondLane(aTail[1]);
+    }
+    if (aTailSize > 0)
+    {
+        aFirst ^= mixFirstLane(aTail[0]);
+    }
+
+    aFirst ^= iSize;
+    aSecond ^= iSize;
+
+    aFirst += aSecond;
+    aSecond += aFirst;
+
+    aFirst = mixFinal(aFirst);
+    aSecond = mixFinal(aSecond);
+
+    aFirst += aSecond;
+    aSecond += aFirst;
+
+    oHash[0] = aFirst;
+    oHash[1] = aSecond;
+}
+
+}
+}
@@ -0,0 +1,18 @@
+#ifndef GW2DATTOOLS_UTILS_MURMURHASH3_H
+#define GW2DATTOOLS_UTILS_MURMURHASH3_H
+
+#include <cstdint>
+
+namespace gw2dt
+{
+namespace utils
+{
+
+// MurmurHash3_x64_128 of Austin Appleby, its two independent 64 bits lanes keep the pipeline busy.
+// oHash[0] and oHash[1] are the first and second halves of the reference output.
+void computeMurmurHash3(const uint8_t* iTab, uint32_t iSize, uint64_t oHash[2], uint32_t iSeed = 0);
+
+}
+}
+
+#endif // GW2DATTOOLS_UTILS_MURMURHASH3_H